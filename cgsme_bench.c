@@ -0,0 +1,487 @@
+// cgsme_bench: parameter sweep over width/length/height/fulness/seed with warmup and
+// repetitions. per config it reports the latency distribution of one generation call,
+// throughput, the phase split of cgsme_context_phase_us and peak memory, as a table on
+// stdout and optionally as JSON / CSV. a CSV written earlier can be passed back in as a
+// baseline: configs whose median got slower than the tolerance are flagged (exit code 1).
+// with several --threads values every config is rerun per pool size and reports its speedup
+// over the first one; a config whose output changes with the thread count also fails.
+//
+//   cgsme_bench --width=64,256 --height=1,4 --fulness=70,100 --seeds=1,2,3 --reps=5
+//               --csv=now.csv --baseline=before.csv --tolerance=10
+//   cgsme_bench --width=2048 --height=1 --tile=256 --threads=1,2,4,8,16,32   (strong scaling)
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "generator.h"
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#define BENCH_MAX_VALUES 32
+
+typedef struct
+{
+    uint32_t values[BENCH_MAX_VALUES];
+    uint32_t count;
+} ValueList;
+
+typedef struct
+{
+    ValueList widths, lengths, heights, fulness, seeds;
+    ValueList threads; // worker pool sizes, 0 = no pool (thread per layer)
+    ValueList tiles;   // cgsme_context_set_tile_size, 0 = untiled
+    uint32_t warmup;
+    uint32_t reps;
+    const char *jsonPath;
+    const char *csvPath;
+    const char *baselinePath;
+    double tolerancePct;
+} BenchOptions;
+
+typedef struct
+{
+    uint32_t width, length, height, fulness;
+    uint32_t threads, tile;
+    uint32_t runs;
+    double meanUs, p50Us, p95Us, p99Us;
+    double tilesPerSecond;
+    double phaseUs[CGSME_PHASE_COUNT]; // mean per call
+    size_t contextPeakBytes;
+    uint64_t peakRssKb; // process wide, so it only grows over the sweep
+    int failures;
+    uint64_t outputHash;  // FNV-1a over the first timed output of every seed
+    double speedup;       // p50 of the same config at the first --threads value / this p50
+    bool outputDiffers;   // output hash differs from the same config at the first --threads value
+    double baselineP50Us; // 0 = no baseline row
+    bool regression;
+} BenchResult;
+
+static uint64_t benchNowUs(void)
+{
+#ifdef _WIN32
+    static LARGE_INTEGER freq = {0};
+    LARGE_INTEGER now;
+    if (freq.QuadPart == 0)
+        QueryPerformanceFrequency(&freq);
+    QueryPerformanceCounter(&now);
+    return (uint64_t)((now.QuadPart / freq.QuadPart) * 1000000ULL + (now.QuadPart % freq.QuadPart) * 1000000ULL / freq.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)(ts.tv_nsec / 1000);
+#endif
+}
+
+static uint64_t peakRssKb(void)
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return 0;
+    return (uint64_t)pmc.PeakWorkingSetSize / 1024;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+#ifdef __APPLE__
+    return (uint64_t)usage.ru_maxrss / 1024; // bytes there
+#else
+    return (uint64_t)usage.ru_maxrss;
+#endif
+#endif
+}
+
+// "64,128,256" -> list, false on junk or too many values
+static bool parseList(const char *text, ValueList *out)
+{
+    out->count = 0;
+    while (*text)
+    {
+        char *end;
+        unsigned long v = strtoul(text, &end, 10);
+        if (end == text || out->count == BENCH_MAX_VALUES)
+            return false;
+        out->values[out->count++] = (uint32_t)v;
+        text = *end == ',' ? end + 1 : end;
+        if (*end && *end != ',')
+            return false;
+    }
+    return out->count > 0;
+}
+
+static void printUsage(void)
+{
+    printf("usage: cgsme_bench [options]\n"
+           "  --width=LIST       map widths (default 64,256)\n"
+           "  --length=LIST      map lengths (default: same as width, paired instead of crossed)\n"
+           "  --height=LIST      layer counts (default 1,4)\n"
+           "  --fulness=LIST     fulness percentages (default 70,100)\n"
+           "  --seeds=LIST       seeds every config runs with (default 1,2,3)\n"
+           "  --warmup=N         untimed calls per seed before measuring (default 1)\n"
+           "  --reps=N           timed calls per seed (default 5)\n"
+           "  --threads=LIST     worker pool sizes to run with, 0 = no pool (default 0)\n"
+           "  --tile=LIST        intra-layer tile sizes, 0 = untiled (default 0)\n"
+           "  --json=FILE        write the results as JSON\n"
+           "  --csv=FILE         write the results as CSV (usable as a baseline)\n"
+           "  --baseline=FILE    CSV of an earlier run, flag configs whose p50 got slower\n"
+           "  --tolerance=PCT    allowed p50 slowdown against the baseline (default 10)\n"
+           "LIST is comma separated, e.g. --width=32,64,128\n");
+}
+
+static bool parseOptions(int argc, char **argv, BenchOptions *o)
+{
+    parseList("64,256", &o->widths);
+    o->lengths.count = 0;
+    parseList("1,4", &o->heights);
+    parseList("70,100", &o->fulness);
+    parseList("1,2,3", &o->seeds);
+    parseList("0", &o->threads);
+    parseList("0", &o->tiles);
+    o->warmup = 1;
+    o->reps = 5;
+    o->jsonPath = NULL;
+    o->csvPath = NULL;
+    o->baselinePath = NULL;
+    o->tolerancePct = 10.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        const char *a = argv[i];
+        bool ok = true;
+        if (strncmp(a, "--width=", 8) == 0)
+            ok = parseList(a + 8, &o->widths);
+        else if (strncmp(a, "--length=", 9) == 0)
+            ok = parseList(a + 9, &o->lengths);
+        else if (strncmp(a, "--height=", 9) == 0)
+            ok = parseList(a + 9, &o->heights);
+        else if (strncmp(a, "--fulness=", 10) == 0)
+            ok = parseList(a + 10, &o->fulness);
+        else if (strncmp(a, "--seeds=", 8) == 0)
+            ok = parseList(a + 8, &o->seeds);
+        else if (strncmp(a, "--warmup=", 9) == 0)
+            o->warmup = (uint32_t)strtoul(a + 9, NULL, 10);
+        else if (strncmp(a, "--reps=", 7) == 0)
+            ok = (o->reps = (uint32_t)strtoul(a + 7, NULL, 10)) > 0;
+        else if (strncmp(a, "--threads=", 10) == 0)
+            ok = parseList(a + 10, &o->threads);
+        else if (strncmp(a, "--tile=", 7) == 0)
+            ok = parseList(a + 7, &o->tiles);
+        else if (strncmp(a, "--json=", 7) == 0)
+            o->jsonPath = a + 7;
+        else if (strncmp(a, "--csv=", 6) == 0)
+            o->csvPath = a + 6;
+        else if (strncmp(a, "--baseline=", 11) == 0)
+            o->baselinePath = a + 11;
+        else if (strncmp(a, "--tolerance=", 12) == 0)
+            o->tolerancePct = strtod(a + 12, NULL);
+        else
+            ok = false;
+
+        if (!ok)
+        {
+            fprintf(stderr, "cgsme_bench: bad option %s\n", a);
+            return false;
+        }
+    }
+
+    if (o->lengths.count && o->lengths.count != o->widths.count)
+    {
+        fprintf(stderr, "cgsme_bench: --length needs as many values as --width\n");
+        return false;
+    }
+    return true;
+}
+
+static uint64_t hashOutput(uint64_t hash, const uint16_t *cells, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        hash = (hash ^ (cells[i] & 0xFF)) * 1099511628211ULL;
+        hash = (hash ^ (cells[i] >> 8)) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+static int compareDouble(const void *a, const void *b)
+{
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+// nearest rank on a sorted array
+static double percentile(const double *sorted, uint32_t count, double pct)
+{
+    uint32_t rank = (uint32_t)(pct / 100.0 * count + 0.999999);
+    if (rank < 1)
+        rank = 1;
+    if (rank > count)
+        rank = count;
+    return sorted[rank - 1];
+}
+
+static void runConfig(const BenchOptions *o, BenchResult *r, double *latencies)
+{
+    size_t cells = (size_t)r->width * r->length * r->height;
+    uint16_t *out = malloc(sizeof(uint16_t) * cells);
+    cgsme_context *ctx = cgsme_context_create();
+    cgsme_context_set_tile_size(ctx, r->tile);
+    r->runs = 0;
+    r->failures = 0;
+    r->outputHash = 14695981039346656037ULL;
+    for (int p = 0; p < CGSME_PHASE_COUNT; p++)
+        r->phaseUs[p] = 0.0;
+    if (!out || !ctx)
+    {
+        r->failures = 1;
+        free(out);
+        cgsme_context_destroy(ctx);
+        return;
+    }
+
+    double totalUs = 0.0;
+    for (uint32_t s = 0; s < o->seeds.count; s++)
+    {
+        uint32_t seed = o->seeds.values[s];
+        for (uint32_t w = 0; w < o->warmup; w++)
+            cgsme_context_generate_into(ctx, r->width, r->length, r->height, seed, r->fulness, out, r->width);
+
+        for (uint32_t rep = 0; rep < o->reps; rep++)
+        {
+            uint64_t start = benchNowUs();
+            int result = cgsme_context_generate_into(ctx, r->width, r->length, r->height, seed, r->fulness, out, r->width);
+            double us = (double)(benchNowUs() - start);
+            if (result != 0)
+            {
+                r->failures++;
+                continue;
+            }
+            if (rep == 0)
+                r->outputHash = hashOutput(r->outputHash, out, cells);
+            latencies[r->runs++] = us;
+            totalUs += us;
+            for (int p = 0; p < CGSME_PHASE_COUNT; p++)
+                r->phaseUs[p] += (double)cgsme_context_phase_us(ctx, (cgsme_phase)p);
+        }
+    }
+
+    if (r->runs)
+    {
+        qsort(latencies, r->runs, sizeof(double), compareDouble);
+        r->meanUs = totalUs / r->runs;
+        r->p50Us = percentile(latencies, r->runs, 50.0);
+        r->p95Us = percentile(latencies, r->runs, 95.0);
+        r->p99Us = percentile(latencies, r->runs, 99.0);
+        r->tilesPerSecond = totalUs > 0.0 ? (double)cells * r->runs / (totalUs / 1000000.0) : 0.0;
+        for (int p = 0; p < CGSME_PHASE_COUNT; p++)
+            r->phaseUs[p] /= r->runs;
+    }
+    r->contextPeakBytes = cgsme_context_peak_bytes(ctx);
+    r->peakRssKb = peakRssKb();
+
+    cgsme_context_destroy(ctx);
+    free(out);
+}
+
+// the baseline is a CSV this tool wrote, rows are matched on width/length/height/fulness/threads/tile
+static void applyBaseline(const BenchOptions *o, BenchResult *results, uint32_t count)
+{
+    FILE *f = fopen(o->baselinePath, "r");
+    if (!f)
+    {
+        fprintf(stderr, "cgsme_bench: cannot read baseline %s\n", o->baselinePath);
+        return;
+    }
+    char line[512];
+    while (fgets(line, sizeof(line), f))
+    {
+        unsigned w, l, h, fu, th, ti, runs;
+        double mean, p50;
+        if (sscanf(line, "%u,%u,%u,%u,%u,%u,%u,%lf,%lf", &w, &l, &h, &fu, &th, &ti, &runs, &mean, &p50) != 9)
+            continue; // header or junk
+        for (uint32_t i = 0; i < count; i++)
+        {
+            BenchResult *r = &results[i];
+            if (r->width == w && r->length == l && r->height == h && r->fulness == fu && r->threads == th && r->tile == ti)
+            {
+                r->baselineP50Us = p50;
+                r->regression = r->runs && p50 > 0.0 && r->p50Us > p50 * (1.0 + o->tolerancePct / 100.0);
+            }
+        }
+    }
+    fclose(f);
+}
+
+static const char *PHASE_NAMES[CGSME_PHASE_COUNT] = {"mask", "architect", "solve", "weld"};
+
+static void writeCsv(FILE *f, const BenchResult *results, uint32_t count)
+{
+    fprintf(f, "width,length,height,fulness,threads,tile,runs,mean_us,p50_us,p95_us,p99_us,tiles_per_s,speedup");
+    for (int p = 0; p < CGSME_PHASE_COUNT; p++)
+        fprintf(f, ",%s_us", PHASE_NAMES[p]);
+    fprintf(f, ",context_peak_bytes,peak_rss_kb,failures\n");
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const BenchResult *r = &results[i];
+        fprintf(f, "%u,%u,%u,%u,%u,%u,%u,%.1f,%.1f,%.1f,%.1f,%.0f,%.3f", r->width, r->length, r->height, r->fulness, r->threads, r->tile,
+                r->runs, r->meanUs, r->p50Us, r->p95Us, r->p99Us, r->tilesPerSecond, r->speedup);
+        for (int p = 0; p < CGSME_PHASE_COUNT; p++)
+            fprintf(f, ",%.1f", r->phaseUs[p]);
+        fprintf(f, ",%zu,%llu,%d\n", r->contextPeakBytes, (unsigned long long)r->peakRssKb, r->failures);
+    }
+}
+
+static void writeJson(FILE *f, const BenchOptions *o, const BenchResult *results, uint32_t count)
+{
+    fprintf(f, "{\n  \"warmup\": %u,\n  \"reps\": %u,\n  \"seeds\": %u,\n  \"results\": [", o->warmup, o->reps,
+            o->seeds.count);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const BenchResult *r = &results[i];
+        fprintf(f, "%s\n    {\"width\": %u, \"length\": %u, \"height\": %u, \"fulness\": %u, \"threads\": %u, \"tile\": %u,",
+                i ? "," : "", r->width, r->length, r->height, r->fulness, r->threads, r->tile);
+        fprintf(f, " \"runs\": %u, \"failures\": %d,", r->runs, r->failures);
+        fprintf(f, " \"mean_us\": %.1f, \"p50_us\": %.1f, \"p95_us\": %.1f, \"p99_us\": %.1f, \"tiles_per_s\": %.0f,",
+                r->meanUs, r->p50Us, r->p95Us, r->p99Us, r->tilesPerSecond);
+        fprintf(f, " \"speedup\": %.3f, \"output_hash\": \"%016llx\", \"output_differs\": %s,", r->speedup,
+                (unsigned long long)r->outputHash, r->outputDiffers ? "true" : "false");
+        fprintf(f, " \"phases_us\": {");
+        for (int p = 0; p < CGSME_PHASE_COUNT; p++)
+            fprintf(f, "%s\"%s\": %.1f", p ? ", " : "", PHASE_NAMES[p], r->phaseUs[p]);
+        fprintf(f, "}, \"context_peak_bytes\": %zu, \"peak_rss_kb\": %llu", r->contextPeakBytes, (unsigned long long)r->peakRssKb);
+        if (r->baselineP50Us > 0.0)
+            fprintf(f, ", \"baseline_p50_us\": %.1f, \"regression\": %s", r->baselineP50Us, r->regression ? "true" : "false");
+        fprintf(f, "}");
+    }
+    fprintf(f, "\n  ]\n}\n");
+}
+
+static bool writeFile(const char *path, const BenchOptions *o, const BenchResult *results, uint32_t count, bool json)
+{
+    FILE *f = fopen(path, "w");
+    if (!f)
+    {
+        fprintf(stderr, "cgsme_bench: cannot write %s\n", path);
+        return false;
+    }
+    if (json)
+        writeJson(f, o, results, count);
+    else
+        writeCsv(f, results, count);
+    fclose(f);
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--help") == 0 || strcmp(argv[i], "-h") == 0)
+        {
+            printUsage();
+            return 0;
+        }
+    }
+
+    BenchOptions o;
+    if (!parseOptions(argc, argv, &o))
+    {
+        printUsage();
+        return 2;
+    }
+
+    uint32_t perThreads = o.widths.count * o.heights.count * o.fulness.count * o.tiles.count;
+    uint32_t count = perThreads * o.threads.count;
+    BenchResult *results = calloc(count, sizeof(BenchResult));
+    double *latencies = malloc(sizeof(double) * o.seeds.count * o.reps);
+    if (!results || !latencies)
+        return 2;
+
+    printf("%-16s %7s %7s %5s %5s %10s %10s %10s %10s %12s %9s %9s %9s %9s %9s %8s\n", "config", "fulness", "threads",
+           "tile", "runs", "mean_ms", "p50_ms", "p95_ms", "p99_ms", "Mtiles/s", "mask_ms", "arch_ms", "solve_ms", "weld_ms",
+           "rss_MB", "speedup");
+
+    // threads is the outer loop: the pool is process wide, so it is rebuilt once per size.
+    // every later pool size is compared against the first one (speedup and identical output).
+    uint32_t n = 0;
+    for (uint32_t ti = 0; ti < o.threads.count; ti++)
+    {
+        uint32_t threads = o.threads.values[ti];
+        if (threads == 0)
+            cgsme_shutdown_workers();
+        else if (cgsme_init_workers(threads) != 0)
+            fprintf(stderr, "cgsme_bench: worker pool of %u unavailable, spawning threads per call\n", threads);
+
+        for (uint32_t wi = 0; wi < o.widths.count; wi++)
+        {
+            for (uint32_t hi = 0; hi < o.heights.count; hi++)
+            {
+                for (uint32_t fi = 0; fi < o.fulness.count; fi++)
+                {
+                    for (uint32_t si = 0; si < o.tiles.count; si++)
+                    {
+                        BenchResult *r = &results[n];
+                        const BenchResult *first = &results[n % perThreads];
+                        n++;
+                        r->width = o.widths.values[wi];
+                        r->length = o.lengths.count ? o.lengths.values[wi] : r->width;
+                        r->height = o.heights.values[hi];
+                        r->fulness = o.fulness.values[fi];
+                        r->threads = threads;
+                        r->tile = o.tiles.values[si];
+                        runConfig(&o, r, latencies);
+                        r->speedup = r->p50Us > 0.0 ? first->p50Us / r->p50Us : 0.0;
+                        r->outputDiffers = r->outputHash != first->outputHash;
+
+                        char config[32];
+                        snprintf(config, sizeof(config), "%ux%ux%u", r->width, r->length, r->height);
+                        printf("%-16s %6u%% %7u %5u %5u %10.3f %10.3f %10.3f %10.3f %12.3f %9.3f %9.3f %9.3f %9.3f %9.1f %7.2fx%s%s\n",
+                               config, r->fulness, r->threads, r->tile, r->runs, r->meanUs / 1000.0, r->p50Us / 1000.0,
+                               r->p95Us / 1000.0, r->p99Us / 1000.0, r->tilesPerSecond / 1e6, r->phaseUs[CGSME_PHASE_MASK] / 1000.0,
+                               r->phaseUs[CGSME_PHASE_ARCHITECT] / 1000.0, r->phaseUs[CGSME_PHASE_SOLVE] / 1000.0,
+                               r->phaseUs[CGSME_PHASE_WELD] / 1000.0, r->peakRssKb / 1024.0, r->speedup,
+                               r->failures ? " (FAILED CALLS)" : "", r->outputDiffers ? " (OUTPUT DIFFERS)" : "");
+                    }
+                }
+            }
+        }
+    }
+    cgsme_shutdown_workers();
+
+    // the output only depends on seed and tile size, never on the thread count
+    bool ok = true;
+    for (uint32_t i = 0; i < count; i++)
+        ok = ok && results[i].failures == 0 && !results[i].outputDiffers;
+
+    if (o.baselinePath)
+    {
+        applyBaseline(&o, results, count);
+        uint32_t regressions = 0;
+        for (uint32_t i = 0; i < count; i++)
+        {
+            const BenchResult *r = &results[i];
+            if (r->baselineP50Us <= 0.0)
+                continue;
+            printf("%ux%ux%u %u%% threads %u tile %u: p50 %.3f ms vs baseline %.3f ms (%+.1f%%)%s\n", r->width, r->length, r->height,
+                   r->fulness, r->threads, r->tile, r->p50Us / 1000.0, r->baselineP50Us / 1000.0, (r->p50Us / r->baselineP50Us - 1.0) * 100.0,
+                   r->regression ? " REGRESSION" : "");
+            regressions += r->regression;
+        }
+        printf("%u regression(s) beyond %.1f%%\n", regressions, o.tolerancePct);
+        ok = ok && regressions == 0;
+    }
+
+    if (o.jsonPath)
+        ok = writeFile(o.jsonPath, &o, results, count, true) && ok;
+    if (o.csvPath)
+        ok = writeFile(o.csvPath, &o, results, count, false) && ok;
+
+    free(results);
+    free(latencies);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,354 @@
+#include "cgsme_bitplane.h"
+#include "cgsme_tileset.h"
+#include "cgsme_solver.h"
+#include "cgsme_debug.h"
+#include <string.h>
+
+// x86 kernels are compiled with per-function target attributes and picked at runtime (like the
+// noise row kernels), so the library itself still builds for the baseline ISA
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CGSME_BITPLANE_X86 1
+#include <immintrin.h>
+#endif
+
+// sweeps before giving up on a fixpoint (revivals could in theory keep flipping a cell)
+#define BITPLANE_MAX_SWEEPS 100000
+
+BitplaneLayer *createBitplaneLayer(uint32_t width, uint32_t length, CgsmeArena *arena)
+{
+	CGSME_PROFILE_FUNC();
+	BitplaneLayer *bp = arenaAlloc(arena, sizeof(BitplaneLayer));
+	if (!bp)
+		return NULL;
+	bp->width = width;
+	bp->length = length;
+	bp->wordsPerRow = (width + 63) / 64;
+	bp->stride = bp->wordsPerRow + 2;
+	bp->planeWords = (size_t)bp->stride * (length + 2);
+
+	// 16 planes and 5 scratch boards in one block, all void / zero
+	uint64_t *words = arenaCalloc(arena, bp->planeWords * 21, sizeof(uint64_t));
+	if (!words)
+		return NULL;
+	for (int t = 0; t < 16; t++)
+		bp->planes[t] = words + bp->planeWords * t;
+	bp->multi = words + bp->planeWords * 16;
+	for (int d = 0; d < 4; d++)
+		bp->port[d] = words + bp->planeWords * (17 + d);
+	return bp;
+}
+
+// word and bit of a cell
+static inline size_t cellWord(const BitplaneLayer *bp, uint32_t x, uint32_t y)
+{
+	return (size_t)(y + 1) * bp->stride + 1 + x / 64;
+}
+
+// 64 cells <-> one word per plane, the 16 words are gathered in registers
+void bitplaneLoad(BitplaneLayer *bp, uint16_t **gridLayer)
+{
+	CGSME_PROFILE_FUNC();
+	for (uint32_t y = 0; y < bp->length; y++)
+	{
+		const uint16_t *row = gridLayer[y];
+		for (uint32_t k = 0; k < bp->wordsPerRow; k++)
+		{
+			uint32_t x0 = k * 64;
+			uint32_t count = bp->width - x0 < 64 ? bp->width - x0 : 64;
+			uint64_t acc[16] = {0};
+			for (uint32_t b = 0; b < count; b++)
+			{
+				uint64_t v = row[x0 + b];
+				for (int t = 0; t < 16; t++)
+					acc[t] |= ((v >> t) & 1) << b;
+			}
+			size_t i = cellWord(bp, x0, y);
+			for (int t = 0; t < 16; t++)
+				bp->planes[t][i] = acc[t];
+		}
+	}
+}
+
+void bitplaneStore(const BitplaneLayer *bp, uint16_t **gridLayer)
+{
+	CGSME_PROFILE_FUNC();
+	for (uint32_t y = 0; y < bp->length; y++)
+	{
+		uint16_t *row = gridLayer[y];
+		for (uint32_t k = 0; k < bp->wordsPerRow; k++)
+		{
+			uint32_t x0 = k * 64;
+			uint32_t count = bp->width - x0 < 64 ? bp->width - x0 : 64;
+			size_t i = cellWord(bp, x0, y);
+			uint64_t planes[16];
+			for (int t = 0; t < 16; t++)
+				planes[t] = bp->planes[t][i];
+			for (uint32_t b = 0; b < count; b++)
+			{
+				uint16_t v = 0;
+				for (int t = 0; t < 16; t++)
+					v |= (uint16_t)(((planes[t] >> b) & 1) << t);
+				row[x0 + b] = v;
+			}
+		}
+	}
+}
+
+// --- SCALAR KERNELS ---
+
+// pass A: open cells and the ports of decided cells (a void has none)
+static void deriveScalar(BitplaneLayer *bp, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; i++)
+	{
+		uint64_t seen = 0, multi = 0;
+		uint64_t ports[4] = {0, 0, 0, 0};
+		for (int t = 0; t < 16; t++)
+		{
+			uint64_t p = bp->planes[t][i];
+			multi |= seen & p;
+			seen |= p;
+			for (int d = 0; d < 4; d++)
+				if (TILE_PORTS[t] & (1u << d))
+					ports[d] |= p;
+		}
+		bp->multi[i] = multi;
+		for (int d = 0; d < 4; d++)
+			bp->port[d][i] = ports[d] & ~multi;
+	}
+}
+
+// pass B: narrow every open cell against its four neighbours (see revivedState in cgsme_solver.c).
+// reads only the pass A boards, so the words can be done in any order. returns the changed bits.
+static uint64_t narrowScalar(BitplaneLayer *bp, size_t begin, size_t end)
+{
+	const size_t s = bp->stride;
+	const uint64_t *multi = bp->multi;
+	uint64_t changed = 0;
+	for (size_t i = begin; i < end; i++)
+	{
+		uint64_t open = multi[i];
+		if (!open)
+			continue;
+
+		// demanded ports: the neighbour is decided and has (open) or has not (closed) a port back
+		uint64_t openReq[4], closedReq[4];
+		openReq[0] = bp->port[2][i - s]; // north neighbour, its south port
+		closedReq[0] = ~multi[i - s] & ~openReq[0];
+		openReq[2] = bp->port[0][i + s];
+		closedReq[2] = ~multi[i + s] & ~openReq[2];
+		openReq[1] = (bp->port[3][i] >> 1) | (bp->port[3][i + 1] << 63); // east neighbour (x + 1)
+		closedReq[1] = ~((multi[i] >> 1) | (multi[i + 1] << 63)) & ~openReq[1];
+		openReq[3] = (bp->port[1][i] << 1) | (bp->port[1][i - 1] >> 63); // west neighbour (x - 1)
+		closedReq[3] = ~((multi[i] << 1) | (multi[i - 1] >> 63)) & ~openReq[3];
+
+		uint64_t allowed[16];
+		uint64_t any = 0;
+		for (int t = 0; t < 16; t++)
+		{
+			uint64_t ban = 0;
+			for (int d = 0; d < 4; d++)
+				ban |= (TILE_PORTS[t] & (1u << d)) ? closedReq[d] : openReq[d];
+			allowed[t] = ~ban;
+			any |= bp->planes[t][i] & allowed[t];
+		}
+
+		// decided cells keep their state, contradicted open cells restart from `allowed`
+		uint64_t keep = ~open;
+		uint64_t revive = open & ~any;
+		for (int t = 0; t < 16; t++)
+		{
+			uint64_t old = bp->planes[t][i];
+			uint64_t now = (old & (keep | allowed[t])) | (allowed[t] & revive);
+			changed |= old ^ now;
+			bp->planes[t][i] = now;
+		}
+	}
+	return changed;
+}
+
+// --- AVX2 KERNELS (4 words = 256 cells per step, scalar tail) ---
+#ifdef CGSME_BITPLANE_X86
+#define LOAD256(p) _mm256_loadu_si256((const __m256i *)(p))
+#define STORE256(p, v) _mm256_storeu_si256((__m256i *)(p), (v))
+
+__attribute__((target("avx2"))) static void deriveAvx2(BitplaneLayer *bp, size_t begin, size_t end)
+{
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m256i seen = _mm256_setzero_si256(), multi = _mm256_setzero_si256();
+		__m256i ports[4] = {seen, seen, seen, seen};
+		for (int t = 0; t < 16; t++)
+		{
+			__m256i p = LOAD256(&bp->planes[t][i]);
+			multi = _mm256_or_si256(multi, _mm256_and_si256(seen, p));
+			seen = _mm256_or_si256(seen, p);
+			for (int d = 0; d < 4; d++)
+				if (TILE_PORTS[t] & (1u << d))
+					ports[d] = _mm256_or_si256(ports[d], p);
+		}
+		STORE256(&bp->multi[i], multi);
+		for (int d = 0; d < 4; d++)
+			STORE256(&bp->port[d][i], _mm256_andnot_si256(multi, ports[d]));
+	}
+	deriveScalar(bp, i, end);
+}
+
+__attribute__((target("avx2"))) static uint64_t narrowAvx2(BitplaneLayer *bp, size_t begin, size_t end)
+{
+	const size_t s = bp->stride;
+	const uint64_t *multi = bp->multi;
+	const __m256i ones = _mm256_set1_epi64x(-1);
+	__m256i changed = _mm256_setzero_si256();
+	size_t i = begin;
+	for (; i + 4 <= end; i += 4)
+	{
+		__m256i open = LOAD256(&multi[i]);
+		if (_mm256_testz_si256(open, open))
+			continue;
+
+		__m256i openReq[4], closedReq[4];
+		openReq[0] = LOAD256(&bp->port[2][i - s]);
+		closedReq[0] = _mm256_andnot_si256(_mm256_or_si256(LOAD256(&multi[i - s]), openReq[0]), ones);
+		openReq[2] = LOAD256(&bp->port[0][i + s]);
+		closedReq[2] = _mm256_andnot_si256(_mm256_or_si256(LOAD256(&multi[i + s]), openReq[2]), ones);
+		// the east / west neighbours need the bits of the next / previous word: unaligned loads
+		openReq[1] = _mm256_or_si256(_mm256_srli_epi64(LOAD256(&bp->port[3][i]), 1), _mm256_slli_epi64(LOAD256(&bp->port[3][i + 1]), 63));
+		__m256i multiE = _mm256_or_si256(_mm256_srli_epi64(open, 1), _mm256_slli_epi64(LOAD256(&multi[i + 1]), 63));
+		closedReq[1] = _mm256_andnot_si256(_mm256_or_si256(multiE, openReq[1]), ones);
+		openReq[3] = _mm256_or_si256(_mm256_slli_epi64(LOAD256(&bp->port[1][i]), 1), _mm256_srli_epi64(LOAD256(&bp->port[1][i - 1]), 63));
+		__m256i multiW = _mm256_or_si256(_mm256_slli_epi64(open, 1), _mm256_srli_epi64(LOAD256(&multi[i - 1]), 63));
+		closedReq[3] = _mm256_andnot_si256(_mm256_or_si256(multiW, openReq[3]), ones);
+
+		__m256i allowed[16];
+		__m256i any = _mm256_setzero_si256();
+		for (int t = 0; t < 16; t++)
+		{
+			__m256i ban = _mm256_setzero_si256();
+			for (int d = 0; d < 4; d++)
+				ban = _mm256_or_si256(ban, (TILE_PORTS[t] & (1u << d)) ? closedReq[d] : openReq[d]);
+			allowed[t] = _mm256_andnot_si256(ban, ones);
+			any = _mm256_or_si256(any, _mm256_and_si256(LOAD256(&bp->planes[t][i]), allowed[t]));
+		}
+
+		__m256i keep = _mm256_andnot_si256(open, ones);
+		__m256i revive = _mm256_andnot_si256(any, open);
+		for (int t = 0; t < 16; t++)
+		{
+			__m256i old = LOAD256(&bp->planes[t][i]);
+			__m256i now = _mm256_or_si256(_mm256_and_si256(old, _mm256_or_si256(keep, allowed[t])), _mm256_and_si256(allowed[t], revive));
+			changed = _mm256_or_si256(changed, _mm256_xor_si256(old, now));
+			STORE256(&bp->planes[t][i], now);
+		}
+	}
+
+	uint64_t lanes[4];
+	STORE256(lanes, changed);
+	return lanes[0] | lanes[1] | lanes[2] | lanes[3] | narrowScalar(bp, i, end);
+}
+#endif // CGSME_BITPLANE_X86
+
+uint32_t bitplanePropagate(BitplaneLayer *bp, CgsmeBitplaneIsa isa)
+{
+	CGSME_PROFILE_FUNC();
+	// every row including its guard words, the guard rows stay zero (void)
+	size_t begin = bp->stride;
+	size_t end = (size_t)(bp->length + 1) * bp->stride;
+	uint32_t sweeps = 0;
+	uint64_t changed;
+	do
+	{
+#ifdef CGSME_BITPLANE_X86
+		if (isa == CGSME_BITPLANE_AVX2)
+		{
+			deriveAvx2(bp, begin, end);
+			changed = narrowAvx2(bp, begin, end);
+		}
+		else
+#endif
+		{
+			deriveScalar(bp, begin, end);
+			changed = narrowScalar(bp, begin, end);
+		}
+		sweeps++;
+	} while (changed && sweeps < BITPLANE_MAX_SWEEPS);
+	return sweeps;
+}
+
+// any open cell left (reads the pass A board of the last sweep)
+static bool hasOpenCells(const BitplaneLayer *bp)
+{
+	size_t end = (size_t)(bp->length + 1) * bp->stride;
+	for (size_t i = bp->stride; i < end; i++)
+		if (bp->multi[i])
+			return true;
+	return false;
+}
+
+uint32_t bitplaneFill(BitplaneLayer *bp, float *rates, const CgsmeRng *rng, CgsmeBitplaneIsa isa)
+{
+	CGSME_PROFILE_FUNC();
+	uint32_t rounds = 0;
+	bitplanePropagate(bp, isa);
+
+	// cells are never reopened, and after one colour is collapsed the other one only has to pick
+	// among tiles that fit all four sides, so this ends after two or three rounds. a cell whose
+	// neighbours are closed on every side becomes void, like in the solver
+	for (uint32_t colour = 0; hasOpenCells(bp); colour ^= 1)
+	{
+		for (uint32_t y = 0; y < bp->length; y++)
+		{
+			// bit x set where (x + y) & 1 == colour (64 is even, so the same in every word)
+			uint64_t pattern = ((y & 1) ^ colour) ? 0xAAAAAAAAAAAAAAAAULL : 0x5555555555555555ULL;
+			for (uint32_t k = 0; k < bp->wordsPerRow; k++)
+			{
+				size_t i = (size_t)(y + 1) * bp->stride + 1 + k;
+				uint64_t todo = bp->multi[i] & pattern;
+				while (todo)
+				{
+					uint32_t b = (uint32_t)__builtin_ctzll(todo);
+					uint64_t bit = 1ULL << b;
+					todo &= todo - 1;
+
+					uint16_t state = 0;
+					for (int t = 0; t < 16; t++)
+						state |= (uint16_t)(((bp->planes[t][i] >> b) & 1) << t);
+					CgsmeRng cellRng = cgsme_rng_split(rng, (uint64_t)y * bp->width + k * 64 + b);
+					collapseTile(&state, rates, &cellRng);
+					for (int t = 0; t < 16; t++)
+						bp->planes[t][i] = (bp->planes[t][i] & ~bit) | (((state >> t) & 1) ? bit : 0);
+				}
+			}
+		}
+		rounds++;
+		bitplanePropagate(bp, isa);
+	}
+	return rounds;
+}
+
+bool bitplaneIsaSupported(CgsmeBitplaneIsa isa)
+{
+	switch (isa)
+	{
+	case CGSME_BITPLANE_SCALAR:
+		return true;
+#ifdef CGSME_BITPLANE_X86
+	case CGSME_BITPLANE_AVX2:
+		return __builtin_cpu_supports("avx2");
+#endif
+	default:
+		return false;
+	}
+}
+
+CgsmeBitplaneIsa bitplaneBestIsa(void)
+{
+	return bitplaneIsaSupported(CGSME_BITPLANE_AVX2) ? CGSME_BITPLANE_AVX2 : CGSME_BITPLANE_SCALAR;
+}
+
+const char *bitplaneIsaName(CgsmeBitplaneIsa isa)
+{
+	static const char *names[CGSME_BITPLANE_ISA_COUNT] = {"scalar", "avx2"};
+	return (unsigned)isa < CGSME_BITPLANE_ISA_COUNT ? names[isa] : "unknown";
+}
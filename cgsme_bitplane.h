@@ -0,0 +1,93 @@
+#ifndef CGSME_BITPLANE_H
+#define CGSME_BITPLANE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cgsme_utils.h"
+#include "threadRandom.h"
+#include "tiles.h"
+
+/*
+	BITPLANE LAYER (experimental)
+
+	a layer stored as 16 bitboards, one per tile type: bit x of word k in row y of plane t is set
+	if cell (64k + x, y) may still be tile t. propagation handles 64 cells per word (256 with
+	AVX2): every sweep derives "decided" and "has a port towards d" boards from the planes and
+	then narrows each open cell against its four neighbours with shifts, ANDs and ORs, the same
+	rule as constrainFromNeighbours (contradictions restart from what the neighbours allow).
+	sweeps repeat until nothing changes.
+
+	rows carry one guard word on each side and there is one guard row above and below. guards and
+	the bits past the width are void, which is exactly the padded ring of the solver.
+
+	not used by the generator yet, see --cgsme-bench-bitplane.
+*/
+
+typedef enum
+{
+	CGSME_BITPLANE_SCALAR = 0,
+	CGSME_BITPLANE_AVX2,
+	CGSME_BITPLANE_ISA_COUNT
+} CgsmeBitplaneIsa;
+
+typedef struct
+{
+	uint32_t width;
+	uint32_t length;
+	uint32_t wordsPerRow; // words holding cells
+	uint32_t stride;	  // words per row including both guard words
+	size_t planeWords;	  // stride * (length + 2)
+	uint64_t *planes[16];
+	// per sweep scratch: open cells, and decided cells with a port towards N / E / S / W
+	uint64_t *multi;
+	uint64_t *port[4];
+} BitplaneLayer;
+
+/// @brief Create an empty (all void) bitplane layer.
+/// @param width Layer width.
+/// @param length Layer length.
+/// @param arena Arena the storage is taken from (released by the caller).
+/// @return Pointer to the layer, NULL if the arena is out of memory.
+BitplaneLayer *createBitplaneLayer(uint32_t width, uint32_t length, CgsmeArena *arena);
+
+/// @brief Convert a uint16_t layer into bitplanes.
+/// @param bp Bitplane layer of the same size.
+/// @param gridLayer Layer indexed [y][x] (padded or not, the ring is not read).
+void bitplaneLoad(BitplaneLayer *bp, uint16_t **gridLayer);
+
+/// @brief Convert bitplanes back into a uint16_t layer.
+/// @param bp Bitplane layer.
+/// @param gridLayer Layer indexed [y][x] of the same size.
+void bitplaneStore(const BitplaneLayer *bp, uint16_t **gridLayer);
+
+/// @brief Propagate the constraints of every decided cell (void or single tile) until nothing changes.
+/// @param bp Bitplane layer, narrowed in place.
+/// @param isa Kernel to use (must be supported, see bitplaneIsaSupported).
+/// @return Number of sweeps.
+uint32_t bitplanePropagate(BitplaneLayer *bp, CgsmeBitplaneIsa isa);
+
+/// @brief Fill every open cell ("Ocean" full fill): checkerboard rounds collapse all open cells of one
+///        colour (never neighbours) with `rates` (see collapseTile), then propagate word-parallel.
+/// @param bp Bitplane layer, solved in place (constraints do not have to be propagated yet).
+/// @param rates Spawn rates, NUM_TILE_TYPES floats.
+/// @param rng Parent stream, every cell collapses with its own stream split off it.
+/// @param isa Kernel to use for the propagation.
+/// @return Number of collapse rounds.
+uint32_t bitplaneFill(BitplaneLayer *bp, float *rates, const CgsmeRng *rng, CgsmeBitplaneIsa isa);
+
+/// @brief Check whether a kernel is compiled in and the CPU can run it.
+/// @param isa Kernel to check.
+/// @return true if it may be passed to bitplanePropagate / bitplaneFill.
+bool bitplaneIsaSupported(CgsmeBitplaneIsa isa);
+
+/// @brief Widest supported kernel.
+/// @return Kernel id.
+CgsmeBitplaneIsa bitplaneBestIsa(void);
+
+/// @brief Printable kernel name.
+/// @param isa Kernel id.
+/// @return Static string.
+const char *bitplaneIsaName(CgsmeBitplaneIsa isa);
+
+#endif // CGSME_BITPLANE_H
@@ -0,0 +1,172 @@
+#include "cgsme_context.h"
+#include "generator.h"
+#include "cgsme_debug.h"
+#include <stdlib.h>
+#include <string.h>
+
+cgsme_context *cgsme_context_create(void)
+{
+    CGSME_PROFILE_FUNC();
+    cgsme_context *ctx = calloc(1, sizeof(cgsme_context));
+    if (!ctx)
+        return NULL;
+    arenaInit(&ctx->mainArena);
+    return ctx;
+}
+
+void cgsme_context_destroy(cgsme_context *ctx)
+{
+    CGSME_PROFILE_FUNC();
+    if (!ctx)
+        return;
+
+    arenaDestroy(&ctx->mainArena);
+    for (uint32_t i = 0; i < ctx->layerArenaCount; i++)
+        arenaDestroy(&ctx->layerArenas[i]);
+    free(ctx->layerArenas);
+    free(ctx->layerArenaBusy);
+    free(ctx->layerStats);
+
+    free(ctx->gridData);
+    free(ctx->gridRows);
+    free(ctx->grid);
+    free(ctx);
+}
+
+void cgsme_context_set_scheduler(cgsme_context *ctx, cgsme_scheduler scheduler)
+{
+    if (ctx)
+        ctx->scheduler = scheduler;
+}
+
+void cgsme_context_set_tile_size(cgsme_context *ctx, uint32_t tileSize)
+{
+    if (!ctx)
+        return;
+    ctx->tileSize = tileSize && tileSize < CGSME_MIN_TILE_SIZE ? CGSME_MIN_TILE_SIZE : tileSize;
+}
+
+size_t cgsme_context_peak_bytes(const cgsme_context *ctx)
+{
+    if (!ctx)
+        return 0;
+    // upper bound: every slot at its own peak at the same time
+    size_t total = ctx->mainArena.peak;
+    for (uint32_t i = 0; i < ctx->layerArenaCount; i++)
+        total += ctx->layerArenas[i].peak;
+    return total;
+}
+
+uint64_t cgsme_context_heap_allocations(const cgsme_context *ctx)
+{
+    if (!ctx)
+        return 0;
+    uint64_t total = ctx->mainArena.heapAllocs;
+    for (uint32_t i = 0; i < ctx->layerArenaCount; i++)
+        total += ctx->layerArenas[i].heapAllocs;
+    return total;
+}
+
+uint32_t cgsme_context_layer_reseeds(const cgsme_context *ctx, uint32_t layer)
+{
+    if (!ctx || layer >= ctx->layerCount)
+        return 0;
+    return ctx->layerStats[layer].reseeds;
+}
+
+uint64_t cgsme_context_phase_us(const cgsme_context *ctx, cgsme_phase phase)
+{
+    if (!ctx)
+        return 0;
+    uint64_t total = 0;
+    switch (phase)
+    {
+    case CGSME_PHASE_MASK:
+        return ctx->maskUs;
+    case CGSME_PHASE_ARCHITECT:
+        return ctx->architectUs;
+    case CGSME_PHASE_SOLVE:
+        for (uint32_t i = 0; i < ctx->layerCount; i++)
+            total += ctx->layerStats[i].solveUs;
+        return total;
+    case CGSME_PHASE_WELD:
+        for (uint32_t i = 0; i < ctx->layerCount; i++)
+            total += ctx->layerStats[i].weldUs;
+        return total;
+    default:
+        return 0;
+    }
+}
+
+bool contextPrepareLayers(cgsme_context *ctx, CgsmePool *pool, uint32_t height, bool tiled)
+{
+    // jobs holding a slot at once: a thread runs one layer at a time (workers plus the helping
+    // caller, or a thread per layer), and in tiled mode one window on top (a layer's own thread
+    // runs its windows while it holds the layer's slot)
+    uint32_t threads = pool ? cgsme_pool_thread_count(pool) + 1 : height;
+    uint32_t needed = (height < threads ? height : threads) + (tiled ? threads : 0);
+
+    if (needed > ctx->layerArenaCount)
+    {
+        CgsmeArena *arenas = realloc(ctx->layerArenas, sizeof(CgsmeArena) * needed);
+        if (!arenas)
+            return false;
+        ctx->layerArenas = arenas;
+        atomic_bool *busy = realloc(ctx->layerArenaBusy, sizeof(atomic_bool) * needed);
+        if (!busy)
+            return false;
+        ctx->layerArenaBusy = busy;
+        for (uint32_t i = ctx->layerArenaCount; i < needed; i++)
+        {
+            arenaInit(&arenas[i]);
+            atomic_init(&busy[i], false);
+        }
+        ctx->layerArenaCount = needed;
+    }
+    ctx->layerArenaReach = needed;
+
+    if (height > ctx->layerStatsCap)
+    {
+        CgsmeLayerStats *stats = realloc(ctx->layerStats, sizeof(CgsmeLayerStats) * height);
+        if (!stats)
+            return false;
+        ctx->layerStats = stats;
+        ctx->layerStatsCap = height;
+    }
+    memset(ctx->layerStats, 0, sizeof(CgsmeLayerStats) * height);
+    ctx->layerCount = height;
+    ctx->maskUs = 0;
+    ctx->architectUs = 0;
+
+    ctx->pool = pool;
+    return true;
+}
+
+void contextBalanceLayerArenas(cgsme_context *ctx)
+{
+    // slots past the reach of this call are left alone, no job of it could have taken them
+    size_t maxPeak = 0;
+    for (uint32_t i = 0; i < ctx->layerArenaReach; i++)
+        if (ctx->layerArenas[i].peak > maxPeak)
+            maxPeak = ctx->layerArenas[i].peak;
+
+    // the scratch of a layer varies a little with the seed, the headroom keeps later seeds
+    // from growing an arena that is only just big enough
+    for (uint32_t i = 0; i < ctx->layerArenaReach; i++)
+        if (ctx->layerArenas[i].reserved < maxPeak + maxPeak / 16)
+            arenaReserve(&ctx->layerArenas[i], maxPeak + maxPeak / 8);
+}
+
+CgsmeArena *contextAcquireLayerArena(cgsme_context *ctx)
+{
+    // lowest free slot first: with k jobs side by side only slots 0..k-1 are ever used
+    for (uint32_t i = 0; i < ctx->layerArenaReach; i++)
+        if (!atomic_exchange_explicit(&ctx->layerArenaBusy[i], true, memory_order_acquire))
+            return &ctx->layerArenas[i];
+    return NULL;
+}
+
+void contextReleaseLayerArena(cgsme_context *ctx, CgsmeArena *arena)
+{
+    atomic_store_explicit(&ctx->layerArenaBusy[arena - ctx->layerArenas], false, memory_order_release);
+}
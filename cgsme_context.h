@@ -0,0 +1,86 @@
+#ifndef CGSME_CONTEXT_H
+#define CGSME_CONTEXT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
+#include "cgsme_utils.h"
+#include "cgsme_pool.h"
+#include "generator.h"
+
+// what each layer job reports back (one slot per layer, written by the job that owns it)
+typedef struct
+{
+    uint32_t reseeds; // queue ran dry
+    uint64_t solveUs; // copy-in, propagation and the collapse loop
+    uint64_t weldUs;  // seal, label and weld
+} CgsmeLayerStats;
+
+// reusable generation state (public handle is declared in generator.h)
+// everything a call needs is carved out of these arenas, so repeated calls through
+// the same context stop allocating once the largest map has been seen.
+struct cgsme_context
+{
+    // grid level scratch (mask, architect, job args), only used by the calling thread
+    CgsmeArena mainArena;
+
+    // layer scratch slots, checked out by every layer (and tile window) job for its run. a job
+    // takes the lowest free slot, so a call only reaches as many slots as jobs ran side by side.
+    CgsmeArena *layerArenas;
+    atomic_bool *layerArenaBusy;
+    uint32_t layerArenaCount;
+    uint32_t layerArenaReach; // slots the current call can reach (see contextPrepareLayers)
+
+    // pool the current call runs on (NULL = thread per layer)
+    CgsmePool *pool;
+
+    // solver cell ordering
+    cgsme_scheduler scheduler;
+
+    // intra-layer tiles (0 = every layer is solved in one piece)
+    uint32_t tileSize;
+
+    // per layer stats of the last call
+    CgsmeLayerStats *layerStats;
+    uint32_t layerStatsCap;
+    uint32_t layerCount;
+
+    // calling thread phases of the last call (mask, architect), microseconds
+    uint64_t maskUs;
+    uint64_t architectUs;
+
+    // output of cgsme_context_generate, grown to the largest map seen
+    uint16_t *gridData;
+    uint16_t **gridRows;
+    uint16_t ***grid;
+    size_t gridDataCap;
+    size_t gridRowsCap;
+    size_t gridLayersCap;
+};
+
+/// @brief Bind the context to a pool (or none) and make sure enough layer arena slots exist.
+/// @param ctx Pointer to the context.
+/// @param pool Pool the layers will run on, NULL for one thread per layer.
+/// @param height Number of layers of the upcoming call.
+/// @param tiled true if the layers are solved in tile windows (a window holds a slot of its own).
+/// @return false if the arena or per-layer stats tables could not grow.
+bool contextPrepareLayers(struct cgsme_context *ctx, CgsmePool *pool, uint32_t height, bool tiled);
+
+/// @brief Grow the slots the call could reach to the largest peak any of them has seen (plus
+///        some headroom). How many jobs overlap depends on timing, so a slot that sat idle would
+///        otherwise only grow in some later call. Only call it while no layer job runs.
+/// @param ctx Pointer to the context.
+void contextBalanceLayerArenas(struct cgsme_context *ctx);
+
+/// @brief Check out the lowest free layer arena slot for one job.
+/// @param ctx Pointer to the context.
+/// @return Arena owned by the job until contextReleaseLayerArena, NULL if every slot is taken.
+CgsmeArena *contextAcquireLayerArena(struct cgsme_context *ctx);
+
+/// @brief Give a slot back (its allocations must already be released).
+/// @param ctx Pointer to the context.
+/// @param arena Arena returned by contextAcquireLayerArena.
+void contextReleaseLayerArena(struct cgsme_context *ctx, CgsmeArena *arena);
+
+#endif // CGSME_CONTEXT_H
@@ -7,7 +7,12 @@
 #include <time.h>
 #include <inttypes.h>
 #include <string.h>
+#include <stdatomic.h>
+#ifdef __linux__
+#include <threads.h>
+#else
 #include "tinycthread/tinycthread.h"
+#endif
 
 #ifdef _WIN32
 #include <windows.h>
@@ -16,12 +21,12 @@
 static FILE *g_logfile = NULL;
 static mtx_t g_logmtx;
 static int g_logmtx_active = 0;
-static int g_enabled = 0; // 0 or 1
+static atomic_int g_enabled = 0; // 0 or 1, read on every scope without locking
 
 // Profiling aggregates
 typedef struct ProfileEntry
 {
-    char *name;
+    const char *name;
     uint64_t count;
     uint64_t total_us;
     uint64_t min_us;
@@ -31,11 +36,64 @@ typedef struct ProfileEntry
     uint64_t max_cycles;
 } ProfileEntry;
 
-static ProfileEntry *g_profiles = NULL;
-static size_t g_profile_count = 0;
-static size_t g_profile_capacity = 0;
-static uint64_t g_profile_threshold_us = 1000ULL; // default 1ms
-static uint64_t g_profile_threshold_cycles = 0ULL;
+// SITES: every profiled scope gets a small ID the first time it runs (cached in a static next
+// to the scope), IDs index straight into the per-thread tables. same name = same ID, so the
+// name based cgsme_profile_record and the scope macro share one row.
+static const char *g_site_names[CGSME_PROFILE_MAX_SITES];
+static atomic_uint g_site_count = 0; // sites 1..g_site_count are in use
+static atomic_flag g_site_lock = ATOMIC_FLAG_INIT;
+
+// TIMELINE: one complete event (begin + duration) per traced scope, in a ring per thread
+// (preallocated on the thread's first traced scope, the oldest events are overwritten)
+typedef struct
+{
+    uint32_t site;
+    uint64_t start_us;
+    uint64_t dur_us;
+} TraceEvent;
+
+typedef struct TraceRing
+{
+    TraceEvent *events;
+    uint32_t capacity;
+    uint32_t tid;
+    uint64_t written; // total events pushed, the ring holds the last min(written, capacity)
+    struct TraceRing *next;
+} TraceRing;
+
+// PER-THREAD TABLES: a thread only ever writes its own table, no locks on the record path.
+// tables are linked into g_tables when created, folded into g_retired when their thread exits
+// (tss destructor) and everything is merged at shutdown. the lists are guarded by a spin flag
+// instead of g_logmtx: it needs no init and outlives cgsme_shutdown_debug, pool workers may
+// exit after it.
+typedef struct ProfileTable
+{
+    ProfileEntry entries[CGSME_PROFILE_MAX_SITES];
+    uint64_t traced[CGSME_PROFILE_MAX_SITES]; // traced exits per site (sampling, aggregates may be off)
+    uint32_t tid;    // order of the thread's first record, trace "tid"
+    uint32_t depth;  // open scopes (only tracked while tracing)
+    TraceRing *ring; // NULL until the thread traces
+    struct ProfileTable *next;
+} ProfileTable;
+
+static _Thread_local ProfileTable *tl_table = NULL;
+static atomic_flag g_table_lock = ATOMIC_FLAG_INIT;
+static ProfileTable *g_tables = NULL;  // live threads (under g_table_lock)
+static ProfileTable *g_retired = NULL; // threads that exited (under g_table_lock)
+static tss_t g_table_key;
+static int g_table_key_active = 0;
+static atomic_uint g_thread_count = 0;
+
+// trace settings (cgsme_trace_enable), rings of exited threads wait in g_retired_rings
+static atomic_int g_trace_active = 0;
+static char *g_trace_path = NULL;
+static uint32_t g_trace_capacity = CGSME_TRACE_DEFAULT_EVENTS;
+static uint32_t g_trace_max_depth = 0;
+static uint32_t g_trace_sample_every = 1;
+static TraceRing *g_retired_rings = NULL; // (under g_table_lock)
+
+static _Atomic uint64_t g_profile_threshold_us = 1000ULL; // default 1ms
+static _Atomic uint64_t g_profile_threshold_cycles = 0ULL;
 static double g_profile_warning_percent = 5.0; // percent of total time to mark as hot
 
 // Run info (set by generator)
@@ -49,17 +107,30 @@ static struct
     int valid;
 } g_runinfo = {0, 0, 0, 0, 0, 0};
 
+static void profileThreadExit(void *arg);
+
+static void tableLock(void)
+{
+    while (atomic_flag_test_and_set_explicit(&g_table_lock, memory_order_acquire))
+        ;
+}
+
+static void tableUnlock(void)
+{
+    atomic_flag_clear_explicit(&g_table_lock, memory_order_release);
+}
+
 // Quick mode flag (minimize overhead when benchmarking)
-static int g_quick_mode = 0;
+static atomic_int g_quick_mode = 0;
 
 void cgsme_set_quick_mode(bool enabled)
 {
-    g_quick_mode = enabled ? 1 : 0;
+    atomic_store_explicit(&g_quick_mode, enabled ? 1 : 0, memory_order_relaxed);
 }
 
 bool cgsme_quick_mode_enabled(void)
 {
-    return g_quick_mode != 0;
+    return atomic_load_explicit(&g_quick_mode, memory_order_relaxed) != 0;
 }
 
 void cgsme_init_debug(void)
@@ -75,6 +146,10 @@ void cgsme_init_debug(void)
 
     g_logmtx_active = 1;
 
+    // the key outlives shutdown/init cycles, threads may still hold a table
+    if (!g_table_key_active && tss_create(&g_table_key, profileThreadExit) == thrd_success)
+        g_table_key_active = 1;
+
     // open a logfile next to running binary
     g_logfile = fopen("cgsme_debug.log", "a");
     if (!g_logfile)
@@ -84,7 +159,7 @@ void cgsme_init_debug(void)
     }
 
     // default to enabled = false; caller must opt in
-    g_enabled = 0;
+    atomic_store(&g_enabled, 0);
 }
 
 void cgsme_profile_set_thresholds(uint64_t us_threshold, uint64_t cycles_threshold)
@@ -93,10 +168,8 @@ void cgsme_profile_set_thresholds(uint64_t us_threshold, uint64_t cycles_thresho
         cgsme_init_debug();
     if (!g_logmtx_active)
         return;
-    mtx_lock(&g_logmtx);
-    g_profile_threshold_us = us_threshold;
-    g_profile_threshold_cycles = cycles_threshold;
-    mtx_unlock(&g_logmtx);
+    atomic_store(&g_profile_threshold_us, us_threshold);
+    atomic_store(&g_profile_threshold_cycles, cycles_threshold);
 }
 
 void cgsme_profile_set_warning_percent(double pct)
@@ -138,27 +211,8 @@ static char *cgsme_strdup(const char *s)
     return p;
 }
 
-// Find or create profile entry under mutex
-static ProfileEntry *cgsme_profile_find_or_create(const char *name)
+static void profileEntryReset(ProfileEntry *p)
 {
-    // assume mutex is held
-    for (size_t i = 0; i < g_profile_count; ++i)
-    {
-        if (strcmp(g_profiles[i].name, name) == 0)
-            return &g_profiles[i];
-    }
-    // create
-    if (g_profile_count == g_profile_capacity)
-    {
-        size_t newcap = (g_profile_capacity == 0) ? 16 : g_profile_capacity * 2;
-        ProfileEntry *newarr = realloc(g_profiles, sizeof(ProfileEntry) * newcap);
-        if (!newarr)
-            return NULL;
-        g_profiles = newarr;
-        g_profile_capacity = newcap;
-    }
-    ProfileEntry *p = &g_profiles[g_profile_count++];
-    p->name = cgsme_strdup(name);
     p->count = 0;
     p->total_us = 0;
     p->min_us = (uint64_t)-1;
@@ -166,64 +220,365 @@ static ProfileEntry *cgsme_profile_find_or_create(const char *name)
     p->total_cycles = 0;
     p->min_cycles = (uint64_t)-1;
     p->max_cycles = 0;
-    return p;
 }
 
-void cgsme_profile_record(const char *name, uint64_t elapsed_us, uint64_t elapsed_cycles)
+static void profileEntryMerge(ProfileEntry *into, const ProfileEntry *from)
 {
-    if (!g_logmtx_active)
-        cgsme_init_debug();
-    if (!g_logmtx_active)
+    into->count += from->count;
+    into->total_us += from->total_us;
+    into->total_cycles += from->total_cycles;
+    if (from->min_us < into->min_us)
+        into->min_us = from->min_us;
+    if (from->max_us > into->max_us)
+        into->max_us = from->max_us;
+    if (from->min_cycles < into->min_cycles)
+        into->min_cycles = from->min_cycles;
+    if (from->max_cycles > into->max_cycles)
+        into->max_cycles = from->max_cycles;
+}
+
+static ProfileTable *profileTableCreate(void)
+{
+    ProfileTable *t = malloc(sizeof(ProfileTable));
+    if (!t)
+        return NULL;
+    for (uint32_t i = 0; i < CGSME_PROFILE_MAX_SITES; i++)
+        profileEntryReset(&t->entries[i]);
+    memset(t->traced, 0, sizeof(t->traced));
+    t->tid = 0;
+    t->depth = 0;
+    t->ring = NULL;
+    t->next = NULL;
+    return t;
+}
+
+static TraceRing *traceRingCreate(uint32_t tid)
+{
+    TraceRing *r = malloc(sizeof(TraceRing));
+    if (!r)
+        return NULL;
+    r->events = malloc(sizeof(TraceEvent) * g_trace_capacity);
+    if (!r->events)
+    {
+        free(r);
+        return NULL;
+    }
+    r->capacity = g_trace_capacity;
+    r->tid = tid;
+    r->written = 0;
+    r->next = NULL;
+    return r;
+}
+
+static void traceRingFree(TraceRing *r)
+{
+    if (!r)
+        return;
+    free(r->events);
+    free(r);
+}
+
+// tss destructor: fold the table of an exiting thread into g_retired
+static void profileThreadExit(void *arg)
+{
+    ProfileTable *t = (ProfileTable *)arg;
+    if (!t)
         return;
+    // also runs after shutdown (the table was cleared then), whatever is left goes to the next summary
+    tableLock();
+    for (ProfileTable **link = &g_tables; *link; link = &(*link)->next)
+    {
+        if (*link == t)
+        {
+            *link = t->next;
+            break;
+        }
+    }
+    for (uint32_t i = 1; i < CGSME_PROFILE_MAX_SITES; i++)
+    {
+        if (!t->entries[i].count)
+            continue;
+        if (!g_retired)
+            g_retired = profileTableCreate();
+        if (!g_retired)
+            break;
+        profileEntryMerge(&g_retired->entries[i], &t->entries[i]);
+    }
+    // the timeline of the thread is written at shutdown
+    if (t->ring && t->ring->written)
+    {
+        t->ring->next = g_retired_rings;
+        g_retired_rings = t->ring;
+        t->ring = NULL;
+    }
+    tableUnlock();
+    tl_table = NULL;
+    traceRingFree(t->ring);
+    free(t);
+}
+
+// slow path, once per thread
+static ProfileTable *profileThreadTable(void)
+{
+    ProfileTable *t = profileTableCreate();
+    if (!t)
+        return NULL;
+    t->tid = atomic_fetch_add(&g_thread_count, 1);
+    tableLock();
+    t->next = g_tables;
+    g_tables = t;
+    tableUnlock();
+    if (g_table_key_active)
+        tss_set(g_table_key, t);
+    tl_table = t;
+    return t;
+}
 
+uint32_t cgsme_profile_site(uint32_t *site, const char *name)
+{
+    uint32_t id = __atomic_load_n(site, __ATOMIC_ACQUIRE);
+    if (id)
+        return id;
+
+    // slow path, once per scope: find the name or register it
+    while (atomic_flag_test_and_set_explicit(&g_site_lock, memory_order_acquire))
+        ;
+    uint32_t count = atomic_load_explicit(&g_site_count, memory_order_relaxed);
+    for (uint32_t i = 1; i <= count && !id; i++)
+        if (strcmp(g_site_names[i], name) == 0)
+            id = i;
+    if (!id && count + 1 < CGSME_PROFILE_MAX_SITES)
+    {
+        char *copy = cgsme_strdup(name); // names outlive the caller (cgsme_profile_record)
+        if (copy)
+        {
+            id = count + 1;
+            g_site_names[id] = copy;
+            atomic_store_explicit(&g_site_count, id, memory_order_release);
+        }
+    }
+    atomic_flag_clear_explicit(&g_site_lock, memory_order_release);
+
+    // 0 (table full) keeps the scope unrecorded
+    __atomic_store_n(site, id, __ATOMIC_RELEASE);
+    return id;
+}
+
+void cgsme_profile_record_site(uint32_t site, uint64_t elapsed_us, uint64_t elapsed_cycles)
+{
     // Fast-path: if debug disabled, skip
-    if (!g_enabled)
+    if (!atomic_load_explicit(&g_enabled, memory_order_relaxed) || site == 0 || !g_logmtx_active)
         return;
 
     // Previously we skipped zero measurements; record everything so counts and distributions
     // include very fast functions (min_us may be 0). This makes it easier to see how time
     // is spread across all instrumented functions.
 
-    mtx_lock(&g_logmtx);
-    ProfileEntry *p = cgsme_profile_find_or_create(name);
-    if (p)
+    ProfileTable *t = tl_table ? tl_table : profileThreadTable();
+    if (!t)
+        return;
+    ProfileEntry *p = &t->entries[site];
+    p->count++;
+    p->total_us += elapsed_us;
+    if (elapsed_us < p->min_us)
+        p->min_us = elapsed_us;
+    if (elapsed_us > p->max_us)
+        p->max_us = elapsed_us;
+
+    p->total_cycles += elapsed_cycles;
+    if (elapsed_cycles < p->min_cycles)
+        p->min_cycles = elapsed_cycles;
+    if (elapsed_cycles > p->max_cycles)
+        p->max_cycles = elapsed_cycles;
+
+    // Per-invocation logging if above thresholds (rare, this one takes the log lock)
+    uint64_t us_threshold = atomic_load_explicit(&g_profile_threshold_us, memory_order_relaxed);
+    uint64_t cycles_threshold = atomic_load_explicit(&g_profile_threshold_cycles, memory_order_relaxed);
+    if ((us_threshold && elapsed_us >= us_threshold) || (cycles_threshold && elapsed_cycles >= cycles_threshold))
     {
-        p->count++;
-        p->total_us += elapsed_us;
-        if (elapsed_us < p->min_us)
-            p->min_us = elapsed_us;
-        if (elapsed_us > p->max_us)
-            p->max_us = elapsed_us;
-
-        p->total_cycles += elapsed_cycles;
-        if (elapsed_cycles < p->min_cycles)
-            p->min_cycles = elapsed_cycles;
-        if (elapsed_cycles > p->max_cycles)
-            p->max_cycles = elapsed_cycles;
-
-        // Per-invocation logging if above thresholds
-        if ((g_profile_threshold_us && elapsed_us >= g_profile_threshold_us) ||
-            (g_profile_threshold_cycles && elapsed_cycles >= g_profile_threshold_cycles))
+        mtx_lock(&g_logmtx);
+        if (g_logfile)
         {
-            if (g_logfile)
-            {
-                uint64_t ms = cgsme_now_us() / 1000ULL;
-                fprintf(g_logfile, "[cgsme %llu ms] [WARNING] %s elapsed=%llu us cycles=%llu\n", (unsigned long long)ms,
-                        name, (unsigned long long)elapsed_us, (unsigned long long)elapsed_cycles);
-                fflush(g_logfile);
-            }
+            uint64_t ms = cgsme_now_us() / 1000ULL;
+            fprintf(g_logfile, "[cgsme %llu ms] [WARNING] %s elapsed=%llu us cycles=%llu\n", (unsigned long long)ms,
+                    g_site_names[site], (unsigned long long)elapsed_us, (unsigned long long)elapsed_cycles);
+            fflush(g_logfile);
         }
+        mtx_unlock(&g_logmtx);
     }
+}
+
+void cgsme_profile_record(const char *name, uint64_t elapsed_us, uint64_t elapsed_cycles)
+{
+    if (!g_logmtx_active)
+        cgsme_init_debug();
+    if (!g_logmtx_active || !atomic_load_explicit(&g_enabled, memory_order_relaxed))
+        return;
+
+    // name lookup on every call, for one-off records (hot scopes use CGSME_PROFILE_FUNC)
+    uint32_t site = 0;
+    cgsme_profile_record_site(cgsme_profile_site(&site, name), elapsed_us, elapsed_cycles);
+}
+
+void cgsme_profile_scope_enter(void)
+{
+    if (!atomic_load_explicit(&g_trace_active, memory_order_relaxed) || !g_logmtx_active)
+        return;
+    ProfileTable *t = tl_table ? tl_table : profileThreadTable();
+    if (!t)
+        return;
+    if (!t->ring)
+        t->ring = traceRingCreate(t->tid);
+    t->depth++;
+}
+
+void cgsme_profile_scope_exit(uint32_t site, uint64_t start_us, uint64_t elapsed_us, uint64_t elapsed_cycles)
+{
+    cgsme_profile_record_site(site, elapsed_us, elapsed_cycles);
+
+    ProfileTable *t = tl_table;
+    if (!atomic_load_explicit(&g_trace_active, memory_order_relaxed) || !t || !t->depth)
+        return;
+    uint32_t depth = t->depth--;
+    TraceRing *r = t->ring;
+    // site 0: the site table is full, the scope has no name to write
+    if (!r || site == 0 || (g_trace_max_depth && depth > g_trace_max_depth))
+        return;
+
+    // sampling: the first `sample_every` events of a site on this thread, then every sample_every-th
+    uint64_t n = ++t->traced[site];
+    if (g_trace_sample_every > 1 && n > g_trace_sample_every && n % g_trace_sample_every)
+        return;
+
+    TraceEvent *e = &r->events[r->written++ % r->capacity];
+    e->site = site;
+    e->start_us = start_us;
+    e->dur_us = elapsed_us;
+}
+
+void cgsme_trace_enable(const char *path, uint32_t eventsPerThread, uint32_t maxDepth, uint32_t sampleEvery)
+{
+    if (!g_logmtx_active)
+        cgsme_init_debug();
+    if (!g_logmtx_active)
+        return;
+
+    mtx_lock(&g_logmtx);
+    free(g_trace_path);
+    g_trace_path = path ? cgsme_strdup(path) : NULL;
+    // rings that already exist keep their size
+    g_trace_capacity = eventsPerThread ? eventsPerThread : CGSME_TRACE_DEFAULT_EVENTS;
+    g_trace_max_depth = maxDepth;
+    g_trace_sample_every = sampleEvery ? sampleEvery : 1;
+    atomic_store(&g_trace_active, g_trace_path != NULL);
     mtx_unlock(&g_logmtx);
 }
 
+bool cgsme_trace_enabled(void)
+{
+    return g_logmtx_active && atomic_load_explicit(&g_trace_active, memory_order_relaxed) != 0;
+}
+
+// trace names are function names or cgsme_profile_record names, escape what JSON needs
+static void traceWriteName(FILE *f, const char *name)
+{
+    fputc('"', f);
+    for (const char *c = name; *c; c++)
+    {
+        if (*c == '"' || *c == '\\')
+            fputc('\\', f);
+        if ((unsigned char)*c >= 0x20)
+            fputc(*c, f);
+    }
+    fputc('"', f);
+}
+
+static void traceWriteRing(FILE *f, const TraceRing *r, uint64_t origin_us, bool *first)
+{
+    uint64_t kept = r->written < r->capacity ? r->written : r->capacity;
+    fprintf(f, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"cgsme thread %u%s\"}}",
+            *first ? "" : ",", r->tid, r->tid, r->written > kept ? " (oldest events dropped)" : "");
+    *first = false;
+    for (uint64_t i = r->written - kept; i < r->written; i++)
+    {
+        const TraceEvent *e = &r->events[i % r->capacity];
+        fputs(",\n{\"name\":", f);
+        traceWriteName(f, g_site_names[e->site]);
+        fprintf(f, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%llu,\"dur\":%llu}", r->tid,
+                (unsigned long long)(e->start_us - origin_us), (unsigned long long)e->dur_us);
+    }
+}
+
+static uint64_t traceRingOrigin(const TraceRing *r, uint64_t origin_us)
+{
+    uint64_t kept = r->written < r->capacity ? r->written : r->capacity;
+    for (uint64_t i = r->written - kept; i < r->written; i++)
+        if (r->events[i % r->capacity].start_us < origin_us)
+            origin_us = r->events[i % r->capacity].start_us;
+    return origin_us;
+}
+
+// Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev), timestamps relative to the first event
+static void traceWriteFile(const char *path)
+{
+    uint64_t origin_us = UINT64_MAX;
+    for (ProfileTable *t = g_tables; t; t = t->next)
+        if (t->ring)
+            origin_us = traceRingOrigin(t->ring, origin_us);
+    for (TraceRing *r = g_retired_rings; r; r = r->next)
+        origin_us = traceRingOrigin(r, origin_us);
+    if (origin_us == UINT64_MAX)
+        return; // nothing traced
+
+    FILE *f = fopen(path, "w");
+    if (!f)
+    {
+        if (g_logfile)
+            fprintf(g_logfile, "[cgsme] could not write trace file %s\n", path);
+        return;
+    }
+    bool first = true;
+    fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[", f);
+    for (ProfileTable *t = g_tables; t; t = t->next)
+        if (t->ring && t->ring->written)
+            traceWriteRing(f, t->ring, origin_us, &first);
+    for (TraceRing *r = g_retired_rings; r; r = r->next)
+        traceWriteRing(f, r, origin_us, &first);
+    fputs("\n]}\n", f);
+    fclose(f);
+    if (g_logfile)
+        fprintf(g_logfile, "[cgsme] trace written to %s\n", path);
+}
+
 void cgsme_shutdown_debug(void)
 {
     if (!g_logmtx_active)
         return;
+    // the live tables are read and cleared below without their threads' help, so nothing may be
+    // recording any more (see cgsme_debug.h). scopes that start from here on are dropped
+    atomic_store(&g_enabled, 0);
 
-    // Print profiling summary if present
+    // merge every thread's table (and the exited ones) into one row per site
     mtx_lock(&g_logmtx);
+    tableLock();
+    uint32_t sites = atomic_load(&g_site_count);
+    ProfileEntry *g_profiles = malloc(sizeof(ProfileEntry) * (sites + 1));
+    size_t g_profile_count = 0;
+    for (uint32_t i = 1; i <= sites && g_profiles; i++)
+    {
+        ProfileEntry merged;
+        profileEntryReset(&merged);
+        for (ProfileTable *t = g_tables; t; t = t->next)
+            profileEntryMerge(&merged, &t->entries[i]);
+        if (g_retired)
+            profileEntryMerge(&merged, &g_retired->entries[i]);
+        if (merged.count == 0)
+            continue;
+        merged.name = g_site_names[i];
+        g_profiles[g_profile_count++] = merged;
+    }
+
+    // Print profiling summary if present
     if (g_profile_count > 0 && g_logfile)
     {
         fprintf(g_logfile, "\n[cgsme] Profiling summary (%zu entries):\n", g_profile_count);
@@ -348,14 +703,29 @@ void cgsme_shutdown_debug(void)
         }
     }
 
-    // free names and profile storage
-    for (size_t i = 0; i < g_profile_count; ++i)
-        free(g_profiles[i].name);
+    if (g_trace_path)
+        traceWriteFile(g_trace_path);
+
+    // start over: live threads keep their (cleared) tables, site IDs stay valid
     free(g_profiles);
-    g_profiles = NULL;
-    g_profile_count = 0;
-    g_profile_capacity = 0;
+    for (ProfileTable *t = g_tables; t; t = t->next)
+    {
+        for (uint32_t i = 0; i < CGSME_PROFILE_MAX_SITES; i++)
+            profileEntryReset(&t->entries[i]);
+        memset(t->traced, 0, sizeof(t->traced));
+        if (t->ring)
+            t->ring->written = 0;
+    }
+    free(g_retired);
+    g_retired = NULL;
+    while (g_retired_rings)
+    {
+        TraceRing *next = g_retired_rings->next;
+        traceRingFree(g_retired_rings);
+        g_retired_rings = next;
+    }
 
+    tableUnlock();
     mtx_unlock(&g_logmtx);
 
     if (g_logfile && g_logfile != stdout)
@@ -377,20 +747,14 @@ void cgsme_set_enabled(bool enabled)
     if (!g_logmtx_active)
         return;
 
-    mtx_lock(&g_logmtx);
-    g_enabled = enabled ? 1 : 0;
-    mtx_unlock(&g_logmtx);
+    atomic_store_explicit(&g_enabled, enabled ? 1 : 0, memory_order_relaxed);
 }
 
 bool cgsme_get_enabled(void)
 {
     if (!g_logmtx_active)
         return false;
-    int val;
-    mtx_lock(&g_logmtx);
-    val = g_enabled;
-    mtx_unlock(&g_logmtx);
-    return val != 0;
+    return atomic_load_explicit(&g_enabled, memory_order_relaxed) != 0;
 }
 
 uint64_t cgsme_now_us(void)
@@ -432,8 +796,8 @@ void cgsme_log(const char *fmt, ...)
             return;
     }
 
-    // fast check for enabled flag (not strictly atomic but protected by mutex soon)
-    if (!g_enabled)
+    // fast check for enabled flag
+    if (!atomic_load_explicit(&g_enabled, memory_order_relaxed))
         return;
 
     mtx_lock(&g_logmtx);
@@ -29,7 +29,9 @@ extern "C"
 #ifdef cgsme_DEBUG
     // Initialize debug subsystem (creates log + mutex). Safe to call multiple times.
     CGSME_API void cgsme_init_debug(void);
-    // Shutdown debug subsystem and flush logs.
+    // Shutdown debug subsystem and flush logs. Only call it while no thread records (generation
+    // has returned, pool workers are idle or gone): it reads and clears every live thread's table.
+    // Threads may still exit afterwards.
     CGSME_API void cgsme_shutdown_debug(void);
     // Enable/Disable runtime debug logging & timing (fast-check).
     CGSME_API void cgsme_set_enabled(bool enabled);
@@ -41,9 +43,39 @@ extern "C"
     // High-resolution timestamp in CPU cycles (rdtsc) when available (0 on unsupported targets).
     CGSME_API uint64_t cgsme_now_cycles(void);
 
+// Max number of distinct profiled names (scopes + named records), extra ones are not recorded.
+#define CGSME_PROFILE_MAX_SITES 512
+
     // Profiling record: aggregate per-name stats. Records elapsed microseconds and cycles.
+    // Looks the name up on every call, hot code should use CGSME_PROFILE_FUNC.
     CGSME_API void cgsme_profile_record(const char *name, uint64_t elapsed_us, uint64_t elapsed_cycles);
 
+    // Site ID for a name, cached in *site (a static owned by the call site, 0 = not looked up yet).
+    // Returns 0 when all CGSME_PROFILE_MAX_SITES are taken.
+    CGSME_API uint32_t cgsme_profile_site(uint32_t *site, const char *name);
+
+    // Record against a site ID. Lock free: every thread aggregates into its own table,
+    // the tables are merged by cgsme_shutdown_debug.
+    CGSME_API void cgsme_profile_record_site(uint32_t site, uint64_t elapsed_us, uint64_t elapsed_cycles);
+
+    // Scope begin/end used by CGSME_PROFILE_FUNC (exit records like cgsme_profile_record_site
+    // and adds the scope to the timeline when tracing).
+    CGSME_API void cgsme_profile_scope_enter(void);
+    CGSME_API void cgsme_profile_scope_exit(uint32_t site, uint64_t start_us, uint64_t elapsed_us, uint64_t elapsed_cycles);
+
+// Default ring size of cgsme_trace_enable (events per thread).
+#define CGSME_TRACE_DEFAULT_EVENTS 65536
+
+    // Timeline mode: every thread keeps its last `eventsPerThread` scopes (0 = default) in a ring
+    // and cgsme_shutdown_debug writes them to `path` as Chrome trace-event JSON (chrome://tracing,
+    // ui.perfetto.dev). Scopes nested deeper than `maxDepth` (0 = no limit) are left out, and
+    // after the first `sampleEvery` calls of a scope on a thread only every sampleEvery-th call
+    // is traced (0/1 = all). Aggregates are not affected, tracing also runs with them off
+    // (cgsme_set_enabled(false)). NULL path turns tracing off.
+    CGSME_API void cgsme_trace_enable(const char *path, uint32_t eventsPerThread, uint32_t maxDepth, uint32_t sampleEvery);
+    // true while a trace path is set (scopes are timed for the timeline even with aggregates off)
+    CGSME_API bool cgsme_trace_enabled(void);
+
     // Configure per-invocation logging thresholds (microseconds, cycles). Set 0 to disable per-invocation logs.
     CGSME_API void cgsme_profile_set_thresholds(uint64_t us_threshold, uint64_t cycles_threshold);
 
@@ -66,35 +98,32 @@ extern "C"
 #ifdef __GNUC__
     typedef struct
     {
-        const char *name;
+        uint32_t site; // 0 = not recorded (quick mode, profiling and tracing disabled)
         uint64_t start_us;
         uint64_t start_cycles;
     } __cgsme_profile_scope_t;
     static inline void __cgsme_profile_scope_end(__cgsme_profile_scope_t *p)
     {
-        if (p && p->name)
-            cgsme_profile_record(p->name, cgsme_now_us() - p->start_us, cgsme_now_cycles() - p->start_cycles);
+        if (p && p->site)
+            cgsme_profile_scope_exit(p->site, p->start_us, cgsme_now_us() - p->start_us, cgsme_now_cycles() - p->start_cycles);
     }
-    /* In quick mode we avoid recording by clearing the name; cleanup handler checks name.
-       We still initialize the struct but only set start timestamps when quick mode is not enabled. */
-    static inline void __cgsme_profile_scope_init(__cgsme_profile_scope_t *p)
+    /* Timestamps are only taken when the scope will be recorded (not in quick mode, profiling or tracing enabled).
+       The site ID is resolved once per scope and cached in the static the macro declares. */
+    static inline void __cgsme_profile_scope_init(__cgsme_profile_scope_t *p, uint32_t *site, const char *name)
     {
-        p->name = __func__;
-        p->start_us = 0;
-        p->start_cycles = 0;
-        if (!cgsme_quick_mode_enabled())
-        {
-            p->start_us = cgsme_now_us();
-            p->start_cycles = cgsme_now_cycles();
-        }
-        else
-        {
-            p->name = NULL;
-        }
+        if (cgsme_quick_mode_enabled() || (!cgsme_get_enabled() && !cgsme_trace_enabled()))
+            return;
+        p->site = cgsme_profile_site(site, name);
+        if (!p->site)
+            return;
+        cgsme_profile_scope_enter();
+        p->start_us = cgsme_now_us();
+        p->start_cycles = cgsme_now_cycles();
     }
-#define CGSME_PROFILE_FUNC()                                                                                 \
-    __cgsme_profile_scope_t __cgsme_prof __attribute__((cleanup(__cgsme_profile_scope_end))) = {NULL, 0, 0}; \
-    __cgsme_profile_scope_init(&__cgsme_prof);
+#define CGSME_PROFILE_FUNC()                                                                              \
+    static uint32_t __cgsme_prof_site = 0;                                                                \
+    __cgsme_profile_scope_t __cgsme_prof __attribute__((cleanup(__cgsme_profile_scope_end))) = {0, 0, 0}; \
+    __cgsme_profile_scope_init(&__cgsme_prof, &__cgsme_prof_site, __func__);
 #else
 /* Fallback: in non-gcc we do a cheap runtime check to avoid timestamps in quick mode */
 #define CGSME_PROFILE_FUNC()                                                               \
@@ -116,6 +145,7 @@ static inline void cgsme_init_debug(void) {}
 static inline void cgsme_shutdown_debug(void) {}
 static inline void cgsme_set_enabled(bool enabled) { (void)enabled; }
 static inline bool cgsme_get_enabled(void) { return false; }
+static inline bool cgsme_trace_enabled(void) { return false; }
 static inline uint64_t cgsme_now_us(void) { return 0; }
 static inline uint64_t cgsme_now_cycles(void) { return 0; }
 static inline void cgsme_profile_record(const char *name, uint64_t elapsed_us, uint64_t elapsed_cycles)
@@ -124,6 +154,25 @@ static inline void cgsme_profile_record(const char *name, uint64_t elapsed_us, u
     (void)elapsed_us;
     (void)elapsed_cycles;
 }
+static inline uint32_t cgsme_profile_site(uint32_t *site, const char *name)
+{
+    (void)site;
+    (void)name;
+    return 0;
+}
+static inline void cgsme_profile_record_site(uint32_t site, uint64_t elapsed_us, uint64_t elapsed_cycles)
+{
+    (void)site;
+    (void)elapsed_us;
+    (void)elapsed_cycles;
+}
+static inline void cgsme_trace_enable(const char *path, uint32_t eventsPerThread, uint32_t maxDepth, uint32_t sampleEvery)
+{
+    (void)path;
+    (void)eventsPerThread;
+    (void)maxDepth;
+    (void)sampleEvery;
+}
 static inline void cgsme_profile_set_thresholds(uint64_t us_threshold, uint64_t cycles_threshold)
 {
     (void)us_threshold;
@@ -1,25 +1,17 @@
 #include "cgsme_noise.h"
 #include "cgsme_utils.h"
+#include "cgsme_unionfind.h"
 #include "tiles.h"
 
-// for sorting, DESCENDING order (high score / best ridge first)
-int comparePixels(const void *a, const void *b)
-{
-    float diff = ((PixelData *)b)->score - ((PixelData *)a)->score; // Note: B - A
-    if (diff < 0)
-        return -1; // B < A, so A goes first
-    if (diff > 0)
-        return 1; // B > A, so B goes first
-    return 0;
-}
+#define NOISE_HASH_MUL 0x1B873593
 
 // simple, fast deterministic random for noise (squirrel3-ish)
 static uint32_t noiseHash(uint32_t n, uint32_t seed)
 {
     n += seed;
-    n *= 0x1B873593;
+    n *= NOISE_HASH_MUL;
     n ^= (n >> 16);
-    n *= 0x1B873593;
+    n *= NOISE_HASH_MUL;
     n ^= (n >> 16);
     return n;
 }
@@ -50,164 +42,584 @@ float getValueNoise(float x, float y, uint32_t seed)
     return ix0 + sy * (ix1 - ix0);
 }
 
-// BFS to count the size of a region (non-recursive to avoid stack issues)
-int measureRegionSize(uint16_t ***grid, bool *visited, int width, int length, int startX, int startY)
+// --- ROW KERNELS ---
+// x86 kernels are compiled with per-function target attributes and picked at runtime, so the
+// library itself still builds for the baseline ISA. NEON is part of every ARMv8 target.
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define CGSME_NOISE_X86 1
+#include <immintrin.h>
+#endif
+#if defined(__ARM_NEON)
+#define CGSME_NOISE_ARM 1
+#include <arm_neon.h>
+#endif
+
+#define NOISE_INV_2_32 (1.0f / 4294967296.0f)
+
+// one pixel, the reference every kernel has to match (also used for row tails)
+static inline float ridgeAt(uint32_t x, uint32_t y, const NoiseParams *p)
+{
+    // domain warping
+    float q = getValueNoise(x * p->warpFreq, y * p->warpFreq, p->seed);
+    float r = getValueNoise(x * p->warpFreq + 5.2f, y * p->warpFreq + 1.3f, p->seed);
+
+    float wx = x + (q * p->warpAmp);
+    float wy = y + (r * p->warpAmp);
+
+    // ridged noise on warped coordinates
+    float n = getValueNoise(wx * p->baseFreq, wy * p->baseFreq, p->seed);
+
+    // The Ridge Math
+    float ridge = 1.0f - fabsf((n - 0.5f) * 2.0f);
+    return ridge * ridge; // sharpen it (makes lines thinner initially)
+}
+
+static void ridgedRowScalar(float *out, uint32_t y, uint32_t width, const NoiseParams *p)
 {
-    int count = 0;
-    int head = 0;
-    int tail = 0;
+    for (uint32_t x = 0; x < width; x++)
+        out[x] = ridgeAt(x, y, p);
+}
 
-    // allocate
-    Point2D *queue = malloc(sizeof(Point2D) * width * length);
-    if (!queue)
-        return 0; // FIX: guard against allocation failure
+#ifdef CGSME_NOISE_X86
+// coordinates are never negative, so truncation after floor is exact. the hash runs on 32 bit
+// lanes with wrapping multiplies, exactly like noiseHash
+__attribute__((target("sse4.1"))) static inline __m128i noiseHash4(__m128i n, __m128i seed)
+{
+    const __m128i mul = _mm_set1_epi32(NOISE_HASH_MUL);
+    n = _mm_mullo_epi32(_mm_add_epi32(n, seed), mul);
+    n = _mm_xor_si128(n, _mm_srli_epi32(n, 16));
+    n = _mm_mullo_epi32(n, mul);
+    return _mm_xor_si128(n, _mm_srli_epi32(n, 16));
+}
 
-    queue[tail++] = (Point2D){startX, startY};
-    visited[startY * width + startX] = true;
-    count++;
+// uint32 -> [0, 1): both 16 bit halves convert exactly, the sum rounds once like (float)uint32
+__attribute__((target("sse4.1"))) static inline __m128 hashToUnit4(__m128i h)
+{
+    __m128 hi = _mm_cvtepi32_ps(_mm_srli_epi32(h, 16));
+    __m128 lo = _mm_cvtepi32_ps(_mm_and_si128(h, _mm_set1_epi32(0xFFFF)));
+    return _mm_mul_ps(_mm_add_ps(_mm_mul_ps(hi, _mm_set1_ps(65536.0f)), lo), _mm_set1_ps(NOISE_INV_2_32));
+}
 
-    int dx[] = {0, 0, 1, -1};
-    int dy[] = {1, -1, 0, 0};
+__attribute__((target("sse4.1"))) static inline __m128 valueNoise4(__m128 x, __m128 y, __m128i seed)
+{
+    __m128 x0 = _mm_floor_ps(x);
+    __m128 y0 = _mm_floor_ps(y);
+    __m128i X = _mm_cvttps_epi32(x0);
+    __m128i Y = _mm_cvttps_epi32(y0);
+    __m128 fx = _mm_sub_ps(x, x0);
+    __m128 fy = _mm_sub_ps(y, y0);
+
+    // smoothstep
+    const __m128 three = _mm_set1_ps(3.0f), two = _mm_set1_ps(2.0f);
+    __m128 sx = _mm_mul_ps(_mm_mul_ps(fx, fx), _mm_sub_ps(three, _mm_mul_ps(two, fx)));
+    __m128 sy = _mm_mul_ps(_mm_mul_ps(fy, fy), _mm_sub_ps(three, _mm_mul_ps(two, fy)));
+
+    // the 4 corners
+    __m128i row0 = _mm_add_epi32(X, _mm_mullo_epi32(Y, _mm_set1_epi32(57)));
+    __m128i row1 = _mm_add_epi32(row0, _mm_set1_epi32(57));
+    __m128i one = _mm_set1_epi32(1);
+    __m128 n00 = hashToUnit4(noiseHash4(row0, seed));
+    __m128 n10 = hashToUnit4(noiseHash4(_mm_add_epi32(row0, one), seed));
+    __m128 n01 = hashToUnit4(noiseHash4(row1, seed));
+    __m128 n11 = hashToUnit4(noiseHash4(_mm_add_epi32(row1, one), seed));
 
-    while (head < tail)
+    // bilinear interpolation
+    __m128 ix0 = _mm_add_ps(n00, _mm_mul_ps(sx, _mm_sub_ps(n10, n00)));
+    __m128 ix1 = _mm_add_ps(n01, _mm_mul_ps(sx, _mm_sub_ps(n11, n01)));
+    return _mm_add_ps(ix0, _mm_mul_ps(sy, _mm_sub_ps(ix1, ix0)));
+}
+
+__attribute__((target("sse4.1"))) static void ridgedRowSse41(float *out, uint32_t y, uint32_t width, const NoiseParams *p)
+{
+    const __m128i seed = _mm_set1_epi32((int32_t)p->seed);
+    const __m128 warpFreq = _mm_set1_ps(p->warpFreq);
+    const __m128 warpAmp = _mm_set1_ps(p->warpAmp);
+    const __m128 baseFreq = _mm_set1_ps(p->baseFreq);
+    const __m128 half = _mm_set1_ps(0.5f), two = _mm_set1_ps(2.0f), one = _mm_set1_ps(1.0f);
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    const __m128 fy = _mm_set1_ps((float)y);
+    const __m128 qy = _mm_mul_ps(fy, warpFreq);
+    const __m128 ry = _mm_add_ps(qy, _mm_set1_ps(1.3f));
+    const __m128i lanes = _mm_setr_epi32(0, 1, 2, 3);
+
+    uint32_t x = 0;
+    for (; x + 4 <= width; x += 4)
     {
-        Point2D c = queue[head++];
+        __m128 fx = _mm_cvtepi32_ps(_mm_add_epi32(_mm_set1_epi32((int32_t)x), lanes));
+        __m128 qx = _mm_mul_ps(fx, warpFreq);
+        __m128 q = valueNoise4(qx, qy, seed);
+        __m128 r = valueNoise4(_mm_add_ps(qx, _mm_set1_ps(5.2f)), ry, seed);
 
-        for (int i = 0; i < 4; i++)
-        {
-            int nx = c.x + dx[i];
-            int ny = c.y + dy[i];
+        __m128 wx = _mm_add_ps(fx, _mm_mul_ps(q, warpAmp));
+        __m128 wy = _mm_add_ps(fy, _mm_mul_ps(r, warpAmp));
+        __m128 n = valueNoise4(_mm_mul_ps(wx, baseFreq), _mm_mul_ps(wy, baseFreq), seed);
 
-            if (nx < 0 || ny < 0 || nx >= width || ny >= length)
-                continue;
+        __m128 ridge = _mm_sub_ps(one, _mm_and_ps(_mm_mul_ps(_mm_sub_ps(n, half), two), absMask));
+        _mm_storeu_ps(&out[x], _mm_mul_ps(ridge, ridge));
+    }
+    for (; x < width; x++)
+        out[x] = ridgeAt(x, y, p);
+}
 
-            // if it is VALID land (All_Possible) and NOT visited yet
-            if (grid[0][ny][nx] != Empty_Tile && !visited[ny * width + nx])
-            {
-                visited[ny * width + nx] = true;
-                queue[tail++] = (Point2D){nx, ny};
-                count++;
-            }
-        }
+__attribute__((target("avx2"))) static inline __m256i noiseHash8(__m256i n, __m256i seed)
+{
+    const __m256i mul = _mm256_set1_epi32(NOISE_HASH_MUL);
+    n = _mm256_mullo_epi32(_mm256_add_epi32(n, seed), mul);
+    n = _mm256_xor_si256(n, _mm256_srli_epi32(n, 16));
+    n = _mm256_mullo_epi32(n, mul);
+    return _mm256_xor_si256(n, _mm256_srli_epi32(n, 16));
+}
+
+__attribute__((target("avx2"))) static inline __m256 hashToUnit8(__m256i h)
+{
+    __m256 hi = _mm256_cvtepi32_ps(_mm256_srli_epi32(h, 16));
+    __m256 lo = _mm256_cvtepi32_ps(_mm256_and_si256(h, _mm256_set1_epi32(0xFFFF)));
+    return _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(hi, _mm256_set1_ps(65536.0f)), lo), _mm256_set1_ps(NOISE_INV_2_32));
+}
+
+__attribute__((target("avx2"))) static inline __m256 valueNoise8(__m256 x, __m256 y, __m256i seed)
+{
+    __m256 x0 = _mm256_floor_ps(x);
+    __m256 y0 = _mm256_floor_ps(y);
+    __m256i X = _mm256_cvttps_epi32(x0);
+    __m256i Y = _mm256_cvttps_epi32(y0);
+    __m256 fx = _mm256_sub_ps(x, x0);
+    __m256 fy = _mm256_sub_ps(y, y0);
+
+    // smoothstep
+    const __m256 three = _mm256_set1_ps(3.0f), two = _mm256_set1_ps(2.0f);
+    __m256 sx = _mm256_mul_ps(_mm256_mul_ps(fx, fx), _mm256_sub_ps(three, _mm256_mul_ps(two, fx)));
+    __m256 sy = _mm256_mul_ps(_mm256_mul_ps(fy, fy), _mm256_sub_ps(three, _mm256_mul_ps(two, fy)));
+
+    // the 4 corners
+    __m256i row0 = _mm256_add_epi32(X, _mm256_mullo_epi32(Y, _mm256_set1_epi32(57)));
+    __m256i row1 = _mm256_add_epi32(row0, _mm256_set1_epi32(57));
+    __m256i one = _mm256_set1_epi32(1);
+    __m256 n00 = hashToUnit8(noiseHash8(row0, seed));
+    __m256 n10 = hashToUnit8(noiseHash8(_mm256_add_epi32(row0, one), seed));
+    __m256 n01 = hashToUnit8(noiseHash8(row1, seed));
+    __m256 n11 = hashToUnit8(noiseHash8(_mm256_add_epi32(row1, one), seed));
+
+    // bilinear interpolation
+    __m256 ix0 = _mm256_add_ps(n00, _mm256_mul_ps(sx, _mm256_sub_ps(n10, n00)));
+    __m256 ix1 = _mm256_add_ps(n01, _mm256_mul_ps(sx, _mm256_sub_ps(n11, n01)));
+    return _mm256_add_ps(ix0, _mm256_mul_ps(sy, _mm256_sub_ps(ix1, ix0)));
+}
+
+__attribute__((target("avx2"))) static void ridgedRowAvx2(float *out, uint32_t y, uint32_t width, const NoiseParams *p)
+{
+    const __m256i seed = _mm256_set1_epi32((int32_t)p->seed);
+    const __m256 warpFreq = _mm256_set1_ps(p->warpFreq);
+    const __m256 warpAmp = _mm256_set1_ps(p->warpAmp);
+    const __m256 baseFreq = _mm256_set1_ps(p->baseFreq);
+    const __m256 half = _mm256_set1_ps(0.5f), two = _mm256_set1_ps(2.0f), one = _mm256_set1_ps(1.0f);
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    const __m256 fy = _mm256_set1_ps((float)y);
+    const __m256 qy = _mm256_mul_ps(fy, warpFreq);
+    const __m256 ry = _mm256_add_ps(qy, _mm256_set1_ps(1.3f));
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    uint32_t x = 0;
+    for (; x + 8 <= width; x += 8)
+    {
+        __m256 fx = _mm256_cvtepi32_ps(_mm256_add_epi32(_mm256_set1_epi32((int32_t)x), lanes));
+        __m256 qx = _mm256_mul_ps(fx, warpFreq);
+        __m256 q = valueNoise8(qx, qy, seed);
+        __m256 r = valueNoise8(_mm256_add_ps(qx, _mm256_set1_ps(5.2f)), ry, seed);
+
+        __m256 wx = _mm256_add_ps(fx, _mm256_mul_ps(q, warpAmp));
+        __m256 wy = _mm256_add_ps(fy, _mm256_mul_ps(r, warpAmp));
+        __m256 n = valueNoise8(_mm256_mul_ps(wx, baseFreq), _mm256_mul_ps(wy, baseFreq), seed);
+
+        __m256 ridge = _mm256_sub_ps(one, _mm256_and_ps(_mm256_mul_ps(_mm256_sub_ps(n, half), two), absMask));
+        _mm256_storeu_ps(&out[x], _mm256_mul_ps(ridge, ridge));
     }
+    for (; x < width; x++)
+        out[x] = ridgeAt(x, y, p);
+}
+#endif // CGSME_NOISE_X86
 
-    free(queue);
-    return count;
+#ifdef CGSME_NOISE_ARM
+static inline uint32x4_t noiseHashNeon(uint32x4_t n, uint32x4_t seed)
+{
+    const uint32x4_t mul = vdupq_n_u32(NOISE_HASH_MUL);
+    n = vmulq_u32(vaddq_u32(n, seed), mul);
+    n = veorq_u32(n, vshrq_n_u32(n, 16));
+    n = vmulq_u32(n, mul);
+    return veorq_u32(n, vshrq_n_u32(n, 16));
 }
 
-// BFS to mark the main area adn delete everythign else
-void keepOnlyLargestMask(uint16_t ***grid, int width, int length, int height, int startX, int startY)
+static inline float32x4_t valueNoiseNeon(float32x4_t x, float32x4_t y, uint32x4_t seed)
 {
-    bool *isMain = calloc(width * length, sizeof(bool));
-    if (!isMain)
-        return; // FIX: guard allocation
+    // coordinates are never negative: truncation is floor (ARMv7 has no vector floor)
+    uint32x4_t X = vcvtq_u32_f32(x);
+    uint32x4_t Y = vcvtq_u32_f32(y);
+    float32x4_t fx = vsubq_f32(x, vcvtq_f32_u32(X));
+    float32x4_t fy = vsubq_f32(y, vcvtq_f32_u32(Y));
+
+    // smoothstep
+    const float32x4_t three = vdupq_n_f32(3.0f), two = vdupq_n_f32(2.0f);
+    float32x4_t sx = vmulq_f32(vmulq_f32(fx, fx), vsubq_f32(three, vmulq_f32(two, fx)));
+    float32x4_t sy = vmulq_f32(vmulq_f32(fy, fy), vsubq_f32(three, vmulq_f32(two, fy)));
+
+    // the 4 corners
+    uint32x4_t row0 = vaddq_u32(X, vmulq_n_u32(Y, 57));
+    uint32x4_t row1 = vaddq_u32(row0, vdupq_n_u32(57));
+    uint32x4_t one = vdupq_n_u32(1);
+    float32x4_t scale = vdupq_n_f32(NOISE_INV_2_32);
+    float32x4_t n00 = vmulq_f32(vcvtq_f32_u32(noiseHashNeon(row0, seed)), scale);
+    float32x4_t n10 = vmulq_f32(vcvtq_f32_u32(noiseHashNeon(vaddq_u32(row0, one), seed)), scale);
+    float32x4_t n01 = vmulq_f32(vcvtq_f32_u32(noiseHashNeon(row1, seed)), scale);
+    float32x4_t n11 = vmulq_f32(vcvtq_f32_u32(noiseHashNeon(vaddq_u32(row1, one), seed)), scale);
+
+    // bilinear interpolation
+    float32x4_t ix0 = vaddq_f32(n00, vmulq_f32(sx, vsubq_f32(n10, n00)));
+    float32x4_t ix1 = vaddq_f32(n01, vmulq_f32(sx, vsubq_f32(n11, n01)));
+    return vaddq_f32(ix0, vmulq_f32(sy, vsubq_f32(ix1, ix0)));
+}
+
+static void ridgedRowNeon(float *out, uint32_t y, uint32_t width, const NoiseParams *p)
+{
+    const uint32x4_t seed = vdupq_n_u32(p->seed);
+    const float32x4_t warpFreq = vdupq_n_f32(p->warpFreq);
+    const float32x4_t warpAmp = vdupq_n_f32(p->warpAmp);
+    const float32x4_t baseFreq = vdupq_n_f32(p->baseFreq);
+    const float32x4_t half = vdupq_n_f32(0.5f), two = vdupq_n_f32(2.0f), one = vdupq_n_f32(1.0f);
+    const float32x4_t fy = vdupq_n_f32((float)y);
+    const float32x4_t qy = vmulq_f32(fy, warpFreq);
+    const float32x4_t ry = vaddq_f32(qy, vdupq_n_f32(1.3f));
+    const uint32_t laneInit[4] = {0, 1, 2, 3};
+    const uint32x4_t lanes = vld1q_u32(laneInit);
+
+    uint32_t x = 0;
+    for (; x + 4 <= width; x += 4)
+    {
+        float32x4_t fx = vcvtq_f32_u32(vaddq_u32(vdupq_n_u32(x), lanes));
+        float32x4_t qx = vmulq_f32(fx, warpFreq);
+        float32x4_t q = valueNoiseNeon(qx, qy, seed);
+        float32x4_t r = valueNoiseNeon(vaddq_f32(qx, vdupq_n_f32(5.2f)), ry, seed);
+
+        float32x4_t wx = vaddq_f32(fx, vmulq_f32(q, warpAmp));
+        float32x4_t wy = vaddq_f32(fy, vmulq_f32(r, warpAmp));
+        float32x4_t n = valueNoiseNeon(vmulq_f32(wx, baseFreq), vmulq_f32(wy, baseFreq), seed);
 
-    Point2D *queue = malloc(sizeof(Point2D) * width * length);
-    if (!queue)
+        float32x4_t ridge = vsubq_f32(one, vabsq_f32(vmulq_f32(vsubq_f32(n, half), two)));
+        vst1q_f32(&out[x], vmulq_f32(ridge, ridge));
+    }
+    for (; x < width; x++)
+        out[x] = ridgeAt(x, y, p);
+}
+#endif // CGSME_NOISE_ARM
+
+bool noiseIsaSupported(CgsmeNoiseIsa isa)
+{
+    switch (isa)
     {
-        free(isMain);
+    case CGSME_NOISE_SCALAR:
+        return true;
+#ifdef CGSME_NOISE_X86
+    case CGSME_NOISE_SSE41:
+        return __builtin_cpu_supports("sse4.1");
+    case CGSME_NOISE_AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+#ifdef CGSME_NOISE_ARM
+    case CGSME_NOISE_NEON:
+        return true;
+#endif
+    default:
+        return false;
+    }
+}
+
+CgsmeNoiseIsa noiseBestIsa(void)
+{
+    if (noiseIsaSupported(CGSME_NOISE_AVX2))
+        return CGSME_NOISE_AVX2;
+    if (noiseIsaSupported(CGSME_NOISE_SSE41))
+        return CGSME_NOISE_SSE41;
+    if (noiseIsaSupported(CGSME_NOISE_NEON))
+        return CGSME_NOISE_NEON;
+    return CGSME_NOISE_SCALAR;
+}
+
+const char *noiseIsaName(CgsmeNoiseIsa isa)
+{
+    static const char *names[CGSME_NOISE_ISA_COUNT] = {"scalar", "sse4.1", "avx2", "neon"};
+    return (unsigned)isa < CGSME_NOISE_ISA_COUNT ? names[isa] : "unknown";
+}
+
+void ridgedNoiseRow(float *out, uint32_t y, uint32_t width, const NoiseParams *params, CgsmeNoiseIsa isa)
+{
+    switch (isa)
+    {
+#ifdef CGSME_NOISE_X86
+    case CGSME_NOISE_AVX2:
+        ridgedRowAvx2(out, y, width, params);
         return;
-    } // FIX: guard allocation
+    case CGSME_NOISE_SSE41:
+        ridgedRowSse41(out, y, width, params);
+        return;
+#endif
+#ifdef CGSME_NOISE_ARM
+    case CGSME_NOISE_NEON:
+        ridgedRowNeon(out, y, width, params);
+        return;
+#endif
+    default:
+        ridgedRowScalar(out, y, width, params);
+        return;
+    }
+}
+
+bool selectTopScores(const float *scores, uint32_t count, uint32_t k, CgsmeArena *arena, uint32_t *cutoff, uint32_t *ties)
+{
+    CGSME_PROFILE_FUNC();
+    *cutoff = UINT32_MAX;
+    *ties = 0;
+    if (k > count)
+        k = count;
+    if (k == 0)
+        return true;
+
+    ArenaMark mark = arenaGetMark(arena);
+    uint32_t *hist = arenaCalloc(arena, 65536, sizeof(uint32_t));
+    if (!hist)
+        return false;
+
+    // PASS 1: bucket of the cutoff by the high 16 bits, walking down from the best scores
+    for (uint32_t i = 0; i < count; i++)
+        hist[scoreKey(scores[i]) >> 16]++;
+
+    uint32_t remaining = k;
+    uint32_t high = 65535;
+    while (hist[high] < remaining)
+        remaining -= hist[high--];
+
+    // PASS 2: exact key inside that bucket by the low 16 bits
+    memset(hist, 0, sizeof(uint32_t) * 65536);
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t key = scoreKey(scores[i]);
+        if ((key >> 16) == high)
+            hist[key & 0xFFFF]++;
+    }
 
-    int head = 0, tail = 0;
+    uint32_t low = 65535;
+    while (hist[low] < remaining)
+        remaining -= hist[low--];
 
-    queue[tail++] = (Point2D){startX, startY};
-    isMain[startY * width + startX] = true;
+    *cutoff = (high << 16) | low;
+    *ties = remaining;
+    arenaRelease(arena, mark);
+    return true;
+}
 
-    int dx[] = {0, 0, 1, -1};
-    int dy[] = {1, -1, 0, 0};
+// two-pass connected component labeling (4-connected) of layer 0, then everything outside the
+// largest component is deleted on every layer
+int removeMaskIslands(uint16_t ***grid, int width, int length, int height, CgsmeArena *arena)
+{
+    CGSME_PROFILE_FUNC();
+    ArenaMark mark = arenaGetMark(arena);
+    size_t cells = (size_t)width * length;
+    // a 4-connected raster scan opens at most one label per two cells (checkerboard)
+    uint32_t maxLabels = (uint32_t)(cells / 2 + 2);
+    uint32_t *labels = arenaAlloc(arena, sizeof(uint32_t) * cells);
+    uint32_t *pixels = arenaCalloc(arena, maxLabels, sizeof(uint32_t));
+    UnionFind *uf = createUnionFind(maxLabels, 1, arena); // label 0 = void
+    if (!labels || !pixels || !uf)
+    {
+        arenaRelease(arena, mark);
+        return -1;
+    } // FIX: guard allocation
 
-    while (head < tail)
+    // PASS 1: provisional labels from the west and north neighbours, equivalences merged
+    // in the union-find (0 = void)
+    for (int y = 0; y < length; y++)
     {
-        Point2D c = queue[head++];
-        for (int i = 0; i < 4; i++)
+        const uint16_t *cells = grid[0][y];
+        uint32_t *row = &labels[(size_t)y * width];
+        const uint32_t *above = y > 0 ? row - width : NULL;
+        uint32_t west = 0;
+        for (int x = 0; x < width; x++)
         {
-            int nx = c.x + dx[i];
-            int ny = c.y + dy[i];
-            if (nx < 0 || ny < 0 || nx >= width || ny >= length)
+            if (cells[x] == Empty_Tile)
+            {
+                row[x] = west = 0;
                 continue;
+            }
 
-            if (grid[0][ny][nx] != Empty_Tile && !isMain[ny * width + nx])
+            uint32_t north = above ? above[x] : 0;
+            uint32_t label;
+            if (west && north && west != north)
             {
-                isMain[ny * width + nx] = true;
-                queue[tail++] = (Point2D){nx, ny};
+                uint32_t a = findSet(uf, west);
+                uint32_t b = findSet(uf, north);
+                label = a == b ? a : unionRoots(uf, a, b);
             }
+            else if (west | north)
+                label = west ? west : north;
+            else
+                label = makeSet(uf);
+            row[x] = west = label;
+            pixels[label]++;
         }
     }
 
-    // DELETE loop, if not Main, set to Empty
+    // dense component IDs in the order of each component's smallest label, i.e. its first
+    // cell in raster order, so on equal sizes the first component found wins like before
+    uint32_t *component = arenaAlloc(arena, sizeof(uint32_t) * uf->count);
+    if (!component)
+    {
+        arenaRelease(arena, mark);
+        return -1;
+    }
+    uint32_t components = compactSets(uf, component);
+    uint32_t *size = arenaCalloc(arena, (size_t)components + 1, sizeof(uint32_t));
+    if (!size)
+    {
+        arenaRelease(arena, mark);
+        return -1;
+    }
+    for (uint32_t l = 1; l < uf->count; l++)
+        size[component[l]] += pixels[l];
+
+    uint32_t best = 0;
+    for (uint32_t c = 1; c <= components; c++)
+        if (c != component[0] && (best == 0 || size[c] > size[best]))
+            best = c;
+
+    // PASS 2: DELETE everything that is not the main component
     for (int y = 0; y < length; y++)
     {
+        const uint32_t *row = &labels[(size_t)y * width];
         for (int x = 0; x < width; x++)
         {
-            if (grid[0][y][x] != Empty_Tile && !isMain[y * width + x])
+            if (row[x] && component[row[x]] != best)
             {
                 for (int z = 0; z < height; z++)
                     grid[z][y][x] = Empty_Tile;
             }
         }
     }
-    free(isMain);
-    free(queue);
+
+    int kept = best ? (int)size[best] : 0;
+    arenaRelease(arena, mark);
+    return kept;
 }
 
-// grow the edges of the mask by 1 pixel (dilation)
-int dilateMask(uint16_t ***grid, int width, int length, int height, int maxToAdd)
+// grow the mask ring by ring (ring r = void cells at manhattan distance r from the mask),
+// same cells as r one pixel dilations: the distance through the void is the plain manhattan
+// distance because land never blocks the growth. only layer 0 is written.
+int dilateMaskRings(uint16_t ***grid, int width, int length, int fullRings, int maxRings, int needed, CgsmeArena *arena)
 {
-    int added = 0;
-    bool *toAdd = calloc(width * length, sizeof(bool));
-    if (!toAdd)
-        return 0; // FIX: guard allocation
+    if (maxRings < fullRings)
+        maxRings = fullRings;
+    if (maxRings > MASK_RING_LIMIT)
+        maxRings = MASK_RING_LIMIT;
+
+    ArenaMark mark = arenaGetMark(arena);
+    uint16_t *dist = arenaAlloc(arena, sizeof(uint16_t) * (size_t)width * length);
+    uint32_t *ringSize = arenaCalloc(arena, (size_t)maxRings + 1, sizeof(uint32_t));
+    if (!dist || !ringSize)
+    {
+        arenaRelease(arena, mark);
+        return 0;
+    }
 
-    // scan the whole map to find all valid growth spots
+    // CHAMFER (L1 distance transform): forward pass from north/west, backward from south/east
+    // distances saturate at MASK_RING_FAR, every ring past maxRings is never grown anyway
     for (int y = 0; y < length; y++)
     {
+        const uint16_t *cells = grid[0][y];
+        uint16_t *row = &dist[(size_t)y * width];
+        const uint16_t *above = y > 0 ? row - width : NULL;
+        uint32_t west = MASK_RING_FAR;
         for (int x = 0; x < width; x++)
         {
-            if (grid[0][y][x] == Empty_Tile) // potential spot to grow
+            uint32_t d = 0;
+            if (cells[x] == Empty_Tile)
             {
-                // if any neighbor is VALID, grow here
-                if ((x > 0 && grid[0][y][x - 1] != Empty_Tile) ||
-                    (x < width - 1 && grid[0][y][x + 1] != Empty_Tile) ||
-                    (y > 0 && grid[0][y - 1][x] != Empty_Tile) ||
-                    (y < length - 1 && grid[0][y + 1][x] != Empty_Tile))
-                {
-                    toAdd[y * width + x] = true;
-                }
+                uint32_t north = above ? above[x] : MASK_RING_FAR;
+                d = (west < north ? west : north) + 1;
+                if (d > MASK_RING_FAR)
+                    d = MASK_RING_FAR;
             }
+            row[x] = (uint16_t)(west = d);
+        }
+    }
+    for (int y = length - 1; y >= 0; y--)
+    {
+        uint16_t *row = &dist[(size_t)y * width];
+        const uint16_t *below = y < length - 1 ? row + width : NULL;
+        uint32_t east = MASK_RING_FAR;
+        for (int x = width - 1; x >= 0; x--)
+        {
+            uint32_t d = row[x];
+            uint32_t south = below ? below[x] : MASK_RING_FAR;
+            uint32_t step = (east < south ? east : south) + 1;
+            if (step < d)
+                d = step;
+            row[x] = (uint16_t)(east = d);
+            if (d >= 1 && d <= (uint32_t)maxRings)
+                ringSize[d]++;
         }
     }
 
-    for (int y = 0; y < length; y++)
+    // THRESHOLD: the first fullRings rings always, then whole rings while the budget allows,
+    // the ring that crosses the target is cut after its first `budget` cells in raster order
+    int added = 0;
+    int lastRing = 0;
+    uint32_t partial = 0;
+    for (int r = 1; r <= maxRings && ringSize[r] > 0; r++)
     {
+        int budget = needed - added;
+        if (r <= fullRings || (int)ringSize[r] <= budget)
+        {
+            added += (int)ringSize[r];
+            lastRing = r;
+            continue;
+        }
+        if (budget > 0)
+        {
+            added += budget;
+            lastRing = r;
+            partial = (uint32_t)budget;
+        }
+        break;
+    }
+
+    // one write per grown cell
+    uint32_t fullLimit = partial ? (uint32_t)lastRing - 1 : (uint32_t)lastRing;
+    for (int y = 0; y < length && lastRing > 0; y++)
+    {
+        uint16_t *cells = grid[0][y];
+        const uint16_t *row = &dist[(size_t)y * width];
         for (int x = 0; x < width; x++)
         {
-            if (toAdd[y * width + x])
+            uint32_t d = row[x];
+            if (d == 0 || d > (uint32_t)lastRing)
+                continue;
+            if (d <= fullLimit)
+                cells[x] = All_Possible_State;
+            else if (partial > 0)
             {
-                if (added >= maxToAdd)
-                {
-                    goto done;
-                } // FIXED: >= ensures strict limit
-
-                for (int z = 0; z < height; z++)
-                    grid[z][y][x] = All_Possible_State;
-                added++;
+                cells[x] = All_Possible_State;
+                partial--;
             }
         }
     }
 
-done:
-    free(toAdd);
+    arenaRelease(arena, mark);
     return added;
 }
 
 // RIDGED NOISE MASK GENERATION
-void generateRidgedMask(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t height, uint32_t targetFullness, uint32_t seed)
+void generateRidgedMask(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t height, uint32_t targetFullness, uint32_t seed, CgsmeArena *arena)
 {
     CGSME_PROFILE_FUNC();
-    printf("Generating Ridged Noise Mask (Fullness: %u%%)...\n", targetFullness);
-    printf("  - Target filled pixels: ~%u\n", (uint32_t)((uint64_t)width * (uint64_t)length * (uint64_t)targetFullness / 100));
-    printf("  - Grid Size: %ux%u\n", width, length);
+    cgsme_log("Generating Ridged Noise Mask (Fullness: %u%%, Target filled pixels: ~%u, Grid Size: %ux%u)\n",
+              targetFullness, (uint32_t)((uint64_t)width * (uint64_t)length * (uint64_t)targetFullness / 100), width, length);
 
     uint32_t totalPixels = width * length;
     uint32_t targetCount = (uint32_t)((uint64_t)totalPixels * (uint64_t)targetFullness / 100);
@@ -218,14 +630,11 @@ void generateRidgedMask(uint16_t ***grid, uint32_t width, uint32_t length, uint3
     if (targetCount > totalPixels)
         targetCount = totalPixels;
 
-    PixelData *pixels = malloc(sizeof(PixelData) * totalPixels);
-    if (!pixels)
+    ArenaMark mark = arenaGetMark(arena);
+    float *scores = arenaAlloc(arena, sizeof(float) * totalPixels);
+    if (!scores)
         return; // FIX: guard allocation
 
-#ifdef cgsme_DEBUG
-    float *debugMap = malloc(sizeof(float) * totalPixels);
-#endif
-
     // FREQUENCY
     // more = more branches // TODO: TUNE
     float baseFreq = 12.0f / (float)(width + length);
@@ -235,118 +644,60 @@ void generateRidgedMask(uint16_t ***grid, uint32_t width, uint32_t length, uint3
     float warpFreq = baseFreq * 0.5f; // warp is usually lower freq than the main noise
     float warpAmp = 4.0f;             // distort coordinates by 4 tiles
 
-    int pIdx = 0;
+    // domain warped ridges, a whole row per call (vectorized where the CPU allows)
+    NoiseParams params = {warpFreq, warpAmp, baseFreq, seed};
+    CgsmeNoiseIsa isa = noiseBestIsa();
     for (uint32_t y = 0; y < length; y++)
-    {
-        for (uint32_t x = 0; x < width; x++)
-        {
-            // domain warping
-            float q = getValueNoise(x * warpFreq, y * warpFreq, seed);
-            float r = getValueNoise(x * warpFreq + 5.2f, y * warpFreq + 1.3f, seed);
-
-            float wx = x + (q * warpAmp);
-            float wy = y + (r * warpAmp);
-
-            // ridged noise on warped coordinates
-            float n = getValueNoise(wx * baseFreq, wy * baseFreq, seed);
-
-            // The Ridge Math
-            float ridge = 1.0f - fabsf((n - 0.5f) * 2.0f);
-            ridge = ridge * ridge; // sharpen it (makes lines thinner initially)
-
-            pixels[pIdx].x = x;
-            pixels[pIdx].y = y;
-            pixels[pIdx].score = ridge;
-
-#ifdef cgsme_DEBUG
-            debugMap[y * width + x] = ridge;
-#endif
-
-            pIdx++;
-        }
-    }
+        ridgedNoiseRow(&scores[(size_t)y * width], y, width, &params, isa);
 
 #ifdef cgsme_DEBUG
-    saveNoiseDebug(debugMap, width, length);
-    free(debugMap);
+    // quick (benchmark) mode skips the disk dumps, they cost more than the generation itself
+    if (!cgsme_quick_mode_enabled())
+        saveNoiseDebug(scores, width, length);
 #endif
 
-    // SORT DESCENDING (Best Ridges First)
-    qsort(pixels, totalPixels, sizeof(PixelData), comparePixels);
-
-    // Reset Layer 0
-    int currentFilled = 0;
-    for (int y = 0; y < length; y++)
-        for (int x = 0; x < width; x++)
-            grid[0][y][x] = Empty_Tile;
-
-    // Fill best pixels on Layer 0
-    for (uint32_t i = 0; i < targetCount; i++)
+    // PERCENTILE THRESHOLD (Best Ridges First)
+    // exact cutoff of the top targetCount scores, ties at the cutoff go to the lowest index
+    uint32_t cutoff, ties;
+    if (!selectTopScores(scores, totalPixels, targetCount, arena, &cutoff, &ties))
     {
-        uint16_t px = pixels[i].x;
-        uint16_t py = pixels[i].y;
-        grid[0][py][px] = All_Possible_State;
-        currentFilled++;
+        arenaRelease(arena, mark);
+        return;
     }
 
-    free(pixels);
-
-    // --- SANITIZE (Delete Islands) ---
-    bool *visited = calloc(width * length, sizeof(bool));
-    if (visited)
+    // Fill best pixels on Layer 0, everything else is Empty
+    int currentFilled = 0;
+    for (uint32_t y = 0; y < length; y++)
     {
-        int maxRegionSize = 0;
-        int bestX = -1, bestY = -1;
-
-        for (int y = 0; y < length; y++)
+        for (uint32_t x = 0; x < width; x++)
         {
-            for (int x = 0; x < width; x++)
+            uint32_t key = scoreKey(scores[(size_t)y * width + x]);
+            bool selected = key > cutoff;
+            if (key == cutoff && ties > 0)
             {
-                if (grid[0][y][x] != Empty_Tile && !visited[y * width + x])
-                {
-                    int size = measureRegionSize(grid, visited, width, length, x, y);
-                    if (size > maxRegionSize)
-                    {
-                        maxRegionSize = size;
-                        bestX = x;
-                        bestY = y;
-                    }
-                }
+                selected = true;
+                ties--;
             }
-        }
-        free(visited);
-
-        if (bestX != -1)
-        {
-            keepOnlyLargestMask(grid, width, length, height, bestX, bestY);
-            // Re-count after pruning (FIX: don't use freed 'visited', simply scan)
-            currentFilled = 0;
-            for (int y = 0; y < length; y++)
-                for (int x = 0; x < width; x++)
-                    if (grid[0][y][x] != Empty_Tile)
-                        currentFilled++;
+            grid[0][y][x] = selected ? All_Possible_State : Empty_Tile;
+            currentFilled += selected;
         }
     }
 
-    // SAFETY PASS (force minimum thickness)
-    // ALWAYS dilate at least once. this turns 1-pixel lines into 3-pixel lines
-    // this solves the 2x200 crash
+    arenaRelease(arena, mark);
 
-    int added = dilateMask(grid, width, length, height, 1000000); // Unlimited dilation TODO: CLEANER APROACH: add a bool argument to ignore th eneeded amount
-    currentFilled += added;
+    // --- SANITIZE (Delete Islands) ---
+    // layer 0 only, the broadcast below writes the other layers once
+    int kept = removeMaskIslands(grid, width, length, 1, arena);
+    if (kept >= 0)
+        currentFilled = kept;
 
-    // RESCUE (dilate back to target)
-    int safety = 0;
-    while (currentFilled < targetCount && safety < 1000)
-    {
-        // calulate remaining
-        int needed = targetCount - currentFilled;
-        int added = dilateMask(grid, width, length, height, needed);
-        if (added == 0)
-            break;
-        currentFilled += added;
-        safety++;
-    }
+    arenaRelease(arena, mark);
+
+    // SAFETY PASS (force minimum thickness) + RESCUE (dilate back to target)
+    // the first ring is ALWAYS grown, this turns 1-pixel lines into 3-pixel lines
+    // (this solves the 2x200 crash). further rings only until the target is met.
+    int needed = (int)targetCount - currentFilled;
+    currentFilled += dilateMaskRings(grid, width, length, 1, MASK_RESCUE_RINGS, needed, arena);
 
     // apply Layer 0 to All layers
     for (int z = 1; z < height; z++)
@@ -362,7 +713,8 @@ void generateRidgedMask(uint16_t ***grid, uint32_t width, uint32_t length, uint3
 
 // DEBUG DUMP
 #ifdef cgsme_DEBUG
-    saveBinaryMaskDebug(grid, width, length);
+    if (!cgsme_quick_mode_enabled())
+        saveBinaryMaskDebug(grid, width, length);
 #endif
 }
 
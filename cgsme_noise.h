@@ -5,19 +5,38 @@
 #include <stdbool.h>
 #include <stdlib.h>
 #include <math.h>
+#include <string.h>
+#include "cgsme_utils.h"
 
+// ridged noise parameters of one mask (see generateRidgedMask)
 typedef struct
 {
-	uint16_t x;
-	uint16_t y;
-	float score; // ridged noise value
-} PixelData;
+	float warpFreq; // domain warp frequency
+	float warpAmp;  // domain warp distance in tiles
+	float baseFreq; // ridge frequency
+	uint32_t seed;
+} NoiseParams;
 
-/// @brief Compare two PixelData for qsort (descending by score).
-/// @param a First pixel.
-/// @param b Second pixel.
-/// @return Comparison result for qsort.
-int comparePixels(const void *a, const void *b);
+// row kernels. every kernel runs the scalar float operations in the same order without fused
+// multiply-add, so on x86 (SSE4.1 / AVX2) the scores match the scalar path bit for bit. where
+// the compiler may contract the scalar code (e.g. ARM builds with -ffp-contract=fast) they
+// differ by at most CGSME_NOISE_SIMD_EPSILON.
+typedef enum
+{
+	CGSME_NOISE_SCALAR = 0,
+	CGSME_NOISE_SSE41,
+	CGSME_NOISE_AVX2,
+	CGSME_NOISE_NEON,
+	CGSME_NOISE_ISA_COUNT
+} CgsmeNoiseIsa;
+
+#define CGSME_NOISE_SIMD_EPSILON 1e-5f
+
+// dilation rings: distances saturate at MASK_RING_FAR, so at most MASK_RING_LIMIT rings exist.
+// the rescue grows the safety ring plus up to 1000 more (the old iteration cap).
+#define MASK_RING_FAR 0xFFFF
+#define MASK_RING_LIMIT (MASK_RING_FAR - 1)
+#define MASK_RESCUE_RINGS 1001
 
 /// @brief Get value noise at a given coordinate.
 /// @param x X coordinate (can be fractional).
@@ -26,32 +45,67 @@ int comparePixels(const void *a, const void *b);
 /// @return Noise value in range [0.0, 1.0].
 float getValueNoise(float x, float y, uint32_t seed);
 
-/// @brief Measure the size of a connected region using BFS.
-/// @param grid Pointer to the 3D grid.
-/// @param visited Visited flag array.
-/// @param width Grid width.
-/// @param length Grid length.
-/// @param startX Starting X coordinate.
-/// @param startY Starting Y coordinate.
-/// @return Number of cells in the region.
-int measureRegionSize(uint16_t ***grid, bool *visited, int width, int length, int startX, int startY);
+/// @brief Check whether a row kernel is compiled in and the CPU can run it.
+/// @param isa Kernel to check.
+/// @return true if ridgedNoiseRow may be called with it.
+bool noiseIsaSupported(CgsmeNoiseIsa isa);
 
-/// @brief Keep only the largest connected region in the mask.
-/// @param grid Pointer to the 3D grid.
+/// @brief Widest supported row kernel (what generateRidgedMask uses).
+/// @return Kernel id.
+CgsmeNoiseIsa noiseBestIsa(void);
+
+/// @brief Printable kernel name.
+/// @param isa Kernel id.
+/// @return Static string.
+const char *noiseIsaName(CgsmeNoiseIsa isa);
+
+/// @brief Ridged, domain warped noise scores of one row (three value noise samples per pixel).
+/// @param out Receives `width` scores in [0, 1].
+/// @param y Row.
+/// @param width Number of pixels.
+/// @param params Noise parameters.
+/// @param isa Kernel to use (must be supported, see noiseIsaSupported).
+void ridgedNoiseRow(float *out, uint32_t y, uint32_t width, const NoiseParams *params, CgsmeNoiseIsa isa);
+
+// order preserving integer key of a score (flip the sign bit of positives, every bit of negatives)
+static inline uint32_t scoreKey(float score)
+{
+	uint32_t bits;
+	memcpy(&bits, &score, sizeof(bits));
+	return (bits & 0x80000000u) ? ~bits : (bits | 0x80000000u);
+}
+
+/// @brief Find the cutoff of the `k` highest scores in O(count) (two 16 bit radix histogram passes).
+///        The selection is every score with a key above `*cutoff` plus the first `*ties` scores
+///        (in index order) with a key equal to it, exactly `k` cells in total.
+/// @param scores Scores to select from.
+/// @param count Number of scores.
+/// @param k Number of scores to select (clamped to `count`).
+/// @param arena Scratch arena for the histogram (released before returning).
+/// @param cutoff Receives the key (see scoreKey) of the lowest selected score.
+/// @param ties Receives how many scores equal to the cutoff are selected.
+/// @return false if the histogram could not be allocated.
+bool selectTopScores(const float *scores, uint32_t count, uint32_t k, CgsmeArena *arena, uint32_t *cutoff, uint32_t *ties);
+
+/// @brief Keep only the largest 4-connected region of the mask (two-pass union-find labeling of layer 0).
+/// @param grid Pointer to the 3D grid (cells outside the region are cleared on every layer).
 /// @param width Grid width.
 /// @param length Grid length.
 /// @param height Grid height.
-/// @param startX Starting X coordinate of largest region.
-/// @param startY Starting Y coordinate of largest region.
-void keepOnlyLargestMask(uint16_t ***grid, int width, int length, int height, int startX, int startY);
+/// @param arena Scratch arena (released before returning).
+/// @return Number of cells in the kept region, -1 if the scratch could not be allocated.
+int removeMaskIslands(uint16_t ***grid, int width, int length, int height, CgsmeArena *arena);
 
-/// @brief Dilate the mask by one pixel.
-/// @param grid Pointer to the 3D grid.
+/// @brief Grow the mask (layer 0) by whole dilation rings, the last ring cut in raster order.
+/// @param grid Pointer to the 3D grid (only layer 0 is written).
 /// @param width Grid width.
 /// @param length Grid length.
-/// @param height Grid height.
+/// @param fullRings Rings grown regardless of the budget.
+/// @param maxRings Last ring that may be grown (capped at MASK_RING_LIMIT).
+/// @param needed Pixels wanted in total, the full rings included.
+/// @param arena Scratch arena (released before returning).
 /// @return Number of pixels added.
-int dilateMask(uint16_t ***grid, int width, int length, int height, int maxToAdd);
+int dilateMaskRings(uint16_t ***grid, int width, int length, int fullRings, int maxRings, int needed, CgsmeArena *arena);
 
 /// @brief Generate a ridged noise mask for the grid.
 /// @param grid Pointer to the 3D grid.
@@ -60,7 +114,8 @@ int dilateMask(uint16_t ***grid, int width, int length, int height, int maxToAdd
 /// @param height Grid height.
 /// @param targetFullness Target percentage of filled cells.
 /// @param seed Noise seed.
-void generateRidgedMask(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t height, uint32_t targetFullness, uint32_t seed);
+/// @param arena Scratch arena (everything is released before returning).
+void generateRidgedMask(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t height, uint32_t targetFullness, uint32_t seed, CgsmeArena *arena);
 
 /// @brief Save noise map to debug file.
 /// @param noiseMap Pointer to the noise map.
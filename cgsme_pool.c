@@ -0,0 +1,257 @@
+#include "cgsme_pool.h"
+#include "cgsme_debug.h"
+#include <stdlib.h>
+#ifdef __linux__
+#include <threads.h>
+#include <unistd.h>
+#else
+#include "tinycthread/tinycthread.h"
+#endif
+#ifdef _WIN32
+#include <windows.h>
+#elif !defined(__linux__)
+#include <unistd.h>
+#endif
+
+// one cgsme_pool_run call. lives on the caller's stack, workers only touch it under the lock
+typedef struct CgsmeJobGroup
+{
+	CgsmeJobFunc fn;
+	char *args;
+	size_t argSize;
+	uint32_t count;
+	uint32_t next; // next job index to hand out
+	uint32_t done; // finished jobs
+	struct CgsmeJobGroup *nextGroup;
+} CgsmeJobGroup;
+
+// worker index of the current thread (see cgsme_pool_worker_index)
+static _Thread_local uint32_t tl_workerIndex = CGSME_POOL_NOT_A_WORKER;
+
+// handed to each thread at start
+typedef struct
+{
+	struct CgsmePool *pool;
+	uint32_t index;
+} WorkerStart;
+
+struct CgsmePool
+{
+	thrd_t *threads;
+	WorkerStart *starts;
+	uint32_t threadCount;
+	mtx_t lock;
+	cnd_t workAvailable;
+	cnd_t workDone;
+	// FIFO of groups that still have jobs to hand out
+	CgsmeJobGroup *head;
+	CgsmeJobGroup *tail;
+	bool stopping;
+};
+
+uint32_t cgsme_hardware_threads(void)
+{
+#ifdef _WIN32
+	SYSTEM_INFO info;
+	GetSystemInfo(&info);
+	return info.dwNumberOfProcessors > 0 ? (uint32_t)info.dwNumberOfProcessors : 1;
+#else
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (uint32_t)n : 1;
+#endif
+}
+
+// take the next job index from a group, unlinking it once everything is handed out
+// assumes pool->lock is held
+static uint32_t takeJob(CgsmePool *pool, CgsmeJobGroup *g)
+{
+	uint32_t idx = g->next++;
+	if (g->next == g->count)
+	{
+		// unlink (the group is usually the head, but a helping caller can drain one further back)
+		CgsmeJobGroup *prev = NULL;
+		for (CgsmeJobGroup *it = pool->head; it; prev = it, it = it->nextGroup)
+		{
+			if (it != g)
+				continue;
+			if (prev)
+				prev->nextGroup = g->nextGroup;
+			else
+				pool->head = g->nextGroup;
+			if (pool->tail == g)
+				pool->tail = prev;
+			break;
+		}
+	}
+	return idx;
+}
+
+// runs one job outside the lock and re-acquires it to publish completion
+static void runJob(CgsmePool *pool, CgsmeJobGroup *g, uint32_t idx)
+{
+	mtx_unlock(&pool->lock);
+	g->fn((void *)(g->args + (size_t)idx * g->argSize));
+	mtx_lock(&pool->lock);
+
+	g->done++;
+	if (g->done == g->count)
+		cnd_broadcast(&pool->workDone);
+}
+
+static int workerMain(void *arg)
+{
+	WorkerStart *start = (WorkerStart *)arg;
+	CgsmePool *pool = start->pool;
+	tl_workerIndex = start->index;
+
+	mtx_lock(&pool->lock);
+	while (true)
+	{
+		while (!pool->head && !pool->stopping)
+			cnd_wait(&pool->workAvailable, &pool->lock);
+
+		if (!pool->head) // stopping and drained
+			break;
+
+		CgsmeJobGroup *g = pool->head;
+		uint32_t idx = takeJob(pool, g);
+		runJob(pool, g, idx);
+	}
+	mtx_unlock(&pool->lock);
+	return 0;
+}
+
+CgsmePool *cgsme_pool_create(uint32_t threadCount)
+{
+	CGSME_PROFILE_FUNC();
+	if (threadCount == 0)
+		threadCount = cgsme_hardware_threads();
+	if (threadCount > CGSME_POOL_MAX_THREADS)
+		threadCount = CGSME_POOL_MAX_THREADS;
+
+	CgsmePool *pool = calloc(1, sizeof(CgsmePool));
+	if (!pool)
+		return NULL;
+
+	pool->threads = malloc(sizeof(thrd_t) * threadCount);
+	pool->starts = malloc(sizeof(WorkerStart) * threadCount);
+	if (!pool->threads || !pool->starts)
+	{
+		free(pool->threads);
+		free(pool->starts);
+		free(pool);
+		return NULL;
+	}
+
+	if (mtx_init(&pool->lock, mtx_plain) != thrd_success)
+	{
+		free(pool->threads);
+		free(pool->starts);
+		free(pool);
+		return NULL;
+	}
+	if (cnd_init(&pool->workAvailable) != thrd_success)
+	{
+		mtx_destroy(&pool->lock);
+		free(pool->threads);
+		free(pool->starts);
+		free(pool);
+		return NULL;
+	}
+	if (cnd_init(&pool->workDone) != thrd_success)
+	{
+		cnd_destroy(&pool->workAvailable);
+		mtx_destroy(&pool->lock);
+		free(pool->threads);
+		free(pool->starts);
+		free(pool);
+		return NULL;
+	}
+
+	for (uint32_t i = 0; i < threadCount; i++)
+	{
+		pool->starts[i].pool = pool;
+		pool->starts[i].index = i;
+		if (thrd_create(&pool->threads[i], workerMain, &pool->starts[i]) != thrd_success)
+		{
+			// keep whatever started, a smaller pool is still a working pool
+			break;
+		}
+		pool->threadCount++;
+	}
+
+	if (pool->threadCount == 0)
+	{
+		cgsme_pool_destroy(pool);
+		return NULL;
+	}
+
+	return pool;
+}
+
+void cgsme_pool_destroy(CgsmePool *pool)
+{
+	CGSME_PROFILE_FUNC();
+	if (!pool)
+		return;
+
+	mtx_lock(&pool->lock);
+	pool->stopping = true;
+	cnd_broadcast(&pool->workAvailable);
+	mtx_unlock(&pool->lock);
+
+	for (uint32_t i = 0; i < pool->threadCount; i++)
+		thrd_join(pool->threads[i], NULL);
+
+	cnd_destroy(&pool->workDone);
+	cnd_destroy(&pool->workAvailable);
+	mtx_destroy(&pool->lock);
+	free(pool->threads);
+	free(pool->starts);
+	free(pool);
+}
+
+uint32_t cgsme_pool_thread_count(const CgsmePool *pool)
+{
+	return pool ? pool->threadCount : 0;
+}
+
+uint32_t cgsme_pool_worker_index(void)
+{
+	return tl_workerIndex;
+}
+
+void cgsme_pool_run(CgsmePool *pool, CgsmeJobFunc fn, void *args, size_t argSize, uint32_t count)
+{
+	CGSME_PROFILE_FUNC();
+	if (count == 0)
+		return;
+
+	CgsmeJobGroup group = {fn, (char *)args, argSize, count, 0, 0, NULL};
+
+	mtx_lock(&pool->lock);
+
+	// publish
+	if (pool->tail)
+		pool->tail->nextGroup = &group;
+	else
+		pool->head = &group;
+	pool->tail = &group;
+	cnd_broadcast(&pool->workAvailable);
+
+	// help with our own batch, then wait for the stragglers
+	while (group.done < group.count)
+	{
+		if (group.next < group.count)
+		{
+			uint32_t idx = takeJob(pool, &group);
+			runJob(pool, &group, idx);
+		}
+		else
+		{
+			cnd_wait(&pool->workDone, &pool->lock);
+		}
+	}
+
+	mtx_unlock(&pool->lock);
+}
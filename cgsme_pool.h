@@ -0,0 +1,54 @@
+#ifndef CGSME_POOL_H
+#define CGSME_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// upper bound for the worker count, keeps a bad config from spawning thousands of threads
+#define CGSME_POOL_MAX_THREADS 256
+
+// cgsme_pool_worker_index() on threads that are not pool workers
+#define CGSME_POOL_NOT_A_WORKER UINT32_MAX
+
+// job signature matches thrd_start_t so existing thread entry points (generateLayerThread)
+// can be submitted unchanged
+typedef int (*CgsmeJobFunc)(void *arg);
+
+// long-lived, fixed size set of worker threads
+typedef struct CgsmePool CgsmePool;
+
+/// @brief Number of hardware threads reported by the OS (at least 1).
+/// @return Logical processor count.
+uint32_t cgsme_hardware_threads(void);
+
+/// @brief Spawn a pool of worker threads that live until `cgsme_pool_destroy`.
+/// @param threadCount Number of workers, 0 picks `cgsme_hardware_threads()`. Clamped to CGSME_POOL_MAX_THREADS.
+/// @return Pointer to the pool, NULL if threads or sync primitives could not be created.
+CgsmePool *cgsme_pool_create(uint32_t threadCount);
+
+/// @brief Stop and join all workers, then free the pool. Pending jobs are finished first.
+/// @param pool Pointer to the pool (NULL is ignored).
+void cgsme_pool_destroy(CgsmePool *pool);
+
+/// @brief Number of worker threads owned by the pool.
+/// @param pool Pointer to the pool.
+/// @return Worker count.
+uint32_t cgsme_pool_thread_count(const CgsmePool *pool);
+
+/// @brief Index of the pool worker running the calling thread.
+/// @return 0..threadCount-1 on a worker thread, CGSME_POOL_NOT_A_WORKER on any other thread.
+uint32_t cgsme_pool_worker_index(void);
+
+/// @brief Run `count` jobs and block until all of them finished.
+/// @param pool Pointer to the pool.
+/// @param fn Job function, called once per element.
+/// @param args Base of an array of `count` job arguments.
+/// @param argSize Size of one element in `args` (bytes).
+/// @param count Number of jobs.
+/// the calling thread executes jobs of its own batch while it waits, so nested calls from
+/// inside a job cannot deadlock and a pool with fewer workers than jobs still makes progress.
+/// safe to call from several threads at once, no allocation happens per call.
+void cgsme_pool_run(CgsmePool *pool, CgsmeJobFunc fn, void *args, size_t argSize, uint32_t count);
+
+#endif // CGSME_POOL_H
@@ -0,0 +1,413 @@
+#include "cgsme_reach.h"
+#include "cgsme_tileset.h"
+#include "cgsme_debug.h"
+#include <string.h>
+
+// empty word range of a row (lo > hi)
+#define REACH_NONE UINT32_MAX
+
+// floods up to this many cells are a plain BFS, the sweeps only pay off on larger ones
+#define REACH_SMALL_CELLS 256
+
+// tiles that may leave towards N / E / S / W
+static const uint16_t REACH_PORT_MASK[4] = {CGSME_TILES_WITH_PORT(DIR_N), CGSME_TILES_WITH_PORT(DIR_E),
+											CGSME_TILES_WITH_PORT(DIR_S), CGSME_TILES_WITH_PORT(DIR_W)};
+
+ReachLayer *createReachLayer(uint32_t width, uint32_t length, CgsmeArena *arena)
+{
+	CGSME_PROFILE_FUNC();
+	ReachLayer *r = arenaAlloc(arena, sizeof(ReachLayer));
+	if (!r)
+		return NULL;
+	r->width = width;
+	r->length = length;
+	r->wordsPerRow = (width + 63) / 64;
+	r->stride = r->wordsPerRow + 2;
+	r->planeWords = (size_t)r->stride * (length + 2);
+
+	// 7 boards in one block, all closed / zero, 4 word ranges per padded row and the cell list
+	uint64_t *words = arenaCalloc(arena, r->planeWords * 7, sizeof(uint64_t));
+	uint32_t *ranges = arenaAlloc(arena, sizeof(uint32_t) * (length + 2) * 4);
+	r->cellWord = arenaAlloc(arena, sizeof(size_t) * REACH_SMALL_CELLS);
+	r->cellRow = arenaAlloc(arena, sizeof(uint32_t) * REACH_SMALL_CELLS);
+	r->cellBit = arenaAlloc(arena, sizeof(uint8_t) * REACH_SMALL_CELLS);
+	if (!words || !ranges || !r->cellWord || !r->cellRow || !r->cellBit)
+		return NULL;
+	for (int d = 0; d < 4; d++)
+		r->port[d] = words + r->planeWords * d;
+	r->solid = words + r->planeWords * 4;
+	r->done = words + r->planeWords * 5;
+	r->reach = words + r->planeWords * 6;
+	r->pendLo = ranges;
+	r->pendHi = ranges + (length + 2);
+	r->spanLo = ranges + (length + 2) * 2;
+	r->spanHi = ranges + (length + 2) * 3;
+	for (uint32_t p = 0; p < length + 2; p++)
+	{
+		r->pendLo[p] = r->spanLo[p] = REACH_NONE;
+		r->pendHi[p] = r->spanHi[p] = 0;
+	}
+	r->pendingRows = 0;
+	r->cellCount = 0;
+	r->top = REACH_NONE;
+	r->bottom = 0;
+	r->scanRow = 1;
+	r->scanWord = 0;
+	return r;
+}
+
+void reachLoad(ReachLayer *r, uint16_t **gridLayer, bool mutual)
+{
+	CGSME_PROFILE_FUNC();
+	const size_t s = r->stride;
+	for (uint32_t y = 0; y < r->length; y++)
+	{
+		const uint16_t *row = gridLayer[y];
+		for (uint32_t k = 0; k < r->wordsPerRow; k++)
+		{
+			uint32_t x0 = k * 64;
+			uint32_t count = r->width - x0 < 64 ? r->width - x0 : 64;
+			uint64_t solid = 0;
+			uint64_t ports[4] = {0, 0, 0, 0};
+			for (uint32_t b = 0; b < count; b++)
+			{
+				uint16_t v = row[x0 + b];
+				bool single = v != Empty_Tile && !(v & (v - 1));
+				if (mutual ? !single : v == Empty_Tile)
+					continue;
+				solid |= 1ull << b;
+				for (int d = 0; d < 4; d++)
+					ports[d] |= (uint64_t)((v & REACH_PORT_MASK[d]) != 0) << b;
+			}
+			size_t i = (size_t)(y + 1) * s + 1 + k;
+			r->solid[i] = solid;
+			for (int d = 0; d < 4; d++)
+				r->port[d][i] = ports[d];
+		}
+	}
+
+	// mutual: a port only counts if the neighbour has the one facing back. the link of a pair is
+	// symmetric, so narrowing both sides in place in raster order gives the same boards
+	if (mutual)
+	{
+		uint64_t **port = r->port;
+		for (uint32_t p = 1; p <= r->length; p++)
+		{
+			for (size_t i = p * s + 1; i < p * s + 1 + r->wordsPerRow; i++)
+			{
+				port[0][i] &= port[2][i - s];
+				port[2][i] &= port[0][i + s];
+				port[1][i] &= (port[3][i] >> 1) | (port[3][i + 1] << 63);
+				port[3][i] &= (port[1][i] << 1) | (port[1][i - 1] >> 63);
+			}
+		}
+	}
+
+	// forget every flood
+	memset(r->done, 0, sizeof(uint64_t) * r->planeWords);
+	memset(r->reach, 0, sizeof(uint64_t) * r->planeWords);
+	for (uint32_t p = 0; p < r->length + 2; p++)
+	{
+		r->pendLo[p] = r->spanLo[p] = REACH_NONE;
+		r->pendHi[p] = r->spanHi[p] = 0;
+	}
+	r->pendingRows = 0;
+	r->cellCount = 0;
+	r->top = REACH_NONE;
+	r->bottom = 0;
+	r->scanRow = 1;
+	r->scanWord = 0;
+}
+
+// occluded fills: spread the bits of `g` one cell at a time into the bits of `p`
+// (p = cells that may be entered from their west / east neighbour), in log steps
+static inline uint64_t fillEast(uint64_t g, uint64_t p)
+{
+	g |= p & (g << 1);
+	p &= p << 1;
+	g |= p & (g << 2);
+	p &= p << 2;
+	g |= p & (g << 4);
+	p &= p << 4;
+	g |= p & (g << 8);
+	p &= p << 8;
+	g |= p & (g << 16);
+	p &= p << 16;
+	return g | (p & (g << 32));
+}
+
+static inline uint64_t fillWest(uint64_t g, uint64_t p)
+{
+	g |= p & (g >> 1);
+	p &= p >> 1;
+	g |= p & (g >> 2);
+	p &= p >> 2;
+	g |= p & (g >> 4);
+	p &= p >> 4;
+	g |= p & (g >> 8);
+	p &= p >> 8;
+	g |= p & (g >> 16);
+	p &= p >> 16;
+	return g | (p & (g >> 32));
+}
+
+// words [lo, hi] of padded row p have new cells: fill east then west along the row (a cell a
+// west run reaches has the rest of the run east of it already), the range grows with the carries
+static void fillRow(ReachLayer *r, uint32_t p, uint32_t *lo, uint32_t *hi)
+{
+	const uint64_t *east = r->port[1], *west = r->port[3];
+	uint64_t *reach = r->reach;
+	size_t base = (size_t)p * r->stride + 1;
+	uint32_t first = *lo, last = *hi;
+
+	for (uint32_t k = first;; k++)
+	{
+		size_t i = base + k;
+		uint64_t free = r->solid[i] & ~r->done[i];
+		uint64_t old = reach[i];
+		uint64_t cur = fillEast(old | (((reach[i - 1] & east[i - 1]) >> 63) & free), (east[i] << 1) & free);
+		if (cur != old)
+		{
+			reach[i] = cur;
+			last = k > last ? k : last;
+		}
+		// past the changed words only a carry into the next one goes on (the guard word stops it)
+		uint64_t carry = ((cur & east[i]) >> 63) & r->solid[i + 1] & ~r->done[i + 1] & ~reach[i + 1];
+		if (k >= last && !carry)
+			break;
+	}
+
+	for (uint32_t k = last;; k--)
+	{
+		size_t i = base + k;
+		uint64_t free = r->solid[i] & ~r->done[i];
+		uint64_t old = reach[i];
+		uint64_t cur = fillWest(old | (((reach[i + 1] & west[i + 1]) << 63) & free), (west[i] >> 1) & free);
+		if (cur != old)
+		{
+			reach[i] = cur;
+			first = k < first ? k : first;
+		}
+		uint64_t carry = ((cur & west[i]) << 63) & r->solid[i - 1] & ~r->done[i - 1] & ~reach[i - 1];
+		if (k == 0 || (k <= first && !carry))
+			break;
+	}
+
+	*lo = first;
+	*hi = last;
+}
+
+// row p grew in words [lo, hi]: remember them, the rows above and below have to pull there
+static void grewRow(ReachLayer *r, uint32_t p, uint32_t lo, uint32_t hi)
+{
+	r->spanLo[p] = lo < r->spanLo[p] ? lo : r->spanLo[p];
+	r->spanHi[p] = hi > r->spanHi[p] ? hi : r->spanHi[p];
+	r->top = p < r->top ? p : r->top;
+	r->bottom = p > r->bottom ? p : r->bottom;
+	for (uint32_t q = p - 1; q <= p + 1; q += 2)
+	{
+		if (q < 1 || q > r->length)
+			continue;
+		r->pendingRows += r->pendLo[q] == REACH_NONE;
+		r->pendLo[q] = lo < r->pendLo[q] ? lo : r->pendLo[q];
+		r->pendHi[q] = hi > r->pendHi[q] ? hi : r->pendHi[q];
+	}
+}
+
+// redo the pending words of padded row p: pull in what the rows above and below reach through
+// their ports, then fill along the row. returns true if the row grew
+static inline bool visitRow(ReachLayer *r, uint32_t p)
+{
+	uint32_t lo = r->pendLo[p], hi = r->pendHi[p];
+	if (lo > hi)
+		return false;
+	r->pendLo[p] = REACH_NONE;
+	r->pendHi[p] = 0;
+	r->pendingRows--;
+
+	const size_t s = r->stride;
+	const uint64_t *north = r->port[0], *south = r->port[2];
+	uint64_t *reach = r->reach;
+	size_t base = (size_t)p * s + 1;
+	uint32_t newLo = REACH_NONE, newHi = 0;
+	uint64_t sideways = 0; // new cells with a port along the row
+	for (uint32_t k = lo; k <= hi; k++)
+	{
+		size_t i = base + k;
+		uint64_t in = ((reach[i - s] & south[i - s]) | (reach[i + s] & north[i + s])) & r->solid[i] & ~r->done[i] & ~reach[i];
+		if (in)
+		{
+			reach[i] |= in;
+			newLo = newLo == REACH_NONE ? k : newLo;
+			newHi = k;
+			sideways |= in & (r->port[1][i] | r->port[3][i]);
+		}
+	}
+	if (newLo == REACH_NONE)
+		return false;
+
+	// straight corridors only go on vertically
+	if (sideways)
+		fillRow(r, p, &newLo, &newHi);
+	grewRow(r, p, newLo, newHi);
+	return true;
+}
+
+// small floods: a plain BFS over the boards that marks the cells done right away and keeps them
+// in the cell list instead of the reach board. past REACH_SMALL_CELLS cells it is undone and
+// gives up. returns the cells or 0
+static uint32_t floodSmall(ReachLayer *r, size_t start, uint32_t startRow, uint32_t startBit)
+{
+	const size_t s = r->stride;
+	size_t *word = r->cellWord;
+	uint32_t *row = r->cellRow;
+	uint8_t *bit = r->cellBit;
+	uint32_t head = 0, tail = 0;
+	r->done[start] |= 1ull << startBit;
+	word[tail] = start;
+	row[tail] = startRow;
+	bit[tail++] = (uint8_t)startBit;
+
+	while (head < tail)
+	{
+		size_t i = word[head];
+		uint32_t p = row[head];
+		uint32_t b = bit[head++];
+		// neighbours N / E / S / W, the bit after 63 is bit 0 of the next word (guard words are closed)
+		size_t next[4] = {i - s, i + (b == 63), i + s, i - (b == 0)};
+		uint32_t nextBit[4] = {b, (b + 1) & 63, b, (b - 1) & 63};
+		uint32_t nextRow[4] = {p - 1, p, p + 1, p};
+		for (int d = 0; d < 4; d++)
+		{
+			size_t j = next[d];
+			uint64_t m = 1ull << nextBit[d];
+			if (!((r->port[d][i] >> b) & 1) || !(r->solid[j] & ~r->done[j] & m))
+				continue;
+			if (tail == REACH_SMALL_CELLS)
+			{
+				for (uint32_t c = 0; c < tail; c++)
+					r->done[word[c]] &= ~(1ull << bit[c]);
+				return 0;
+			}
+			r->done[j] |= m;
+			word[tail] = j;
+			row[tail] = nextRow[d];
+			bit[tail++] = (uint8_t)nextBit[d];
+		}
+	}
+	return tail;
+}
+
+uint64_t reachFlood(ReachLayer *r, uint32_t x, uint32_t y)
+{
+	// clear the last flood (its cells are in done already)
+	for (uint32_t p = r->top; p <= r->bottom; p++)
+	{
+		for (uint32_t k = r->spanLo[p]; k <= r->spanHi[p]; k++)
+			r->reach[(size_t)p * r->stride + 1 + k] = 0;
+		r->spanLo[p] = REACH_NONE;
+		r->spanHi[p] = 0;
+	}
+	r->top = REACH_NONE;
+	r->bottom = 0;
+	r->cellCount = 0;
+
+	size_t i = (size_t)(y + 1) * r->stride + 1 + x / 64;
+	uint64_t bit = 1ull << (x & 63);
+	if (!(r->solid[i] & ~r->done[i] & bit))
+		return 0;
+	r->cellCount = floodSmall(r, i, y + 1, x & 63);
+	if (r->cellCount)
+		return r->cellCount;
+	r->reach[i] = bit;
+	uint32_t lo = x / 64, hi = lo;
+	fillRow(r, y + 1, &lo, &hi);
+	grewRow(r, y + 1, lo, hi);
+
+	// sweep down and up over the rows next to the flood until no row has words to redo
+	while (r->pendingRows)
+	{
+		for (uint32_t p = r->top > 1 ? r->top - 1 : 1; p <= r->bottom + 1 && p <= r->length; p++)
+			visitRow(r, p);
+		for (uint32_t p = r->bottom < r->length ? r->bottom + 1 : r->length; p + 1 >= r->top && p >= 1 && r->pendingRows; p--)
+			visitRow(r, p);
+	}
+
+	// later floods stay out
+	uint64_t cells = 0;
+	for (uint32_t p = r->top; p <= r->bottom; p++)
+	{
+		for (uint32_t k = r->spanLo[p]; k <= r->spanHi[p]; k++)
+		{
+			size_t j = (size_t)p * r->stride + 1 + k;
+			r->done[j] |= r->reach[j];
+			cells += __builtin_popcountll(r->reach[j]);
+		}
+	}
+	return cells;
+}
+
+void reachLabel(const ReachLayer *r, uint32_t **labels, uint32_t regionID)
+{
+	for (uint32_t c = 0; c < r->cellCount; c++)
+	{
+		uint32_t p = r->cellRow[c];
+		labels[p - 1][(uint32_t)(r->cellWord[c] - (size_t)p * r->stride - 1) * 64 + r->cellBit[c]] = regionID;
+	}
+	for (uint32_t p = r->top; p <= r->bottom; p++)
+	{
+		uint32_t *row = labels[p - 1];
+		for (uint32_t k = r->spanLo[p]; k <= r->spanHi[p]; k++)
+		{
+			for (uint64_t w = r->reach[(size_t)p * r->stride + 1 + k]; w; w &= w - 1)
+				row[k * 64 + __builtin_ctzll(w)] = regionID;
+		}
+	}
+}
+
+void reachTakeLabeled(ReachLayer *r, uint32_t **labels, uint32_t rows, uint32_t except)
+{
+	for (uint32_t y = 0; y < rows && y < r->length; y++)
+	{
+		const uint32_t *row = labels[y];
+		uint64_t *done = r->done + (size_t)(y + 1) * r->stride + 1;
+		for (uint32_t x = 0; x < r->width; x++)
+		{
+			if (row[x] != 0 && row[x] != except)
+				done[x / 64] |= 1ULL << (x & 63);
+		}
+	}
+}
+
+bool reachNextSeed(ReachLayer *r, uint32_t *outX, uint32_t *outY)
+{
+	// floods only ever take cells, so the scan never has to look back
+	for (; r->scanRow <= r->length; r->scanRow++, r->scanWord = 0)
+	{
+		for (; r->scanWord < r->wordsPerRow; r->scanWord++)
+		{
+			size_t i = (size_t)r->scanRow * r->stride + 1 + r->scanWord;
+			uint64_t w = r->solid[i] & ~r->done[i];
+			if (w)
+			{
+				*outX = r->scanWord * 64 + __builtin_ctzll(w);
+				*outY = r->scanRow - 1;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+uint32_t reachLabelRegions(ReachLayer *r, uint32_t **labels)
+{
+	CGSME_PROFILE_FUNC();
+	uint32_t regions = 0;
+	uint32_t x, y;
+	while (reachNextSeed(r, &x, &y))
+	{
+		reachFlood(r, x, y);
+		reachLabel(r, labels, ++regions);
+	}
+	return regions;
+}
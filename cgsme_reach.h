@@ -0,0 +1,112 @@
+#ifndef CGSME_REACH_H
+#define CGSME_REACH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "cgsme_utils.h"
+#include "tiles.h"
+
+/*
+	REACHABILITY ENGINE
+
+	a layer as bitboards: one "may be entered" board and one "may leave towards d" board per
+	direction. bit x of word k in row y stands for cell (64k + x, y). a flood grows 64 cells per
+	word: a row pulls in what the rows above and below reach through their ports (one AND per
+	word), then fills east and west along the row with log-step shifted ANDs (occluded fill), the
+	carry crossing into the next word. rows are swept down and up until nothing changes. every
+	row keeps the word range that still has to be redone, so a sweep only visits the words next
+	to what changed last (long corridors stay cheap, the whole layer is never rescanned).
+	a flood starts as a plain BFS and only switches to the sweeps once it passes a few hundred
+	cells, tiny regions are cheaper cell by cell.
+
+	cells of earlier floods are never entered again, which is what labels the regions one by one
+	(same regions and same order as the BFS of regionMarkerIterative).
+
+	rows carry one guard word on each side and there is one guard row above and below, all of
+	them closed, like the padded ring of the solver.
+*/
+
+typedef struct
+{
+	uint32_t width;
+	uint32_t length;
+	uint32_t wordsPerRow; // words holding cells
+	uint32_t stride;	  // words per row including both guard words
+	size_t planeWords;	  // stride * (length + 2)
+	uint64_t *port[4];	  // the cell may leave towards N / E / S / W
+	uint64_t *solid;	  // the cell may be entered
+	uint64_t *done;		  // cells of finished floods
+	uint64_t *reach;	  // cells of the last flood (if it used the sweeps)
+	// per padded row (guard rows included): words left to redo, words the last flood touched
+	uint32_t *pendLo, *pendHi;
+	uint32_t *spanLo, *spanHi;
+	uint32_t pendingRows; // rows with words to redo
+	uint32_t top, bottom; // padded rows the last flood touched (top > bottom: none)
+	// a small last flood (plain BFS) is a cell list instead: word, padded row and bit per cell
+	size_t *cellWord;
+	uint32_t *cellRow;
+	uint8_t *cellBit;
+	uint32_t cellCount;
+	uint32_t scanRow;	  // padded row and word before which every cell is taken (reachNextSeed)
+	uint32_t scanWord;
+} ReachLayer;
+
+/// @brief Create an empty (all closed) reachability layer.
+/// @param width Layer width.
+/// @param length Layer length.
+/// @param arena Arena the storage is taken from (released by the caller).
+/// @return Pointer to the layer, NULL if the arena is out of memory.
+ReachLayer *createReachLayer(uint32_t width, uint32_t length, CgsmeArena *arena);
+
+/// @brief Build the boards of a layer and forget every earlier flood.
+/// @param r Reachability layer of the same size.
+/// @param gridLayer Layer indexed [y][x] (padded or not, the ring is not read).
+/// @param mutual false: a port of the source into any non-void tile is a step (regionMarkerIterative).
+///               true: only single tiles whose ports face each other are linked (main.lua's canTraverse).
+void reachLoad(ReachLayer *r, uint16_t **gridLayer, bool mutual);
+
+/// @brief Flood everything reachable from (x, y) that no earlier flood took.
+/// @param r Reachability layer, the cells are added to the finished ones.
+/// @param x Start column.
+/// @param y Start row.
+/// @return Number of cells reached, 0 if the start cannot be entered or is taken.
+uint64_t reachFlood(ReachLayer *r, uint32_t x, uint32_t y);
+
+/// @brief Write a label into every cell of the last flood.
+/// @param r Reachability layer.
+/// @param labels Label plane indexed [y][x].
+/// @param regionID Label to write.
+void reachLabel(const ReachLayer *r, uint32_t **labels, uint32_t regionID);
+
+/// @brief Mark cells labeled by someone else (e.g. a BFS) as taken, floods and seeds skip them.
+/// @param r Loaded reachability layer (see reachLoad).
+/// @param labels Label plane indexed [y][x].
+/// @param rows Rows to look at, from the top.
+/// @param except Label left open (a region that is still to be flooded), 0 for none.
+void reachTakeLabeled(ReachLayer *r, uint32_t **labels, uint32_t rows, uint32_t except);
+
+/// @brief First cell in raster order that may be entered and was not flooded yet.
+/// @param r Reachability layer.
+/// @param outX Output column.
+/// @param outY Output row.
+/// @return false if every cell is taken.
+bool reachNextSeed(ReachLayer *r, uint32_t *outX, uint32_t *outY);
+
+/// @brief Label every region, in the order of their first cell (like findConnectedRegions).
+/// @param r Loaded reachability layer (see reachLoad).
+/// @param labels Zeroed label plane indexed [y][x], receives 1..count, void stays 0.
+/// @return Number of regions.
+uint32_t reachLabelRegions(ReachLayer *r, uint32_t **labels);
+
+/// @brief Check whether a cell was taken by a flood since the last reachLoad.
+/// @param r Reachability layer.
+/// @param x Column.
+/// @param y Row.
+/// @return true if some flood reached the cell.
+static inline bool reachVisited(const ReachLayer *r, uint32_t x, uint32_t y)
+{
+	return (r->done[(size_t)(y + 1) * r->stride + 1 + x / 64] >> (x & 63)) & 1;
+}
+
+#endif // CGSME_REACH_H
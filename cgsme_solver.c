@@ -4,47 +4,42 @@
 #include <math.h>
 
 // returns true if any collapsed neighbor has an open connection pointing to this tile
+// (the layer is padded, the void ring never points anywhere)
 bool isTileRequired(uint16_t **grid, uint32_t width, uint32_t length, uint32_t x, uint32_t y)
 {
 	CGSME_PROFILE_FUNC();
+	(void)width;
+	(void)length;
+	int32_t cx = (int32_t)x;
+	int32_t cy = (int32_t)y;
+
 	// check NNORTH neighbor (y-1). points down (SOUTH)
 	// 'North_Open_Mask' in tiles.h defines tiles that have a SOUTH port
-	if (y > 0 && __builtin_popcount(grid[y - 1][x]) == 1)
-	{
-		if (grid[y - 1][x] & North_Open_Mask)
-			return true;
-	}
+	uint16_t n = grid[cy - 1][cx];
+	if (__builtin_popcount(n) == 1 && (n & North_Open_Mask))
+		return true;
 
 	// check SOUTH neighbor (y+1). It points up (NORTH).
 	// 'South_Open_Mask' defines tiles that have a NORTH
-	if (y < length - 1 && __builtin_popcount(grid[y + 1][x]) == 1)
-	{
-		if (grid[y + 1][x] & South_Open_Mask)
-			return true;
-	}
+	uint16_t s = grid[cy + 1][cx];
+	if (__builtin_popcount(s) == 1 && (s & South_Open_Mask))
+		return true;
 
-	if (x < width - 1 && __builtin_popcount(grid[y][x + 1]) == 1)
-	{
-		if (grid[y][x + 1] & East_Open_Mask)
-			return true;
-	}
+	uint16_t e = grid[cy][cx + 1];
+	if (__builtin_popcount(e) == 1 && (e & East_Open_Mask))
+		return true;
 
-	if (x > 0 && __builtin_popcount(grid[y][x - 1]) == 1)
-	{
-		if (grid[y][x - 1] & West_Open_Mask)
-			return true;
-	}
+	uint16_t w = grid[cy][cx - 1];
+	if (__builtin_popcount(w) == 1 && (w & West_Open_Mask))
+		return true;
 
 	return false;
 }
 
 // new version oc collapseTile with spawnrates (smooth gaussian model that changes over time)
-void collapseTile(uint16_t *tile, float *rates, uint32_t *rng)
+void collapseTile(uint16_t *tile, float *rates, CgsmeRng *rng)
 {
-#ifdef cgsme_DEBUG
-	uint64_t __cgsme_collapse_start = cgsme_now_us();
-	uint64_t __cgsme_collapse_start_cycles = cgsme_now_cycles();
-#endif
+	CGSME_PROFILE_FUNC();
 	if (*tile == 0)
 		return;
 
@@ -70,19 +65,8 @@ void collapseTile(uint16_t *tile, float *rates, uint32_t *rng)
 		// OLD LOGIC FALLBACK
 		uint32_t pop_count = __builtin_popcount(*tile);
 		if (pop_count == 0)
-		{
-#ifdef cgsme_DEBUG
-			if (cgsme_get_enabled())
-			{
-				uint64_t __cgsme_collapse_end = cgsme_now_us();
-				uint64_t __cgsme_collapse_end_cycles = cgsme_now_cycles();
-				cgsme_profile_record("collapseTile", (unsigned long long)(__cgsme_collapse_end - __cgsme_collapse_start),
-									 (unsigned long long)(__cgsme_collapse_end_cycles - __cgsme_collapse_start_cycles));
-			}
-#endif
 			return;
-		}
-		uint32_t r = nextRandom(rng) % pop_count;
+		uint32_t r = cgsme_rng_bounded_fast(rng, pop_count);
 		uint32_t set_bits_found = 0;
 		for (int i = 0; i < 16; i++)
 		{
@@ -91,39 +75,16 @@ void collapseTile(uint16_t *tile, float *rates, uint32_t *rng)
 				if (set_bits_found == r)
 				{
 					*tile = (1U << i);
-#ifdef cgsme_DEBUG
-					if (cgsme_get_enabled())
-					{
-						uint64_t __cgsme_collapse_end = cgsme_now_us();
-						uint64_t __cgsme_collapse_end_cycles = cgsme_now_cycles();
-						cgsme_profile_record("collapseTile", (unsigned long long)(__cgsme_collapse_end - __cgsme_collapse_start),
-											 (unsigned long long)(__cgsme_collapse_end_cycles - __cgsme_collapse_start_cycles));
-					}
-#endif
 					return;
 				}
 				set_bits_found++;
 			}
 		}
-		do
-		{
-#ifdef cgsme_DEBUG
-			if (cgsme_get_enabled())
-			{
-				uint64_t __cgsme_collapse_end = cgsme_now_us();
-				uint64_t __cgsme_collapse_end_cycles = cgsme_now_cycles();
-				cgsme_profile_record("collapseTile", (unsigned long long)(__cgsme_collapse_end - __cgsme_collapse_start),
-									 (unsigned long long)(__cgsme_collapse_end_cycles - __cgsme_collapse_start_cycles));
-			}
-#endif
-		} while (0);
 		return;
 	}
 
 	// 2. Pick a random value within the total weight range
-	// threadRandom returns uint32. Divide by max to get 0.0-1.0 float.
-	// 4294967296.0 is 2^32.
-	float random_01 = (float)nextRandom(rng) / 4294967296.0f;
+	float random_01 = cgsme_rng_float01_fast(rng);
 	float random_val = random_01 * total_weight;
 
 	// 3. find the winner
@@ -140,15 +101,6 @@ void collapseTile(uint16_t *tile, float *rates, uint32_t *rng)
 			if (random_val <= 0)
 			{
 				*tile = (1U << i);
-#ifdef cgsme_DEBUG
-				if (cgsme_get_enabled())
-				{
-					uint64_t __cgsme_collapse_end = cgsme_now_us();
-					uint64_t __cgsme_collapse_end_cycles = cgsme_now_cycles();
-					cgsme_profile_record("collapseTile", (unsigned long long)(__cgsme_collapse_end - __cgsme_collapse_start),
-										 (unsigned long long)(__cgsme_collapse_end_cycles - __cgsme_collapse_start_cycles));
-				}
-#endif
 				return;
 			}
 		}
@@ -161,211 +113,88 @@ void collapseTile(uint16_t *tile, float *rates, uint32_t *rng)
 		if ((*tile >> i) & 1)
 		{
 			*tile = (1U << i);
-#ifdef cgsme_DEBUG
-			if (cgsme_get_enabled())
-			{
-				uint64_t __cgsme_collapse_end = cgsme_now_us();
-				cgsme_log("collapseTile() fallback-last-bit(%d) elapsed=%llu us", i, (unsigned long long)(__cgsme_collapse_end - __cgsme_collapse_start));
-			}
-#endif
 			return;
 		}
 	}
 }
 
-void updateNeighbours(uint16_t **gridLayer, uint32_t width, uint32_t length, uint32_t x, uint32_t y, MinHeap *heap, float **distMap, uint32_t *rng)
+// state a contradicted tile restarts from: whatever its neighbours allow right now (collapsed
+// tiles, mask holes and the void ring). the masks are independent per direction, so this is
+// only empty when every side is closed, and then the tile really is void.
+static inline uint16_t revivedState(uint16_t **gridLayer, int32_t x, int32_t y)
 {
-#ifdef cgsme_DEBUG
-	uint64_t __cgsme_neigh_start = cgsme_now_us();
-	uint64_t __cgsme_neigh_start_cycles = cgsme_now_cycles();
-#endif
-
-	uint16_t northMask, eastMask, southMask, westMask;
+	return PROPAGATION_MASKS[propagationRow(gridLayer[y - 1][x])][2] & // we are its south neighbour
+		   PROPAGATION_MASKS[propagationRow(gridLayer[y][x + 1])][3] &
+		   PROPAGATION_MASKS[propagationRow(gridLayer[y + 1][x])][0] &
+		   PROPAGATION_MASKS[propagationRow(gridLayer[y][x - 1])][1];
+}
 
-	switch (gridLayer[y][x])
-	{
-	case Empty_Tile:
-		northMask = North_Closed_Mask;
-		eastMask = East_Closed_Mask;
-		southMask = South_Closed_Mask;
-		westMask = West_Closed_Mask;
-		break;
-	case Normal_X_Corridor:
-	case Special_X_Corridor:
-		northMask = North_Open_Mask;
-		eastMask = East_Open_Mask;
-		southMask = South_Open_Mask;
-		westMask = West_Open_Mask;
-		break;
-	case North_East_Corridor:
-		northMask = North_Open_Mask;
-		eastMask = East_Open_Mask;
-		southMask = South_Closed_Mask;
-		westMask = West_Closed_Mask;
-		break;
-	case South_East_Corridor:
-		northMask = North_Closed_Mask;
-		eastMask = East_Open_Mask;
-		southMask = South_Open_Mask;
-		westMask = West_Closed_Mask;
-		break;
-	case South_West_Corridor:
-		northMask = North_Closed_Mask;
-		eastMask = East_Closed_Mask;
-		southMask = South_Open_Mask;
-		westMask = West_Open_Mask;
-		break;
-	case North_West_Corridor:
-		northMask = North_Open_Mask;
-		eastMask = East_Closed_Mask;
-		southMask = South_Closed_Mask;
-		westMask = West_Open_Mask;
-		break;
-	case North_South_Corridor:
-		northMask = North_Open_Mask;
-		eastMask = East_Closed_Mask;
-		southMask = South_Open_Mask;
-		westMask = West_Closed_Mask;
-		break;
-	case West_East_Corridor:
-		northMask = North_Closed_Mask;
-		eastMask = East_Open_Mask;
-		southMask = South_Closed_Mask;
-		westMask = West_Open_Mask;
-		break;
-	case North_T_Corridor:
-		northMask = North_Open_Mask;
-		eastMask = East_Open_Mask;
-		southMask = South_Closed_Mask;
-		westMask = West_Open_Mask;
-		break;
-	case East_T_Corridor:
-		northMask = North_Open_Mask;
-		eastMask = East_Open_Mask;
-		southMask = South_Open_Mask;
-		westMask = West_Closed_Mask;
-		break;
-	case South_T_Corridor:
-		northMask = North_Closed_Mask;
-		eastMask = East_Open_Mask;
-		southMask = South_Open_Mask;
-		westMask = West_Open_Mask;
-		break;
-	case West_T_Corridor:
-		northMask = North_Open_Mask;
-		eastMask = East_Closed_Mask;
-		southMask = South_Open_Mask;
-		westMask = West_Open_Mask;
-		break;
-	case North_DeadEnd:
-		northMask = North_Open_Mask;
-		eastMask = East_Closed_Mask;
-		southMask = South_Closed_Mask;
-		westMask = West_Closed_Mask;
-		break;
-	case East_DeadEnd:
-		northMask = North_Closed_Mask;
-		eastMask = East_Open_Mask;
-		southMask = South_Closed_Mask;
-		westMask = West_Closed_Mask;
-		break;
-	case South_DeadEnd:
-		northMask = North_Closed_Mask;
-		eastMask = East_Closed_Mask;
-		southMask = South_Open_Mask;
-		westMask = West_Closed_Mask;
-		break;
-	case West_DeadEnd:
-		northMask = North_Closed_Mask;
-		eastMask = East_Closed_Mask;
-		southMask = South_Closed_Mask;
-		westMask = West_Open_Mask;
-		break;
-	default:
-		northMask = (uint16_t)-1;
-		eastMask = (uint16_t)-1;
-		southMask = (uint16_t)-1;
-		westMask = (uint16_t)-1;
-		break;
-	}
+// narrow one neighbour with `mask`. no bounds checks: the ring is void, so it never passes
+// the superposition test.
+static inline void constrainNeighbour(uint16_t **gridLayer, uint32_t width, int32_t x, int32_t y, uint16_t mask, EntropyQueue *queue, float **distMap, CgsmeRng *rng, CellStack *forced)
+{
+	uint16_t oldVal = gridLayer[y][x];
+	if (__builtin_popcount(oldVal) <= 1)
+		return;
 
-	// apply masks & check changes
-	// ONLY access Heap if heap != NULL (allows to use this function in cleanup phases too)
+	gridLayer[y][x] = oldVal & mask;
 
-	// WEST (x-1)
-	if ((int32_t)x - 1 >= 0 && __builtin_popcount(gridLayer[y][x - 1]) > 1)
-	{
-		uint16_t oldVal = gridLayer[y][x - 1];
-		gridLayer[y][x - 1] &= westMask;
+	// REVIVAL CHECK: If it became 0, it was a contradiction. Reset it.
+	if (gridLayer[y][x] == 0)
+		gridLayer[y][x] = revivedState(gridLayer, x, y);
 
-		// REVIVAL CHECK: If it became 0, it was a contradiction. Reset it.
-		if (gridLayer[y][x - 1] == 0)
-			gridLayer[y][x - 1] = All_Possible_State;
+	// forced to a single tile (e.g. a dead end between voids and the ring): it will never be
+	// popped, so updateNeighbours propagates it before returning
+	if (forced && __builtin_popcount(gridLayer[y][x]) == 1)
+		forced->cells[forced->count++] = (uint32_t)y * width + (uint32_t)x;
 
-		if (heap && gridLayer[y][x - 1] != oldVal)
-		{
-			heapInsertOrUpdate(heap, gridLayer, x - 1, y, distMap, rng);
-		}
-	}
-
-	// EAST (x+1)
-	if ((int32_t)x + 1 < width && __builtin_popcount(gridLayer[y][x + 1]) > 1)
-	{
-		uint16_t oldVal = gridLayer[y][x + 1];
-		gridLayer[y][x + 1] &= eastMask;
-
-		if (gridLayer[y][x + 1] == 0)
-			gridLayer[y][x + 1] = All_Possible_State;
-
-		if (heap && gridLayer[y][x + 1] != oldVal)
-		{
-			heapInsertOrUpdate(heap, gridLayer, x + 1, y, distMap, rng);
-		}
-	}
+	// ONLY access the queue if queue != NULL (allows to use this function in cleanup phases too)
+	if (queue && gridLayer[y][x] != oldVal)
+		entropyQueuePush(queue, gridLayer, (uint32_t)x, (uint32_t)y, distMap, rng);
+}
 
-	// NORTH (y-1)
-	if ((int32_t)y - 1 >= 0 && __builtin_popcount(gridLayer[y - 1][x]) > 1)
-	{
-		uint16_t oldVal = gridLayer[y - 1][x];
-		gridLayer[y - 1][x] &= northMask;
+// apply the masks of the tile at (x,y) to its four neighbours (signed, the sentinel ring sits at -1)
+static inline void constrainAround(uint16_t **gridLayer, uint32_t width, int32_t x, int32_t y, EntropyQueue *queue, float **distMap, CgsmeRng *rng, CellStack *forced)
+{
+	// masks this cell imposes on its neighbours (see PROPAGATION_MASKS in cgsme_tileset.h)
+	const uint16_t *masks = PROPAGATION_MASKS[propagationRow(gridLayer[y][x])];
+	uint16_t northMask = masks[0];
+	uint16_t eastMask = masks[1];
+	uint16_t southMask = masks[2];
+	uint16_t westMask = masks[3];
 
-		if (gridLayer[y - 1][x] == 0)
-			gridLayer[y - 1][x] = All_Possible_State;
+	// apply masks & check changes
+	constrainNeighbour(gridLayer, width, x - 1, y, westMask, queue, distMap, rng, forced);  // WEST (x-1)
+	constrainNeighbour(gridLayer, width, x + 1, y, eastMask, queue, distMap, rng, forced);  // EAST (x+1)
+	constrainNeighbour(gridLayer, width, x, y - 1, northMask, queue, distMap, rng, forced); // NORTH (y-1)
+	constrainNeighbour(gridLayer, width, x, y + 1, southMask, queue, distMap, rng, forced); // SOUTH (y+1)
+}
 
-		if (heap && gridLayer[y - 1][x] != oldVal)
-		{
-			heapInsertOrUpdate(heap, gridLayer, x, y - 1, distMap, rng);
-		}
-	}
+void updateNeighbours(uint16_t **gridLayer, uint32_t width, uint32_t length, uint32_t x, uint32_t y, EntropyQueue *queue, float **distMap, CgsmeRng *rng, CellStack *forced)
+{
+	CGSME_PROFILE_FUNC();
+	(void)length;
+	constrainAround(gridLayer, width, (int32_t)x, (int32_t)y, queue, distMap, rng, forced);
 
-	// SOUTH (y+1)
-	if ((int32_t)y + 1 < length && __builtin_popcount(gridLayer[y + 1][x]) > 1)
+	// then every tile forced on the way. a worklist, not recursion: a chain of forced tiles
+	// (a long corridor between voids) can be as long as the layer is big. a tile is forced at
+	// most once (it is never narrowed again), so the stack never holds more than the layer.
+	while (forced && forced->count)
 	{
-		uint16_t oldVal = gridLayer[y + 1][x];
-		gridLayer[y + 1][x] &= southMask;
-
-		if (gridLayer[y + 1][x] == 0)
-			gridLayer[y + 1][x] = All_Possible_State;
-
-		if (heap && gridLayer[y + 1][x] != oldVal)
-		{
-			heapInsertOrUpdate(heap, gridLayer, x, y + 1, distMap, rng);
-		}
+		uint32_t cell = forced->cells[--forced->count];
+		constrainAround(gridLayer, width, (int32_t)(cell % width), (int32_t)(cell / width), queue, distMap, rng, forced);
 	}
+}
 
-#ifdef cgsme_DEBUG
-	if (cgsme_get_enabled())
-	{
-		uint64_t __cgsme_neigh_end = cgsme_now_us();
-		uint64_t __cgsme_neigh_end_cycles = cgsme_now_cycles();
-		cgsme_profile_record("updateNeighbours", (unsigned long long)(__cgsme_neigh_end - __cgsme_neigh_start),
-							 (unsigned long long)(__cgsme_neigh_end_cycles - __cgsme_neigh_start_cycles));
-	}
-#endif
+void constrainFromNeighbours(uint16_t **gridLayer, uint32_t x, uint32_t y)
+{
+	uint16_t allowed = revivedState(gridLayer, (int32_t)x, (int32_t)y);
+	uint16_t narrowed = gridLayer[y][x] & allowed;
+	gridLayer[y][x] = narrowed ? narrowed : allowed;
 }
 
 // The scoring logic extracted to a helper
-float calculateScore(uint16_t **grid, uint32_t x, uint32_t y, float **distMap, uint32_t *rng)
+float calculateScore(uint16_t **grid, uint32_t x, uint32_t y, float **distMap, CgsmeRng *rng)
 {
 	CGSME_PROFILE_FUNC();
 	uint32_t bitNum = __builtin_popcount(grid[y][x]);
@@ -375,156 +204,56 @@ float calculateScore(uint16_t **grid, uint32_t x, uint32_t y, float **distMap, u
 	float score = (float)bitNum;
 
 	// Tiny random noise to break ties
-	float noise = ((float)nextRandom(rng) / 4294967296.0f) * 0.01f;
+	float noise = cgsme_rng_float01_fast(rng) * 0.01f;
 	return score + noise;
 }
 
-// Finds the best spot to start a new island (Closest to center that is still unvisited)
-bool findBestSeedLocation(uint16_t **grid, uint32_t width, uint32_t length, float **distMap, uint32_t *outX, uint32_t *outY, uint32_t *rng)
+// findBestSeedLocation draws random cells while at least 1 in SEED_DENSE_RATIO cells is indexed
+#define SEED_DENSE_RATIO 64
+
+// Finds a spot to start a new island: a random unsolved tile inside the mask, every one
+// equally likely. `open` holds every tile that was uncollapsed when it was indexed; tiles
+// only ever leave that state (revival resets tiles that are still uncollapsed), so entries
+// that were solved in the meantime are dropped here the first time they are met.
+bool findBestSeedLocation(uint16_t **grid, uint32_t width, uint32_t length, CellIndex *open, uint32_t *outX, uint32_t *outY, CgsmeRng *rng)
 {
 	CGSME_PROFILE_FUNC();
-	float minScore = 1e9;
-	bool found = false;
-
-	for (uint32_t i = 0; i < length; i++)
+	(void)length;
+
+	// random cells while the index is dense (about 4 expected hits), a hit is uniform over the
+	// open tiles and stale entries met on the way are dropped
+	uint32_t tries = 0;
+	if ((uint64_t)open->count * SEED_DENSE_RATIO >= open->cellCount)
+		tries = 4 * (open->cellCount / open->count + 1);
+	for (uint32_t i = 0; i < tries && open->count > 0; i++)
 	{
-		for (uint32_t j = 0; j < width; j++)
+		uint32_t cell = cgsme_rng_bounded(rng, open->cellCount);
+		if (!cellIndexHas(open, cell))
+			continue;
+		uint32_t x = cell % width;
+		uint32_t y = cell / width;
+		if (__builtin_popcount(grid[y][x]) > 1)
 		{
-			uint16_t tile = grid[i][j];
-
-			// Skip Empty (void) tiles
-			if (tile == Empty_Tile)
-				continue;
-
-			int popcount = __builtin_popcount(tile);
-
-			// Skip already-collapsed tiles
-			if (popcount == 1)
-				continue;
-
-			// CRITICAL FIX: If popcount is 0, this tile hit a contradiction.
-			// Reset it AND immediately apply neighbor constraints.
-			if (popcount == 0)
-			{
-				grid[i][j] = All_Possible_State;
-
-				// Apply constraints from all collapsed neighbors
-				// Use the same logic as updateNeighbours but in reverse
-
-				// Check North neighbor (y-1, which is i-1)
-				// If neighbor is collapsed, what mask should it have applied to us?
-				if (i > 0)
-				{
-					uint16_t neighbor = grid[i - 1][j];
-					if (neighbor == Empty_Tile)
-					{
-						// Void neighbor = we must close that direction
-						grid[i][j] &= North_Closed_Mask;
-					}
-					else if (__builtin_popcount(neighbor) == 1)
-					{
-						// Get what mask this neighbor would apply to its South (us)
-						// If neighbor opens South -> we need North_Open_Mask
-						// If neighbor closes South -> we need North_Closed_Mask
-						if (neighbor & North_Open_Mask) // neighbor has south opening
-							grid[i][j] &= South_Open_Mask;
-						else
-							grid[i][j] &= South_Closed_Mask;
-					}
-				}
-
-				// Check South neighbor (y+1, which is i+1)
-				if (i < length - 1)
-				{
-					uint16_t neighbor = grid[i + 1][j];
-					if (neighbor == Empty_Tile)
-					{
-						grid[i][j] &= South_Closed_Mask;
-					}
-					else if (__builtin_popcount(neighbor) == 1)
-					{
-						if (neighbor & South_Open_Mask) // neighbor has north opening
-							grid[i][j] &= North_Open_Mask;
-						else
-							grid[i][j] &= North_Closed_Mask;
-					}
-				}
-
-				// Check West neighbor (x-1, which is j-1)
-				if (j > 0)
-				{
-					uint16_t neighbor = grid[i][j - 1];
-					if (neighbor == Empty_Tile)
-					{
-						grid[i][j] &= West_Closed_Mask;
-					}
-					else if (__builtin_popcount(neighbor) == 1)
-					{
-						if (neighbor & West_Open_Mask) // neighbor has east opening
-							grid[i][j] &= East_Open_Mask;
-						else
-							grid[i][j] &= East_Closed_Mask;
-					}
-				}
-
-				// Check East neighbor (x+1, which is j+1)
-				if (j < width - 1)
-				{
-					uint16_t neighbor = grid[i][j + 1];
-					if (neighbor == Empty_Tile)
-					{
-						grid[i][j] &= East_Closed_Mask;
-					}
-					else if (__builtin_popcount(neighbor) == 1)
-					{
-						if (neighbor & East_Open_Mask) // neighbor has west opening
-							grid[i][j] &= West_Open_Mask;
-						else
-							grid[i][j] &= West_Closed_Mask;
-					}
-				}
-
-				// After applying constraints, check if still valid
-				popcount = __builtin_popcount(grid[i][j]);
-				if (popcount == 0)
-				{
-					// Still contradicted after applying constraints!
-					// This is a valid masked tile that MUST be filled.
-					// Force it to All_Possible_State and return it as a seed.
-					// The main loop will collapse it, which might create a connection issue
-					// that germanWelder will fix later.
-					grid[i][j] = All_Possible_State;
-					*outX = j;
-					*outY = i;
-					return true;
-				}
-				if (popcount == 1)
-				{
-					// Auto-collapsed to a single valid tile!
-					// This is actually a GOOD candidate - return it so the main loop
-					// can call updateNeighbours and count it properly.
-					*outX = j;
-					*outY = i;
-					return true;
-				}
-			}
-
-			// Valid candidate (popcount > 1)
-			// Use only random noise for seed selection - no distance preference
-			// This ensures isolated mask regions get seeded regardless of location
-			float noise = (float)(((i * width + j) ^ nextRandom(rng)) & 0xFFFF) * 0.001f;
-
-			if (noise < minScore)
-			{
-				minScore = noise;
-				*outX = j;
-				*outY = i;
-				found = true;
-			}
+			*outX = x;
+			*outY = y;
+			return true;
 		}
+		cellIndexClear(open, cell);
 	}
 
-	return found;
+	// sparse index: drop every stale entry in one pass, then a random rank among the rest
+	// (summary popcounts)
+	uint32_t cell = 0;
+	for (uint32_t from = 0; from < open->cellCount && cellIndexNext(open, from, &cell) && cell >= from; from = cell + 1)
+		if (__builtin_popcount(grid[cell / width][cell % width]) <= 1)
+			cellIndexClear(open, cell);
+	if (open->count == 0)
+		return false;
+
+	cell = cellIndexSelect(open, cgsme_rng_bounded(rng, open->count));
+	*outX = cell % width;
+	*outY = cell / width;
+	return true;
 }
 
 void update_spawnrates(float rates[], int current_collapsed, int target_collapsed)
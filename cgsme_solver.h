@@ -5,6 +5,7 @@
 #include "threadRandom.h"
 #include "cgsme_utils.h"
 #include "tiles.h"
+#include "cgsme_tileset.h"
 
 // gauss config
 
@@ -32,13 +33,13 @@ static const float CONNECTOR_BOOST = 2.5f; // nice amount of twists
 ///     - Chooses one of the currently-valid bits according to the provided
 ///       category weights. If the sum of weights for valid options is effectively
 ///       zero, the function falls back to uniform random selection among set bits.
-///     - Uses `nextRandom(rng)` as the RNG source.
+///     - Uses the solver stream `rng` (`cgsme_rng_bounded_fast` / `cgsme_rng_float01_fast`).
 ///
 /// Notes / Safety:
 ///     - Expects `rates` to point to at least `NUM_TILE_TYPES` floats.
 ///     - Handles empty masks safely (no-op when *tile == 0).
 ///     - See `BIT_TO_CATEGORY` for how bits map to categories used by `rates`.
-void collapseTile(uint16_t *tile, float *rates, uint32_t *rng);
+void collapseTile(uint16_t *tile, float *rates, CgsmeRng *rng);
 
 /// Update neighbors' possible states by constraining them to match the tile at (x,y).
 ///
@@ -47,23 +48,44 @@ void collapseTile(uint16_t *tile, float *rates, uint32_t *rng);
 ///     width     - width of the grid (number of columns).
 ///     length    - length of the grid (number of rows).
 ///     x, y      - coordinates of the tile whose neighbors will be updated.
+///     queue     - changed neighbors are pushed here (NULL: nothing is queued).
+///     forced    - scratch for neighbors forced down to a single tile, room for
+///                 width * length cells (NULL: forced tiles are not propagated).
 ///
 /// Behavior / Notes:
-///     - Selects directional masks (northMask, eastMask, southMask, westMask)
-///       based on the value of `gridLayer[y][x]` (see `tiles.h` masks such as
-///       `North_Closed_Mask`, `North_Open_Mask`, etc.).
+///     - Looks up the directional masks (northMask, eastMask, southMask, westMask)
+///       for the value of `gridLayer[y][x]` in `PROPAGATION_MASKS`
+///       (cgsme_tileset.h, built from the tileset description).
 ///     - Applies each mask to the corresponding neighbor using bitwise AND:
 ///         neighbor &= <mask>;
-///       but only when the neighbor is inside the grid bounds and not already
-///       collapsed (i.e. __builtin_popcount(neighbor) != 1).
+///       but only when the neighbor is still in superposition
+///       (i.e. __builtin_popcount(neighbor) > 1).
+///     - A neighbor left with no option is revived with every tile its four
+///       neighbors allow (collapsed tiles, voids and the ring), like
+///       constrainFromNeighbours.
+///     - A neighbor forced down to a single tile will never be popped, so its
+///       own masks are applied before returning, and so on down the chain
+///       (a worklist on `forced`, no recursion). `forced` is empty again on return.
 ///     - For unrecognized tile values the function uses a full-mask (no restriction).
 ///     - Mutates `gridLayer` in-place.
 ///
 /// Safety:
-///     - Does bounds checks before touching neighbors.
+///     - `gridLayer` must be a padded layer (see allocPaddedLayer) with a void
+///       ring; there are no bounds checks, the ring is never in superposition.
 ///     - Expects `gridLayer[y][x]` to be a valid tile value from the known set,
 ///       but tolerates other values by applying no restriction (full-mask).
-void updateNeighbours(uint16_t **gridLayer, uint32_t width, uint32_t length, uint32_t x, uint32_t y, MinHeap *heap, float **distMap, uint32_t *rng);
+void updateNeighbours(uint16_t **gridLayer, uint32_t width, uint32_t length, uint32_t x, uint32_t y, EntropyQueue *queue, float **distMap, CgsmeRng *rng, CellStack *forced);
+
+/// Narrow the tile at (x,y) to what its four neighbours allow (the pull form of
+/// updateNeighbours, used by the wavefront scheduler).
+///
+/// Behavior / Notes:
+///     - Only reads the neighbours and only writes (x,y), so tiles that are not
+///       4-neighbours of each other can be narrowed concurrently.
+///     - A contradiction restarts the tile from what the neighbours allow, like
+///       the revival in updateNeighbours (Empty_Tile if every side is closed).
+///     - Expects a tile still in superposition on a padded layer (see allocPaddedLayer).
+void constrainFromNeighbours(uint16_t **gridLayer, uint32_t x, uint32_t y);
 
 /// Recalculate tile spawn rates using a Gaussian model and connector boost.
 ///
@@ -91,10 +113,11 @@ void update_spawnrates(float rates[], int current_collapsed, int target_collapse
 ///     - Constructs directional masks (north/east/south/west) based on the
 ///       presence of collapsed neighbors and applies them to the tile via
 ///       bitwise AND to reduce the set of valid variants.
+///     - `gridLayer` must be a padded layer (see allocPaddedLayer).
 void updateTileEntropy(uint16_t **gridLayer, uint32_t width, uint32_t length, uint32_t x, uint32_t y);
 
 /// @brief Check if a tile is required (has any valid neighbor connections).
-/// @param grid Pointer to the grid layer.
+/// @param grid Pointer to the padded grid layer (see allocPaddedLayer).
 /// @param width Grid width.
 /// @param length Grid length.
 /// @param x X coordinate.
@@ -102,16 +125,16 @@ void updateTileEntropy(uint16_t **gridLayer, uint32_t width, uint32_t length, ui
 /// @return true if tile is required, false otherwise.
 bool isTileRequired(uint16_t **grid, uint32_t width, uint32_t length, uint32_t x, uint32_t y);
 
-/// @brief Find the best seed location for next collapse using distance map.
+/// @brief Pick a random uncollapsed tile (uniformly) to reseed from once the queue ran dry.
 /// @param grid Pointer to the grid layer.
 /// @param width Grid width.
 /// @param length Grid length.
-/// @param distMap Distance map.
+/// @param open Index of uncollapsed in-mask tiles (stale entries are removed while searching).
 /// @param outX Output X coordinate.
 /// @param outY Output Y coordinate.
 /// @param rng Pointer to random state.
 /// @return true if a valid location was found, false otherwise.
-bool findBestSeedLocation(uint16_t **grid, uint32_t width, uint32_t length, float **distMap, uint32_t *outX, uint32_t *outY, uint32_t *rng);
+bool findBestSeedLocation(uint16_t **grid, uint32_t width, uint32_t length, CellIndex *open, uint32_t *outX, uint32_t *outY, CgsmeRng *rng);
 
 /// @brief Calculate the score for a tile based on entropy, distance, and noise.
 /// @param grid Pointer to the grid layer.
@@ -120,16 +143,7 @@ bool findBestSeedLocation(uint16_t **grid, uint32_t width, uint32_t length, floa
 /// @param distMap Distance map.
 /// @param rng Pointer to random state.
 /// @return Calculated score.
-float calculateScore(uint16_t **grid, uint32_t x, uint32_t y, float **distMap, uint32_t *rng);
-
-// 0: X, 1: T, 2: L, 3: I, 4: D
-static const int BIT_TO_CATEGORY[16] = {
-	2, 2, 2, 2, // Bits 0-3:   L Corners      (Index 2)
-	3, 3,		// Bits 4-5:   I Straights    (Index 3)
-	1, 1, 1, 1, // Bits 6-9:   T Junctions    (Index 1)
-	0, 5,		// Bit 10: Normal X (Cat 0), Bit 11: Special X (Cat 5)
-	4, 4, 4, 4	// Bits 12-15: Dead Ends      (Index 4)
-};
+float calculateScore(uint16_t **grid, uint32_t x, uint32_t y, float **distMap, CgsmeRng *rng);
 
 // position of each tile type on the probability curve:
 //  0 (X), 1 (T), 2 (L), 3 (I), 4 (D)
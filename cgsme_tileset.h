@@ -0,0 +1,120 @@
+#ifndef CGSME_TILESET_H
+#define CGSME_TILESET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "tiles.h"
+
+/*
+	THE TILESET
+
+	one description of every tile. all lookup tables the solver and the welder use
+	(ports, propagation masks, ports <-> tile, spawn categories) are expanded from this
+	list by the preprocessor, so they are built at compile time on every target and there
+	is no generator tool to run when cross compiling.
+
+	X(arg, name, index, N, E, S, W, category, canonical)
+		name      tile define from tiles.h
+		index     bit of the tile inside a cell (name == 1 << index)
+		N E S W   1 if the tile has a port in that direction
+		category  spawn curve category (0: X, 1: T, 2: L, 3: I, 4: D, 5: special X)
+		canonical 1 if this tile is picked when a tile is rebuilt from its ports
+		          (Special X shares its ports with Normal X)
+*/
+#define CGSME_TILESET(X, arg)                           \
+	X(arg, North_East_Corridor, 0, 1, 1, 0, 0, 2, 1)    \
+	X(arg, South_East_Corridor, 1, 0, 1, 1, 0, 2, 1)    \
+	X(arg, South_West_Corridor, 2, 0, 0, 1, 1, 2, 1)    \
+	X(arg, North_West_Corridor, 3, 1, 0, 0, 1, 2, 1)    \
+	X(arg, North_South_Corridor, 4, 1, 0, 1, 0, 3, 1)   \
+	X(arg, West_East_Corridor, 5, 0, 1, 0, 1, 3, 1)     \
+	X(arg, North_T_Corridor, 6, 1, 1, 0, 1, 1, 1)       \
+	X(arg, East_T_Corridor, 7, 1, 1, 1, 0, 1, 1)        \
+	X(arg, South_T_Corridor, 8, 0, 1, 1, 1, 1, 1)       \
+	X(arg, West_T_Corridor, 9, 1, 0, 1, 1, 1, 1)        \
+	X(arg, Normal_X_Corridor, 10, 1, 1, 1, 1, 0, 1)     \
+	X(arg, Special_X_Corridor, 11, 1, 1, 1, 1, 5, 0)    \
+	X(arg, North_DeadEnd, 12, 1, 0, 0, 0, 4, 1)         \
+	X(arg, East_DeadEnd, 13, 0, 1, 0, 0, 4, 1)          \
+	X(arg, South_DeadEnd, 14, 0, 0, 1, 0, 4, 1)         \
+	X(arg, West_DeadEnd, 15, 0, 0, 0, 1, 4, 1)
+
+#define CGSME_PORTS(n, e, s, w) ((n) * DIR_N | (e) * DIR_E | (s) * DIR_S | (w) * DIR_W)
+
+// expanders (one table entry per tile)
+#define CGSME_X_PORTS(arg, name, idx, n, e, s, w, cat, canon) [idx] = CGSME_PORTS(n, e, s, w),
+#define CGSME_X_CATEGORY(arg, name, idx, n, e, s, w, cat, canon) [idx] = cat,
+#define CGSME_X_CHECK(arg, name, idx, n, e, s, w, cat, canon) \
+	_Static_assert((name) == (1u << (idx)), "tileset index of " #name " does not match tiles.h");
+
+// reducers (OR over all tiles matching `arg`)
+#define CGSME_X_HAS_PORT(arg, name, idx, n, e, s, w, cat, canon) | ((CGSME_PORTS(n, e, s, w) & (arg)) ? (1u << (idx)) : 0u)
+#define CGSME_X_FROM_PORTS(arg, name, idx, n, e, s, w, cat, canon) | (((canon) && CGSME_PORTS(n, e, s, w) == (arg)) ? (1u << (idx)) : 0u)
+
+// every tile with a port towards `dir` (DIR_N/E/S/W)
+#define CGSME_TILES_WITH_PORT(dir) ((uint16_t)(0u CGSME_TILESET(CGSME_X_HAS_PORT, dir)))
+
+// canonical tile for a port combination (Empty_Tile for none)
+#define CGSME_TILE_FROM_PORTS(ports) ((uint16_t)(0u CGSME_TILESET(CGSME_X_FROM_PORTS, ports)))
+
+CGSME_TILESET(CGSME_X_CHECK, 0)
+
+// the hand written masks in tiles.h must agree with the tileset
+// (X_Open_Mask = what the neighbour in direction X may be = tiles with a port back to us)
+_Static_assert(North_Open_Mask == CGSME_TILES_WITH_PORT(DIR_S), "North_Open_Mask does not match the tileset");
+_Static_assert(East_Open_Mask == CGSME_TILES_WITH_PORT(DIR_W), "East_Open_Mask does not match the tileset");
+_Static_assert(South_Open_Mask == CGSME_TILES_WITH_PORT(DIR_N), "South_Open_Mask does not match the tileset");
+_Static_assert(West_Open_Mask == CGSME_TILES_WITH_PORT(DIR_E), "West_Open_Mask does not match the tileset");
+
+// tile index -> ports (DIR_ flags)
+static const uint8_t TILE_PORTS[16] = {CGSME_TILESET(CGSME_X_PORTS, 0)};
+
+// ports -> canonical tile mask
+static const uint16_t PORTS_TO_TILE[16] = {
+	CGSME_TILE_FROM_PORTS(0), CGSME_TILE_FROM_PORTS(1), CGSME_TILE_FROM_PORTS(2), CGSME_TILE_FROM_PORTS(3),
+	CGSME_TILE_FROM_PORTS(4), CGSME_TILE_FROM_PORTS(5), CGSME_TILE_FROM_PORTS(6), CGSME_TILE_FROM_PORTS(7),
+	CGSME_TILE_FROM_PORTS(8), CGSME_TILE_FROM_PORTS(9), CGSME_TILE_FROM_PORTS(10), CGSME_TILE_FROM_PORTS(11),
+	CGSME_TILE_FROM_PORTS(12), CGSME_TILE_FROM_PORTS(13), CGSME_TILE_FROM_PORTS(14), CGSME_TILE_FROM_PORTS(15)};
+
+// 0: X, 1: T, 2: L, 3: I, 4: D, 5: special X
+static const int BIT_TO_CATEGORY[16] = {CGSME_TILESET(CGSME_X_CATEGORY, 0)};
+
+// PROPAGATION
+// masks a cell applies to its neighbours, order N E S W. rows 0-15 are the collapsed tiles,
+// PROPAGATION_VOID a void cell (closes everything), PROPAGATION_OPEN a cell still in
+// superposition (restricts nothing).
+#define PROPAGATION_VOID 16
+#define PROPAGATION_OPEN 17
+
+#define CGSME_X_PROPAGATION(arg, name, idx, n, e, s, w, cat, canon) \
+	[idx] = {(n) ? North_Open_Mask : North_Closed_Mask,             \
+			 (e) ? East_Open_Mask : East_Closed_Mask,               \
+			 (s) ? South_Open_Mask : South_Closed_Mask,             \
+			 (w) ? West_Open_Mask : West_Closed_Mask},
+
+static const uint16_t PROPAGATION_MASKS[18][4] = {
+	CGSME_TILESET(CGSME_X_PROPAGATION, 0)
+	[PROPAGATION_VOID] = {North_Closed_Mask, East_Closed_Mask, South_Closed_Mask, West_Closed_Mask},
+	[PROPAGATION_OPEN] = {All_Possible_State, All_Possible_State, All_Possible_State, All_Possible_State},
+};
+
+// row of PROPAGATION_MASKS for a cell value (selects, no branches on the tile type)
+static inline uint32_t propagationRow(uint16_t tile)
+{
+	uint32_t row = tile ? (uint32_t)__builtin_ctz(tile) : PROPAGATION_VOID;
+	return (tile & (tile - 1)) ? PROPAGATION_OPEN : row;
+}
+
+// most open tile a cell state still allows (Empty_Tile for none). every propagation mask
+// only says "port" / "no port" per direction, so the union of the ports of a state is itself
+// allowed: a forced seed opens towards everything that can take it and never towards void.
+static inline uint16_t widestTile(uint16_t state)
+{
+	uint8_t ports = ((state & CGSME_TILES_WITH_PORT(DIR_N)) ? DIR_N : 0) |
+					((state & CGSME_TILES_WITH_PORT(DIR_E)) ? DIR_E : 0) |
+					((state & CGSME_TILES_WITH_PORT(DIR_S)) ? DIR_S : 0) |
+					((state & CGSME_TILES_WITH_PORT(DIR_W)) ? DIR_W : 0);
+	return PORTS_TO_TILE[ports];
+}
+
+#endif // CGSME_TILESET_H
@@ -1,339 +1,349 @@
 #include "cgsme_topology.h"
+#include <string.h>
 #include "tiles.h"
+#include "cgsme_tileset.h"
 #include "cgsme_utils.h"
+#include "cgsme_reach.h"
 #include "threadRandom.h"
 
-// welding logic using union find data structure
-// --- Union-Find Helper Functions ---
-UnionFind *createUnionFind(uint32_t size)
+// add the port towards `directionFlag` to a collapsed tile (Special X becomes Normal X,
+// the canonical tile for its ports)
+static inline void openWall(uint16_t **grid, uint32_t x, uint32_t y, uint8_t directionFlag)
 {
-	CGSME_PROFILE_FUNC();
-	UnionFind *uf = malloc(sizeof(UnionFind));
-	uf->count = size;
-	uf->parent = malloc(sizeof(uint16_t) * (size + 1));
-	for (uint32_t i = 0; i <= size; i++)
-		uf->parent[i] = i;
-	return uf;
+	uint16_t tile = grid[y][x];
+	grid[y][x] = PORTS_TO_TILE[TILE_PORTS[__builtin_ctz(tile)] | directionFlag];
 }
 
-uint16_t findSet(UnionFind *uf, uint16_t i)
+// slot of a region pair in the open addressing table (tableMask + 1 is a power of two)
+static inline uint32_t bridgeSlot(uint32_t lo, uint32_t hi, uint32_t tableMask)
 {
-	CGSME_PROFILE_FUNC();
-	if (uf->parent[i] == i)
-		return i;
-	uf->parent[i] = findSet(uf, uf->parent[i]); // Path compression
-	return uf->parent[i];
+	uint64_t key = ((uint64_t)lo << 32) | hi;
+	return (uint32_t)((key * 0x9E3779B97F4A7C15ULL) >> 32) & tableMask;
 }
 
-void unionSets(UnionFind *uf, uint16_t i, uint16_t j)
+// keep the candidate if it is the first or the lowest priority bridge of its pair.
+// returns false if the pair is new (the caller counts the pairs).
+static inline bool offerBridge(Bridge *table, uint32_t tableMask, Bridge candidate)
 {
-	CGSME_PROFILE_FUNC();
-	uint16_t root_i = findSet(uf, i);
-	uint16_t root_j = findSet(uf, j);
-	if (root_i != root_j)
+	uint32_t slot = bridgeSlot(candidate.regionA, candidate.regionB, tableMask);
+	while (table[slot].regionA != 0)
 	{
-		uf->parent[root_i] = root_j;
+		if (table[slot].regionA == candidate.regionA && table[slot].regionB == candidate.regionB)
+		{
+			if (candidate.priority < table[slot].priority)
+				table[slot] = candidate;
+			return true;
+		}
+		slot = (slot + 1) & tableMask;
 	}
+	table[slot] = candidate;
+	return false;
 }
 
-void destroyUnionFind(UnionFind *uf)
+// table with room for `capacity` pairs at half load, NULL if the arena is out of memory
+static Bridge *allocBridgeTable(uint32_t capacity, uint32_t *tableMask, CgsmeArena *arena)
 {
-	CGSME_PROFILE_FUNC();
-	free(uf->parent);
-	free(uf);
+	uint32_t slots = 16;
+	while (slots < capacity * 2 && slots < (1u << 31))
+		slots <<= 1;
+	*tableMask = slots - 1;
+	return arenaCalloc(arena, slots, sizeof(Bridge));
 }
 
-void germanWelderInPlace(uint16_t **grid, uint32_t width, uint32_t length, uint32_t *rng)
+void germanWelderInPlace(uint16_t **grid, uint32_t **labels, uint32_t regionCount, uint32_t width, uint32_t length, CgsmeRng *rng, CgsmeArena *arena)
 {
 	CGSME_PROFILE_FUNC();
-	// find max Region ID (scan packed data)
-	// check the upper 12 bits of every cell.
-	uint16_t maxRegionID = 0;
-	for (uint32_t i = 0; i < length; i++)
-	{
-		for (uint32_t j = 0; j < width; j++)
-		{
-			if (grid[i][j] == 0xFFFF)
-				continue; // skip void
-			uint16_t r = grid[i][j] >> 4;
-			if (r > maxRegionID)
-				maxRegionID = r;
-		}
-	}
-
-	if (maxRegionID <= 1)
+	if (regionCount <= 1)
 		return; // only 1 region exists, nothing to weld.
 
-	// collect bridges
-	// allocating upfront is faster. Max theoretical edges ~ width*length*2
-	uint32_t maxBridges = width * length * 2;
-	Bridge *bridges = malloc(sizeof(Bridge) * maxBridges);
-	uint32_t count = 0;
+	// COLLECT BRIDGES (one per region pair)
+	// every boundary edge draws a random priority and only the lowest one of each pair is
+	// kept. kruskal over the pairs sorted by that priority picks the same spanning tree (in
+	// distribution) as kruskal over a full shuffle of every boundary edge: a pair is first
+	// reached at its lowest edge, and that edge is uniform among the pair's edges.
+	// region graphs are planar (about 2-3 pairs per region), the table grows if needed.
+	ArenaMark mark = arenaGetMark(arena);
+	uint32_t tableMask;
+	Bridge *table = allocBridgeTable(regionCount, &tableMask, arena);
+	if (!table)
+		return;
+	uint32_t pairs = 0;
 
 	for (uint32_t y = 0; y < length; y++)
 	{
 		for (uint32_t x = 0; x < width; x++)
 		{
+			uint32_t rA = labels[y][x];
+			if (rA == 0)
+				continue; // skip void
 
-			if (grid[y][x] == 0xFFFF)
-				continue;
-
-			uint16_t rA = grid[y][x] >> 4; // extract region A
-
-			// check EAST (x+1)
-			if (x < width - 1 && grid[y][x + 1] != 0xFFFF)
+			// EAST (x+1) and SOUTH (y+1), the ring is void (label 0)
+			for (uint32_t south = 0; south < 2; south++)
 			{
-				uint16_t rB = grid[y][x + 1] >> 4; // extract region B
-				if (rA != rB)
-				{
-					bridges[count].regionA = rA;
-					bridges[count].regionB = rB;
-					bridges[count].x = x;
-					bridges[count].y = y;
-					bridges[count].dir = DIR_E;
-					count++;
-				}
-			}
+				uint32_t rB = south ? labels[y + 1][x] : labels[y][x + 1];
+				if (rB == 0 || rA == rB)
+					continue;
 
-			// check SOUTH (y+1)
-			if (y < length - 1 && grid[y + 1][x] != 0xFFFF)
-			{
-				uint16_t rB = grid[y + 1][x] >> 4; // extract region B
-				if (rA != rB)
+				Bridge candidate = {rA < rB ? rA : rB, rA < rB ? rB : rA, cgsme_rng_next(rng),
+									(y * width + x) * 2 + south};
+				if (offerBridge(table, tableMask, candidate))
+					continue;
+
+				// new pair: grow once the table is half full
+				if (++pairs * 2 > tableMask + 1)
 				{
-					bridges[count].regionA = rA;
-					bridges[count].regionB = rB;
-					bridges[count].x = x;
-					bridges[count].y = y;
-					bridges[count].dir = DIR_S;
-					count++;
+					uint32_t newMask;
+					Bridge *grown = allocBridgeTable(pairs, &newMask, arena);
+					if (!grown)
+					{
+						arenaRelease(arena, mark);
+						return;
+					}
+					for (uint32_t i = 0; i <= tableMask; i++)
+						if (table[i].regionA != 0)
+							offerBridge(grown, newMask, table[i]);
+					table = grown;
+					tableMask = newMask;
 				}
 			}
 		}
 	}
 
-	if (count == 0)
+	if (pairs == 0)
 	{
-		free(bridges);
+		arenaRelease(arena, mark);
 		return;
 	}
 
-	// shuffle bridges (Fisher-Yates)
-	for (uint32_t i = 0; i < count; i++)
+	// SORT by priority (compact to the front, two 16 bit radix passes). the table is at most
+	// half full, so the back half is the scratch of the radix passes.
+	uint32_t count = 0;
+	for (uint32_t i = 0; i <= tableMask; i++)
+		if (table[i].regionA != 0)
+			table[count++] = table[i];
+
+	Bridge *sorted = table + count;
+	uint32_t *hist = arenaAlloc(arena, sizeof(uint32_t) * 65536);
+	UnionFind *uf = createUnionFind(regionCount + 1, regionCount + 1, arena); // regions are 1..regionCount
+	if (!hist || !uf)
 	{
-		uint32_t swapIdx = nextRandom(rng) % count;
-		Bridge temp = bridges[i];
-		bridges[i] = bridges[swapIdx];
-		bridges[swapIdx] = temp;
+		arenaRelease(arena, mark);
+		return;
+	}
+	for (uint32_t shift = 0; shift < 32; shift += 16)
+	{
+		Bridge *from = shift ? sorted : table;
+		Bridge *to = shift ? table : sorted;
+		memset(hist, 0, sizeof(uint32_t) * 65536);
+		for (uint32_t i = 0; i < count; i++)
+			hist[(from[i].priority >> shift) & 0xFFFF]++;
+		uint32_t sum = 0;
+		for (uint32_t b = 0; b < 65536; b++)
+		{
+			uint32_t n = hist[b];
+			hist[b] = sum;
+			sum += n;
+		}
+		for (uint32_t i = 0; i < count; i++)
+			to[hist[(from[i].priority >> shift) & 0xFFFF]++] = from[i];
 	}
 
 	// kruskal's algorithm
-	UnionFind *uf = createUnionFind(maxRegionID);
-
 	for (uint32_t i = 0; i < count; i++)
 	{
-		Bridge b = bridges[i];
+		Bridge b = table[i];
 
 		// if sets are disjoint, connect them
-		if (findSet(uf, b.regionA) != findSet(uf, b.regionB))
+		if (unionSets(uf, b.regionA, b.regionB))
 		{
-			unionSets(uf, b.regionA, b.regionB);
-
-			// open wall on A
-			openWallPacked(grid, b.x, b.y, b.dir);
-
-			// open wall on B (opposite direction)
-			uint32_t nx = b.x + (b.dir == DIR_E ? 1 : 0);
-			uint32_t ny = b.y + (b.dir == DIR_S ? 1 : 0);
-			uint8_t oppositeDir = (b.dir == DIR_E) ? DIR_W : DIR_N;
+			uint32_t x = (b.cell >> 1) % width;
+			uint32_t y = (b.cell >> 1) / width;
+			bool south = b.cell & 1;
 
-			openWallPacked(grid, nx, ny, oppositeDir);
+			// open wall on A, then on B (opposite direction)
+			openWall(grid, x, y, south ? DIR_S : DIR_E);
+			openWall(grid, x + !south, y + south, south ? DIR_N : DIR_W);
 		}
 	}
 
-	destroyUnionFind(uf);
-	free(bridges);
+	arenaRelease(arena, mark);
 }
 
-// 1. COMPRESS -> 2. IDENTIFY -> 3. RETURN VOID (data is in grid)
-void findConnectedRegionsInPlace(uint16_t **grid, uint32_t width, uint32_t length)
+// a layer floods cell by cell until a region passes this many cells, that region then decides
+// for the whole layer: mostly east / west steps (mazes, rooms) go to the word-parallel floods,
+// mostly north / south steps (serpentines, columns) stay a plain BFS, the sweeps would redo
+// every row for one or two new cells per word
+#define LABEL_PROBE_CELLS 4096
+// BFS frontier ring (power of two), a frontier that outgrows it goes to the floods as well
+#define LABEL_RING_CELLS 65536
+
+// regionMarkerIterative with a ring for the frontier. while *probing, a region that passes
+// LABEL_PROBE_CELLS settles the layer (see above). returns false to hand over to the floods,
+// the region is then only partly labeled. *maxRow grows to the last row taken off the ring
+// (every finished region lies above it)
+static inline bool labelRegionBfs(uint16_t **grid, uint32_t **labels, uint32_t regionID, uint32_t startX, uint32_t startY,
+								  TopoNode *ring, uint32_t ringMask, bool *probing, uint32_t *maxRow)
 {
-	CGSME_PROFILE_FUNC();
-	// COMPRESSION
-	// turn 16-bit masks into 4-bit indices (0-15)
-	// mark EMPTY tiles as 0xFFFF
-	for (uint32_t i = 0; i < length; i++)
+	uint32_t head = 0, tail = 0, horizontal = 0, bottom = startY;
+	uint32_t probeAt = *probing ? LABEL_PROBE_CELLS : UINT32_MAX;
+	ring[tail++] = (TopoNode){startX, startY};
+	labels[startY][startX] = regionID;
+
+	while (head != tail)
 	{
-		for (uint32_t j = 0; j < width; j++)
+		TopoNode c = ring[head++ & ringMask];
+		int32_t cx = (int32_t)c.x; // signed, the void ring sits at -1
+		int32_t cy = (int32_t)c.y;
+		uint16_t mask = grid[cy][cx];
+		bottom = c.y > bottom ? c.y : bottom;
+
+		if (tail >= probeAt || tail - head + 4 > ringMask + 1)
 		{
-			if (grid[i][j] == Empty_Tile)
-			{
-				grid[i][j] = 0xFFFF;
-			}
-			else
+			if (tail - head + 4 > ringMask + 1 || horizontal * 4 >= tail)
 			{
-				// grid[i][j] = (uint16_t)maskToIndex(grid[i][j]);
-				grid[i][j] = __builtin_ctz(grid[i][j]);
+				*maxRow = bottom > *maxRow ? bottom : *maxRow;
+				return false;
 			}
+			*probing = false;
+			probeAt = UINT32_MAX;
 		}
-	}
 
-	// IDENTIFICATION
-	// any tile <= 15 is unvisited (first 12 bits are empty). assign it a Region ID
-	uint16_t regionID = 1;
-	for (uint32_t i = 0; i < length; i++)
-	{
-		for (uint32_t j = 0; j < width; j++)
+		// South_Open_Mask = tiles with a north port -> y-1
+		if ((mask & South_Open_Mask) && grid[cy - 1][cx] != Empty_Tile && labels[cy - 1][cx] == 0)
 		{
-			if (grid[i][j] != 0xFFFF && grid[i][j] <= 15)
-			{
-				// determine if we ran out of regions (Max 4095)
-				if (regionID < 4095)
-				{
-					// regionMarkerPacked(grid, width, length, regionID, j, i);
-					regionMarkerIterative(grid, width, length, regionID, j, i);
-					regionID++;
-				}
-			}
+			labels[cy - 1][cx] = regionID;
+			ring[tail++ & ringMask] = (TopoNode){(uint32_t)cx, (uint32_t)(cy - 1)};
 		}
-	}
-}
-
-// helper to modify walls inside the packed format
-void openWallPacked(uint16_t **grid, uint32_t x, uint32_t y, uint8_t directionFlag)
-{
-	CGSME_PROFILE_FUNC();
-	if (grid[y][x] == 0xFFFF)
-		return;
-
-	uint16_t packed = grid[y][x];
-	uint16_t region = packed >> 4; // top 12 bits
-	uint8_t index = packed & 0xF;  // bottom 4 bits
 
-	// unpack to get geometry
-	uint16_t mask = indexToMask(index);
-	uint8_t flags = getTileFlags(mask);
-
-	// modify geometry
-	flags |= directionFlag;
+		// North_Open_Mask = tiles with a south port -> y+1
+		if ((mask & North_Open_Mask) && grid[cy + 1][cx] != Empty_Tile && labels[cy + 1][cx] == 0)
+		{
+			labels[cy + 1][cx] = regionID;
+			ring[tail++ & ringMask] = (TopoNode){(uint32_t)cx, (uint32_t)(cy + 1)};
+		}
 
-	// repack
-	uint16_t newMask = getTileFromFlags(flags);
-	uint8_t newIndex = maskToIndex(newMask);
+		// West_Open_Mask = tiles with an east port -> x+1
+		if ((mask & West_Open_Mask) && grid[cy][cx + 1] != Empty_Tile && labels[cy][cx + 1] == 0)
+		{
+			labels[cy][cx + 1] = regionID;
+			ring[tail++ & ringMask] = (TopoNode){(uint32_t)(cx + 1), (uint32_t)cy};
+			horizontal++;
+		}
 
-	grid[y][x] = (region << 4) | newIndex;
+		// East_Open_Mask = tiles with a west port -> x-1
+		if ((mask & East_Open_Mask) && grid[cy][cx - 1] != Empty_Tile && labels[cy][cx - 1] == 0)
+		{
+			labels[cy][cx - 1] = regionID;
+			ring[tail++ & ringMask] = (TopoNode){(uint32_t)(cx - 1), (uint32_t)cy};
+			horizontal++;
+		}
+	}
+	*maxRow = bottom > *maxRow ? bottom : *maxRow;
+	return true;
 }
 
-// packedTile format: [ RegionID (12 bits) | TileIndex (4 bits) ]
-void regionMarkerPacked(uint16_t **grid, uint32_t width, uint32_t length, uint16_t regionID, uint32_t x, uint32_t y)
+// IDENTIFY: label every collapsed tile, the tiles themselves are left untouched.
+// same regions in the same order as one regionMarkerIterative per unlabeled tile. plain BFS
+// until the layer turns out to suit the word-parallel floods (cgsme_reach.h), which then
+// label the rest, starting over with the region the BFS was on
+uint32_t findConnectedRegions(uint16_t **grid, uint32_t **labels, uint32_t width, uint32_t length, CgsmeArena *arena)
 {
 	CGSME_PROFILE_FUNC();
-	if (x >= width || y >= length)
-		return;
+	ArenaMark mark = arenaGetMark(arena);
+	uint32_t ringCells = 4;
+	while (ringCells < LABEL_RING_CELLS && ringCells < (size_t)width * length)
+		ringCells <<= 1;
+	TopoNode *ring = arenaAlloc(arena, (size_t)ringCells * sizeof(TopoNode));
+	if (!ring)
+		return 0;
 
-	// IF it's void (0xFFFF) or already has a Region ID (> 15), stop.
-	if (grid[y][x] == 0xFFFF || grid[y][x] > 15)
-		return;
+	bool probing = true;
+	uint32_t maxRow = 0;
+	uint32_t regionID = 0;
+	for (uint32_t y = 0; y < length; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			if (grid[y][x] == Empty_Tile || labels[y][x] != 0)
+				continue;
+			if (labelRegionBfs(grid, labels, ++regionID, x, y, ring, ringCells - 1, &probing, &maxRow))
+				continue;
 
-	// get current geometry
-	uint8_t index = (uint8_t)grid[y][x]; // Currently just 0-15
-	uint16_t mask = indexToMask(index);
-
-	// pack RegionID into the upper 12 bits
-	grid[y][x] = (regionID << 4) | index;
-
-	// recurse
-	if (mask & South_Open_Mask)
-		regionMarkerPacked(grid, width, length, regionID, x, y - 1);
-	if (mask & North_Open_Mask)
-		regionMarkerPacked(grid, width, length, regionID, x, y + 1);
-	if (mask & West_Open_Mask)
-		regionMarkerPacked(grid, width, length, regionID, x + 1, y);
-	if (mask & East_Open_Mask)
-		regionMarkerPacked(grid, width, length, regionID, x - 1, y);
+			ReachLayer *reach = createReachLayer(width, length, arena);
+			if (!reach)
+			{
+				arenaRelease(arena, mark);
+				return 0;
+			}
+			reachLoad(reach, grid, false);
+			reachTakeLabeled(reach, labels, maxRow + 1, regionID);
+			reachFlood(reach, x, y);
+			reachLabel(reach, labels, regionID);
+			while (reachNextSeed(reach, &x, &y))
+			{
+				reachFlood(reach, x, y);
+				reachLabel(reach, labels, ++regionID);
+			}
+			arenaRelease(arena, mark);
+			return regionID;
+		}
+	}
+
+	arenaRelease(arena, mark);
+	return regionID;
 }
 
-// ITERATIVE replacement for regionMarkerPacked
-void regionMarkerIterative(uint16_t **grid, uint32_t width, uint32_t length, uint16_t regionID, uint32_t startX, uint32_t startY)
+// label (regionID) everything reachable from the start through open ports
+void regionMarkerIterative(uint16_t **grid, uint32_t **labels, uint32_t regionID, uint32_t startX, uint32_t startY, TopoNode *queue)
 {
-	TopoNode *queue = malloc(sizeof(TopoNode) * width * length);
-	if (!queue)
-		return;
-
-	int head = 0, tail = 0;
+	size_t head = 0, tail = 0;
 	queue[tail++] = (TopoNode){startX, startY};
-
-	// Mark Start
-	uint8_t sIdx = (uint8_t)grid[startY][startX];
-	grid[startY][startX] = (regionID << 4) | sIdx;
+	labels[startY][startX] = regionID;
 
 	while (head < tail)
 	{
 		TopoNode c = queue[head++];
-		uint32_t cx = c.x;
-		uint32_t cy = c.y;
+		int32_t cx = (int32_t)c.x; // signed, the void ring sits at -1
+		int32_t cy = (int32_t)c.y;
+		uint16_t mask = grid[cy][cx];
 
-		uint16_t packed = grid[cy][cx];
-		uint8_t idx = packed & 0xF;
-		uint16_t mask = indexToMask(idx);
-
-		// LOGIC CLONED FROM RECURSIVE FUNCTION:
-
-		// South -> y-1
-		if (mask & South_Open_Mask)
+		// South_Open_Mask = tiles with a north port -> y-1
+		if ((mask & South_Open_Mask) && grid[cy - 1][cx] != Empty_Tile && labels[cy - 1][cx] == 0)
 		{
-			if ((int32_t)cy - 1 >= 0 && grid[cy - 1][cx] <= 15 && grid[cy - 1][cx] != 0xFFFF)
-			{
-				uint8_t nIdx = (uint8_t)grid[cy - 1][cx];
-				grid[cy - 1][cx] = (regionID << 4) | nIdx;
-				queue[tail++] = (TopoNode){cx, cy - 1};
-			}
+			labels[cy - 1][cx] = regionID;
+			queue[tail++] = (TopoNode){(uint32_t)cx, (uint32_t)(cy - 1)};
 		}
 
-		// North -> y+1
-		if (mask & North_Open_Mask)
+		// North_Open_Mask = tiles with a south port -> y+1
+		if ((mask & North_Open_Mask) && grid[cy + 1][cx] != Empty_Tile && labels[cy + 1][cx] == 0)
 		{
-			if (cy + 1 < length && grid[cy + 1][cx] <= 15 && grid[cy + 1][cx] != 0xFFFF)
-			{
-				uint8_t nIdx = (uint8_t)grid[cy + 1][cx];
-				grid[cy + 1][cx] = (regionID << 4) | nIdx;
-				queue[tail++] = (TopoNode){cx, cy + 1};
-			}
+			labels[cy + 1][cx] = regionID;
+			queue[tail++] = (TopoNode){(uint32_t)cx, (uint32_t)(cy + 1)};
 		}
 
-		// West -> x+1 (Wait, really?)
-		// Recursive: if (mask & West) ... x+1
-		if (mask & West_Open_Mask)
+		// West_Open_Mask = tiles with an east port -> x+1
+		if ((mask & West_Open_Mask) && grid[cy][cx + 1] != Empty_Tile && labels[cy][cx + 1] == 0)
 		{
-			if (cx + 1 < width && grid[cy][cx + 1] <= 15 && grid[cy][cx + 1] != 0xFFFF)
-			{
-				uint8_t nIdx = (uint8_t)grid[cy][cx + 1];
-				grid[cy][cx + 1] = (regionID << 4) | nIdx;
-				queue[tail++] = (TopoNode){cx + 1, cy};
-			}
+			labels[cy][cx + 1] = regionID;
+			queue[tail++] = (TopoNode){(uint32_t)(cx + 1), (uint32_t)cy};
 		}
 
-		// East -> x-1
-		// Recursive: if (mask & East) ... x-1
-		if (mask & East_Open_Mask)
+		// East_Open_Mask = tiles with a west port -> x-1
+		if ((mask & East_Open_Mask) && grid[cy][cx - 1] != Empty_Tile && labels[cy][cx - 1] == 0)
 		{
-			if ((int32_t)cx - 1 >= 0 && grid[cy][cx - 1] <= 15 && grid[cy][cx - 1] != 0xFFFF)
-			{
-				uint8_t nIdx = (uint8_t)grid[cy][cx - 1];
-				grid[cy][cx - 1] = (regionID << 4) | nIdx;
-				queue[tail++] = (TopoNode){cx - 1, cy};
-			}
+			labels[cy][cx - 1] = regionID;
+			queue[tail++] = (TopoNode){(uint32_t)(cx - 1), (uint32_t)cy};
 		}
 	}
-	free(queue);
 }
 
 void sealMazeEdges(uint16_t **gridLayer, uint32_t width, uint32_t length)
 {
 	CGSME_PROFILE_FUNC();
-	for (uint32_t y = 0; y < length; y++)
+	// the layer is padded: the void ring has no ports, so no bounds checks
+	for (int32_t y = 0; y < (int32_t)length; y++)
 	{
-		for (uint32_t x = 0; x < width; x++)
+		for (int32_t x = 0; x < (int32_t)width; x++)
 		{
 			// only process Void tiles
 			if (gridLayer[y][x] != Empty_Tile)
@@ -344,38 +354,26 @@ void sealMazeEdges(uint16_t **gridLayer, uint32_t width, uint32_t length)
 			// 1. Check North Neighbor (y-1)
 			// We need to know if they point DOWN (South) to us.
 			// Tiles with South ports are in North_Open_Mask.
-			if (y > 0 && gridLayer[y - 1][x] != Empty_Tile)
-			{
-				if (gridLayer[y - 1][x] & North_Open_Mask)
-					flags |= DIR_N;
-			}
+			if (gridLayer[y - 1][x] & North_Open_Mask)
+				flags |= DIR_N;
 
 			// 2. Check South Neighbor (y+1)
 			// We need to know if they point UP (North) to us.
 			// Tiles with North ports are in South_Open_Mask.
-			if (y < length - 1 && gridLayer[y + 1][x] != Empty_Tile)
-			{
-				if (gridLayer[y + 1][x] & South_Open_Mask)
-					flags |= DIR_S;
-			}
+			if (gridLayer[y + 1][x] & South_Open_Mask)
+				flags |= DIR_S;
 
 			// 3. Check West Neighbor (x-1)
 			// We need to know if they point RIGHT (East) to us.
 			// Tiles with East ports are in West_Open_Mask.
-			if (x > 0 && gridLayer[y][x - 1] != Empty_Tile)
-			{
-				if (gridLayer[y][x - 1] & West_Open_Mask)
-					flags |= DIR_W;
-			}
+			if (gridLayer[y][x - 1] & West_Open_Mask)
+				flags |= DIR_W;
 
 			// 4. Check East Neighbor (x+1)
 			// We need to know if they point LEFT (West) to us.
 			// Tiles with West ports are in East_Open_Mask.
-			if (x < width - 1 && gridLayer[y][x + 1] != Empty_Tile)
-			{
-				if (gridLayer[y][x + 1] & East_Open_Mask)
-					flags |= DIR_E;
-			}
+			if (gridLayer[y][x + 1] & East_Open_Mask)
+				flags |= DIR_E;
 
 			if (flags != 0)
 			{
@@ -385,147 +383,19 @@ void sealMazeEdges(uint16_t **gridLayer, uint32_t width, uint32_t length)
 	}
 }
 
-void fixupEdges(uint16_t **gridLayer, uint32_t width, uint32_t length)
-{
-	CGSME_PROFILE_FUNC();
-	// top row (y=0): remove NORTH connections (flag 1)
-	for (uint32_t x = 0; x < width; x++)
-	{
-		uint8_t flags = getTileFlags(gridLayer[0][x]);
-		if (flags & DIR_N)
-		{
-			flags &= ~DIR_N; // Turn off North bit
-			gridLayer[0][x] = getTileFromFlags(flags);
-		}
-	}
-
-	// bottom row (y=length-1): remove SOUTH connections (flag 4)
-	for (uint32_t x = 0; x < width; x++)
-	{
-		uint8_t flags = getTileFlags(gridLayer[length - 1][x]);
-		if (flags & DIR_S)
-		{
-			flags &= ~DIR_S;
-			gridLayer[length - 1][x] = getTileFromFlags(flags);
-		}
-	}
-
-	// left column (x=0): remove WEST connections (flag 8)
-	for (uint32_t y = 0; y < length; y++)
-	{
-		uint8_t flags = getTileFlags(gridLayer[y][0]);
-		if (flags & DIR_W)
-		{
-			flags &= ~DIR_W;
-			gridLayer[y][0] = getTileFromFlags(flags);
-		}
-	}
-
-	// right column (x=width-1): remove EAST connections (flag 2)
-	for (uint32_t y = 0; y < length; y++)
-	{
-		uint8_t flags = getTileFlags(gridLayer[y][width - 1]);
-		if (flags & DIR_E)
-		{
-			flags &= ~DIR_E;
-			gridLayer[y][width - 1] = getTileFromFlags(flags);
-		}
-	}
-}
-
 // Helper: Convert a Tile ID to internal directional flags
 uint8_t getTileFlags(uint16_t tile)
 {
 	CGSME_PROFILE_FUNC();
-	if (tile == Empty_Tile)
-		return 0;
-
-	// Check based on physical openings defined in updateNeighbours logic
-	switch (tile)
-	{
-	case North_DeadEnd:
-		return DIR_N;
-	case East_DeadEnd:
-		return DIR_E;
-	case South_DeadEnd:
-		return DIR_S;
-	case West_DeadEnd:
-		return DIR_W;
-
-	case North_East_Corridor:
-		return DIR_N | DIR_E;
-	case South_East_Corridor:
-		return DIR_S | DIR_E;
-	case South_West_Corridor:
-		return DIR_S | DIR_W;
-	case North_West_Corridor:
-		return DIR_N | DIR_W;
-
-	case North_South_Corridor:
-		return DIR_N | DIR_S;
-	case West_East_Corridor:
-		return DIR_W | DIR_E;
-
-	case North_T_Corridor:
-		return DIR_N | DIR_E | DIR_W; // points N E W
-	case East_T_Corridor:
-		return DIR_N | DIR_E | DIR_S; // points N E S
-	case South_T_Corridor:
-		return DIR_E | DIR_S | DIR_W; // points E S W
-	case West_T_Corridor:
-		return DIR_N | DIR_S | DIR_W; // points N S W
-
-	case Normal_X_Corridor:
-		return DIR_N | DIR_E | DIR_S | DIR_W;
-	case Special_X_Corridor:
-		return DIR_N | DIR_E | DIR_S | DIR_W;
-	default:
+	// only single tiles have ports (Empty and superpositions have none)
+	if (tile == Empty_Tile || (tile & (tile - 1)))
 		return 0;
-	}
+	return TILE_PORTS[__builtin_ctz(tile)];
 }
 
-// convert internal flags back to a Tile ID
+// convert internal flags back to a Tile ID (Empty_Tile for 0 connections)
 uint16_t getTileFromFlags(uint8_t flags)
 {
 	CGSME_PROFILE_FUNC();
-	switch (flags)
-	{
-	case DIR_N:
-		return North_DeadEnd;
-	case DIR_E:
-		return East_DeadEnd;
-	case DIR_S:
-		return South_DeadEnd;
-	case DIR_W:
-		return West_DeadEnd;
-
-	case (DIR_N | DIR_E):
-		return North_East_Corridor;
-	case (DIR_S | DIR_E):
-		return South_East_Corridor;
-	case (DIR_S | DIR_W):
-		return South_West_Corridor;
-	case (DIR_N | DIR_W):
-		return North_West_Corridor;
-
-	case (DIR_N | DIR_S):
-		return North_South_Corridor;
-	case (DIR_W | DIR_E):
-		return West_East_Corridor;
-
-	case (DIR_N | DIR_E | DIR_W):
-		return North_T_Corridor;
-	case (DIR_N | DIR_E | DIR_S):
-		return East_T_Corridor;
-	case (DIR_E | DIR_S | DIR_W):
-		return South_T_Corridor;
-	case (DIR_N | DIR_S | DIR_W):
-		return West_T_Corridor;
-
-	case (DIR_N | DIR_E | DIR_S | DIR_W):
-		return Normal_X_Corridor;
-
-	default:
-		return Empty_Tile; // 0 connections or invalid combo
-	}
-}
\ No newline at end of file
+	return PORTS_TO_TILE[flags & 0xF];
+}
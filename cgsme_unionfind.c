@@ -0,0 +1,36 @@
+#include "cgsme_unionfind.h"
+#include <string.h>
+
+UnionFind *createUnionFind(uint32_t capacity, uint32_t count, CgsmeArena *arena)
+{
+	CGSME_PROFILE_FUNC();
+	UnionFind *uf = arenaAlloc(arena, sizeof(UnionFind));
+	if (!uf)
+		return NULL;
+	uf->parent = arenaAlloc(arena, sizeof(uint32_t) * (size_t)capacity);
+	uf->size = arenaAlloc(arena, sizeof(uint32_t) * (size_t)capacity);
+	if (!uf->parent || !uf->size)
+		return NULL;
+	uf->count = 0;
+	while (uf->count < count)
+		makeSet(uf);
+	return uf;
+}
+
+uint32_t compactSets(UnionFind *uf, uint32_t *setOf)
+{
+	CGSME_PROFILE_FUNC();
+	// the ID of a set is parked on its root. a root above i gets its ID early (from its
+	// smallest element), so the IDs follow the smallest elements in ascending order
+	memset(setOf, 0, sizeof(uint32_t) * uf->count);
+	uint32_t sets = 0;
+	for (uint32_t i = 0; i < uf->count; i++)
+	{
+		uint32_t root = findSet(uf, i);
+		uf->parent[i] = root;
+		if (setOf[root] == 0)
+			setOf[root] = ++sets;
+		setOf[i] = setOf[root];
+	}
+	return sets;
+}
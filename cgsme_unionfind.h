@@ -0,0 +1,91 @@
+#ifndef CGSME_UNIONFIND_H
+#define CGSME_UNIONFIND_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cgsme_utils.h"
+
+// UNION-FIND (disjoint sets) over 32-bit element indices
+// path halving on every find, union by size, storage taken from an arena.
+// used by the welder (regions), the mask labeler (provisional labels) and any other
+// connectivity pass. finds are iterative, so millions of elements are fine.
+typedef struct
+{
+	uint32_t *parent;
+	uint32_t *size; // element count of the set, only valid on roots
+	uint32_t count; // elements 0..count-1
+} UnionFind;
+
+/// @brief Create a union-find with room for `capacity` elements, the first `count` of them singletons.
+/// @param capacity Maximum number of elements (more can be added with makeSet).
+/// @param count Number of elements created right away.
+/// @param arena Arena the storage is taken from (released by the caller).
+/// @return Pointer to the UnionFind, NULL if the arena is out of memory.
+UnionFind *createUnionFind(uint32_t capacity, uint32_t count, CgsmeArena *arena);
+
+/// @brief Add one more singleton set (the caller makes sure there is room, see createUnionFind).
+/// @param uf Pointer to the UnionFind structure.
+/// @return Index of the new element.
+static inline uint32_t makeSet(UnionFind *uf)
+{
+	uint32_t i = uf->count++;
+	uf->parent[i] = i;
+	uf->size[i] = 1;
+	return i;
+}
+
+/// @brief Find the set representative for element i (path halving).
+/// @param uf Pointer to the UnionFind structure.
+/// @param i Element index.
+/// @return Set representative.
+static inline uint32_t findSet(UnionFind *uf, uint32_t i)
+{
+	uint32_t *parent = uf->parent;
+	while (parent[i] != i)
+	{
+		parent[i] = parent[parent[i]];
+		i = parent[i];
+	}
+	return i;
+}
+
+/// @brief Merge two sets given by their representatives (the smaller set goes under the larger).
+/// @param uf Pointer to the UnionFind structure.
+/// @param a Representative of the first set.
+/// @param b Representative of the second set (a != b).
+/// @return Representative of the merged set.
+static inline uint32_t unionRoots(UnionFind *uf, uint32_t a, uint32_t b)
+{
+	if (uf->size[a] < uf->size[b])
+	{
+		uint32_t t = a;
+		a = b;
+		b = t;
+	}
+	uf->parent[b] = a;
+	uf->size[a] += uf->size[b];
+	return a;
+}
+
+/// @brief Union the sets of two elements.
+/// @param uf Pointer to the UnionFind structure.
+/// @param i First element.
+/// @param j Second element.
+/// @return true if they were in different sets (and are merged now).
+static inline bool unionSets(UnionFind *uf, uint32_t i, uint32_t j)
+{
+	uint32_t a = findSet(uf, i);
+	uint32_t b = findSet(uf, j);
+	if (a == b)
+		return false;
+	unionRoots(uf, a, b);
+	return true;
+}
+
+/// @brief Label compaction: give every set a dense ID, in the order of the set's smallest element.
+/// @param uf Pointer to the UnionFind structure (fully compressed afterwards).
+/// @param setOf Output, setOf[i] = ID (1..sets) of the set of element i. count entries.
+/// @return Number of sets.
+uint32_t compactSets(UnionFind *uf, uint32_t *setOf);
+
+#endif // CGSME_UNIONFIND_H
@@ -2,7 +2,197 @@
 #include "cgsme_debug.h"
 #include "cgsme_solver.h"
 #include <stdio.h>
+#include <string.h>
 #include <math.h>
+#include <time.h>
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+// smallest block the arena asks the heap for
+#define ARENA_MIN_BLOCK (64 * 1024)
+#define ARENA_ALIGN 16
+
+// header is padded to the alignment so block data starts aligned
+#define ARENA_HEADER ((sizeof(ArenaBlock) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1))
+
+static ArenaBlock *arenaNewBlock(CgsmeArena *a, size_t size)
+{
+	ArenaBlock *b = malloc(ARENA_HEADER + size);
+	if (!b)
+		return NULL;
+	b->next = NULL;
+	b->size = size;
+	b->used = 0;
+	a->reserved += size;
+	a->heapAllocs++;
+	return b;
+}
+
+static inline uint8_t *arenaBlockData(ArenaBlock *b)
+{
+	return (uint8_t *)b + ARENA_HEADER;
+}
+
+void arenaInit(CgsmeArena *a)
+{
+	a->first = NULL;
+	a->current = NULL;
+	a->used = 0;
+	a->peak = 0;
+	a->reserved = 0;
+	a->heapAllocs = 0;
+}
+
+void *arenaAlloc(CgsmeArena *a, size_t size)
+{
+	size = (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+	ArenaBlock *b = a->current;
+	while (!b || b->used + size > b->size)
+	{
+		if (b)
+		{
+			// rest of this block is lost until the arena rolls back past it
+			a->used += b->size - b->used;
+			b->used = b->size;
+		}
+
+		ArenaBlock *next = b ? b->next : a->first;
+		if (next)
+		{
+			// block kept from an earlier, bigger call
+			next->used = 0;
+		}
+		else
+		{
+			// grow geometrically so a growing map needs few blocks
+			size_t want = a->reserved > size ? a->reserved : size;
+			if (want < ARENA_MIN_BLOCK)
+				want = ARENA_MIN_BLOCK;
+			next = arenaNewBlock(a, want);
+			if (!next)
+				return NULL;
+			if (b)
+				b->next = next;
+			else
+				a->first = next;
+		}
+		b = next;
+		a->current = b;
+	}
+
+	void *p = arenaBlockData(b) + b->used;
+	b->used += size;
+	a->used += size;
+	if (a->used > a->peak)
+		a->peak = a->used;
+	return p;
+}
+
+void *arenaCalloc(CgsmeArena *a, size_t count, size_t size)
+{
+	void *p = arenaAlloc(a, count * size);
+	if (p)
+		memset(p, 0, count * size);
+	return p;
+}
+
+ArenaMark arenaGetMark(const CgsmeArena *a)
+{
+	ArenaMark m = {a->current, a->current ? a->current->used : 0, a->used};
+	return m;
+}
+
+void arenaRelease(CgsmeArena *a, ArenaMark mark)
+{
+	a->current = mark.block;
+	if (a->current)
+		a->current->used = mark.blockUsed;
+	a->used = mark.used;
+
+	// back to empty after chaining blocks: trade them for one block that fits the whole peak
+	if (a->used == 0 && a->first && a->first->next)
+	{
+		size_t peak = a->peak;
+		uint64_t allocs = a->heapAllocs;
+		arenaDestroy(a);
+		a->peak = peak;
+		a->heapAllocs = allocs;
+		a->first = arenaNewBlock(a, peak);
+		a->current = NULL;
+	}
+}
+
+bool arenaReserve(CgsmeArena *a, size_t size)
+{
+	if (a->used != 0 || (a->first && !a->first->next && a->first->size >= size))
+		return true;
+
+	size_t peak = a->peak;
+	uint64_t allocs = a->heapAllocs;
+	arenaDestroy(a);
+	a->peak = peak;
+	a->heapAllocs = allocs;
+	a->first = arenaNewBlock(a, size);
+	return a->first != NULL;
+}
+
+void arenaDestroy(CgsmeArena *a)
+{
+	ArenaBlock *b = a->first;
+	while (b)
+	{
+		ArenaBlock *next = b->next;
+		free(b);
+		b = next;
+	}
+	arenaInit(a);
+}
+
+uint64_t monotonicUs(void)
+{
+#ifdef _WIN32
+	static LARGE_INTEGER freq = {0};
+	LARGE_INTEGER now;
+	if (freq.QuadPart == 0)
+		QueryPerformanceFrequency(&freq);
+	QueryPerformanceCounter(&now);
+	return (uint64_t)((now.QuadPart / freq.QuadPart) * 1000000ULL + (now.QuadPart % freq.QuadPart) * 1000000ULL / freq.QuadPart);
+#else
+	struct timespec ts;
+	if (clock_gettime(CLOCK_MONOTONIC, &ts) != 0)
+		return 0;
+	return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)(ts.tv_nsec / 1000);
+#endif
+}
+
+uint16_t **allocPaddedLayer(uint32_t width, uint32_t length, CgsmeArena *arena)
+{
+	size_t stride = (size_t)width + 2;
+	uint16_t *data = arenaCalloc(arena, stride * (length + 2), sizeof(uint16_t));
+	uint16_t **rows = arenaAlloc(arena, sizeof(uint16_t *) * (length + 2));
+	if (!data || !rows)
+		return NULL;
+
+	// every row pointer skips the left sentinel, the table skips the top one
+	for (uint32_t i = 0; i < length + 2; i++)
+		rows[i] = &data[i * stride + 1];
+	return rows + 1;
+}
+
+uint32_t **allocPaddedLabels(uint32_t width, uint32_t length, CgsmeArena *arena)
+{
+	size_t stride = (size_t)width + 2;
+	uint32_t *data = arenaCalloc(arena, stride * (length + 2), sizeof(uint32_t));
+	uint32_t **rows = arenaAlloc(arena, sizeof(uint32_t *) * (length + 2));
+	if (!data || !rows)
+		return NULL;
+
+	for (uint32_t i = 0; i < length + 2; i++)
+		rows[i] = &data[i * stride + 1];
+	return rows + 1;
+}
 
 Queue2D *q_init(int cap)
 {
@@ -34,32 +224,28 @@ void q_free(Queue2D *q)
 	free(q);
 }
 
-MinHeap *initHeap(uint32_t width, uint32_t length)
+MinHeap *initHeap(uint32_t width, uint32_t length, CgsmeArena *arena)
 {
 	CGSME_PROFILE_FUNC();
-	MinHeap *h = malloc(sizeof(MinHeap));
+	MinHeap *h = arenaAlloc(arena, sizeof(MinHeap));
+	if (!h)
+		return NULL;
 	h->capacity = width * length; // Worst case: everything added
 	h->count = 0;
 	h->width = width;
 	h->length = length;
-	h->nodes = malloc(sizeof(HeapNode) * h->capacity);
+	h->nodes = arenaAlloc(arena, sizeof(HeapNode) * h->capacity);
 
 	// Initialize map to -1 (not in heap)
-	h->indexMap = malloc(sizeof(int32_t) * width * length);
+	h->indexMap = arenaAlloc(arena, sizeof(int32_t) * width * length);
+	if (!h->nodes || !h->indexMap)
+		return NULL;
 	for (uint32_t i = 0; i < width * length; i++)
 		h->indexMap[i] = -1;
 
 	return h;
 }
 
-void freeHeap(MinHeap *h)
-{
-	CGSME_PROFILE_FUNC();
-	free(h->nodes);
-	free(h->indexMap);
-	free(h);
-}
-
 void swapNodes(MinHeap *h, uint32_t i, uint32_t j)
 {
 	CGSME_PROFILE_FUNC();
@@ -119,7 +305,7 @@ void bubbleDown(MinHeap *h, uint32_t index)
 }
 
 // Adds a node or Updates it if it already exists
-void heapInsertOrUpdate(MinHeap *h, uint16_t **grid, uint32_t x, uint32_t y, float **distMap, uint32_t *rng)
+void heapInsertOrUpdate(MinHeap *h, uint16_t **grid, uint32_t x, uint32_t y, float **distMap, CgsmeRng *rng)
 {
 	CGSME_PROFILE_FUNC();
 	uint32_t mapIdx = y * h->width + x;
@@ -193,4 +379,262 @@ bool heapPop(MinHeap *h, uint16_t **grid, uint32_t *outX, uint32_t *outY)
 		// IF not valid, loop again (Lazy Deletion)
 	}
 	return false;
-}
\ No newline at end of file
+}
+
+BucketQueue *initBucketQueue(uint32_t width, uint32_t length, CgsmeArena *arena)
+{
+	CGSME_PROFILE_FUNC();
+	BucketQueue *q = arenaAlloc(arena, sizeof(BucketQueue));
+	if (!q)
+		return NULL;
+	size_t cells = (size_t)width * length;
+	q->slots = arenaAlloc(arena, sizeof(uint32_t) * cells);
+	q->position = arenaAlloc(arena, sizeof(int32_t) * cells);
+	q->rank = arenaAlloc(arena, sizeof(uint8_t) * cells);
+	if (!q->slots || !q->position || !q->rank)
+		return NULL;
+	for (size_t i = 0; i < cells; i++)
+		q->position[i] = -1;
+	memset(q->start, 0, sizeof(q->start));
+	q->width = width;
+	q->length = length;
+	return q;
+}
+
+// insert a new cell into bucket `rank`: every bucket behind it hands its first cell to
+// the free slot after its end, which moves the free slot one bucket forward
+static void bucketInsert(BucketQueue *q, uint32_t cell, uint32_t rank)
+{
+	uint32_t hole = q->start[ENTROPY_BUCKETS]++;
+	for (uint32_t k = ENTROPY_BUCKETS - 1; k > rank; k--)
+	{
+		uint32_t first = q->start[k];
+		if (first != hole)
+		{
+			q->slots[hole] = q->slots[first];
+			q->position[q->slots[hole]] = hole;
+		}
+		hole = first;
+		q->start[k]++;
+	}
+	q->slots[hole] = cell;
+	q->position[cell] = hole;
+	q->rank[cell] = rank;
+}
+
+// move a queued cell to a higher rank (lower entropy): swap it to the end of its bucket and
+// shift the boundary, once per bucket crossed
+static void bucketLower(BucketQueue *q, uint32_t cell, uint32_t newRank)
+{
+	uint32_t p = q->position[cell];
+	for (uint32_t k = q->rank[cell]; k < newRank; k++)
+	{
+		uint32_t last = q->start[k + 1] - 1;
+		if (last != p)
+		{
+			q->slots[p] = q->slots[last];
+			q->position[q->slots[p]] = p;
+			q->slots[last] = cell;
+			q->position[cell] = last;
+		}
+		p = last;
+		q->start[k + 1]--;
+	}
+	q->rank[cell] = newRank;
+}
+
+void bucketInsertOrUpdate(BucketQueue *q, uint16_t **grid, uint32_t x, uint32_t y)
+{
+	CGSME_PROFILE_FUNC();
+	if (x >= q->width || y >= q->length)
+		return;
+	// same rule as the heap: collapsed (1 bit) or broken (0 bits) tiles are not scheduled
+	uint32_t entropy = __builtin_popcount(grid[y][x]);
+	if (entropy <= 1)
+		return;
+
+	uint32_t cell = y * q->width + x;
+	uint32_t rank = (ENTROPY_BUCKETS - 1) - entropy;
+	if (q->position[cell] == -1)
+		bucketInsert(q, cell, rank);
+	else if (rank > q->rank[cell]) // entropy only ever decreases
+		bucketLower(q, cell, rank);
+}
+
+bool bucketPop(BucketQueue *q, uint16_t **grid, uint32_t *outX, uint32_t *outY, CgsmeRng *rng)
+{
+	CGSME_PROFILE_FUNC();
+	while (q->start[ENTROPY_BUCKETS] > 0)
+	{
+		uint32_t count = q->start[ENTROPY_BUCKETS];
+
+		// lowest entropy bucket = last non-empty one, it ends at the tail
+		uint32_t r = ENTROPY_BUCKETS - 1;
+		while (q->start[r] == count)
+			r--;
+
+		// random tie-break inside the bucket
+		uint32_t size = count - q->start[r];
+		uint32_t p = q->start[r] + (size > 1 ? cgsme_rng_bounded_fast(rng, size) : 0);
+		uint32_t cell = q->slots[p];
+
+		uint32_t last = count - 1;
+		q->slots[p] = q->slots[last];
+		q->position[q->slots[p]] = p;
+		for (uint32_t k = r + 1; k <= ENTROPY_BUCKETS; k++)
+			q->start[k] = last;
+		q->position[cell] = -1;
+
+		// validation: the tile may have been narrowed (or collapsed) without being re-pushed
+		uint32_t x = cell % q->width;
+		uint32_t y = cell / q->width;
+		uint32_t entropy = __builtin_popcount(grid[y][x]);
+		if (entropy <= 1)
+			continue;
+		uint32_t rank = (ENTROPY_BUCKETS - 1) - entropy;
+		if (rank > r)
+		{
+			bucketInsert(q, cell, rank);
+			continue;
+		}
+
+		*outX = x;
+		*outY = y;
+		return true;
+	}
+	return false;
+}
+
+CellIndex *initCellIndex(uint32_t cellCount, CgsmeArena *arena)
+{
+	CellIndex *idx = arenaAlloc(arena, sizeof(CellIndex));
+	if (!idx)
+		return NULL;
+	idx->cellCount = cellCount;
+	idx->wordCount = (cellCount + 63) / 64;
+	idx->summaryCount = (idx->wordCount + 63) / 64;
+	idx->count = 0;
+	idx->words = arenaCalloc(arena, idx->wordCount, sizeof(uint64_t));
+	idx->summary = arenaCalloc(arena, idx->summaryCount, sizeof(uint64_t));
+	if (!idx->words || !idx->summary)
+		return NULL;
+	return idx;
+}
+
+void cellIndexSet(CellIndex *idx, uint32_t cell)
+{
+	uint32_t w = cell >> 6;
+	idx->count += !((idx->words[w] >> (cell & 63)) & 1);
+	idx->words[w] |= 1ULL << (cell & 63);
+	idx->summary[w >> 6] |= 1ULL << (w & 63);
+}
+
+void cellIndexClear(CellIndex *idx, uint32_t cell)
+{
+	uint32_t w = cell >> 6;
+	idx->count -= (idx->words[w] >> (cell & 63)) & 1;
+	idx->words[w] &= ~(1ULL << (cell & 63));
+	if (idx->words[w] == 0)
+		idx->summary[w >> 6] &= ~(1ULL << (w & 63));
+}
+
+uint32_t cellIndexSelect(const CellIndex *idx, uint32_t rank)
+{
+	// whole words through the summary (only the non-empty ones are read), then bit by bit
+	for (uint32_t s = 0; s < idx->summaryCount; s++)
+	{
+		uint64_t sum = idx->summary[s];
+		while (sum)
+		{
+			uint32_t w = (s << 6) + __builtin_ctzll(sum);
+			uint64_t bits = idx->words[w];
+			uint32_t pc = (uint32_t)__builtin_popcountll(bits);
+			if (rank < pc)
+			{
+				for (; rank > 0; rank--)
+					bits &= bits - 1;
+				return (w << 6) + __builtin_ctzll(bits);
+			}
+			rank -= pc;
+			sum &= sum - 1;
+		}
+	}
+	return idx->cellCount;
+}
+
+// first set bit at or after `from` without wrapping (from < cellCount)
+static bool cellIndexScan(const CellIndex *idx, uint32_t from, uint32_t *outCell)
+{
+	// rest of the starting word
+	uint32_t w = from >> 6;
+	uint64_t bits = idx->words[w] & (~0ULL << (from & 63));
+	if (bits)
+	{
+		*outCell = (w << 6) + __builtin_ctzll(bits);
+		return true;
+	}
+
+	// next non-empty word through the summary, starting after w
+	uint32_t next = w + 1;
+	if (next >= idx->wordCount)
+		return false;
+	uint32_t s = next >> 6;
+	uint64_t sum = idx->summary[s] & (~0ULL << (next & 63));
+	while (!sum)
+	{
+		if (++s >= idx->summaryCount)
+			return false;
+		sum = idx->summary[s];
+	}
+	w = (s << 6) + __builtin_ctzll(sum);
+	*outCell = (w << 6) + __builtin_ctzll(idx->words[w]);
+	return true;
+}
+
+bool cellIndexNext(const CellIndex *idx, uint32_t from, uint32_t *outCell)
+{
+	if (from < idx->cellCount && cellIndexScan(idx, from, outCell))
+		return true;
+	return from > 0 && cellIndexScan(idx, 0, outCell);
+}
+
+CellStack *initCellStack(uint32_t capacity, CgsmeArena *arena)
+{
+	CellStack *stack = arenaAlloc(arena, sizeof(CellStack));
+	if (!stack)
+		return NULL;
+	stack->count = 0;
+	stack->cells = arenaAlloc(arena, sizeof(uint32_t) * (capacity ? capacity : 1));
+	if (!stack->cells)
+		return NULL;
+	return stack;
+}
+
+EntropyQueue *initEntropyQueue(uint32_t width, uint32_t length, bool useHeap, CgsmeArena *arena)
+{
+	EntropyQueue *q = arenaCalloc(arena, 1, sizeof(EntropyQueue));
+	if (!q)
+		return NULL;
+	if (useHeap)
+		q->heap = initHeap(width, length, arena);
+	else
+		q->buckets = initBucketQueue(width, length, arena);
+	if (!q->heap && !q->buckets)
+		return NULL;
+	return q;
+}
+
+void entropyQueuePush(EntropyQueue *q, uint16_t **grid, uint32_t x, uint32_t y, float **distMap, CgsmeRng *rng)
+{
+	if (q->heap)
+		heapInsertOrUpdate(q->heap, grid, x, y, distMap, rng);
+	else
+		bucketInsertOrUpdate(q->buckets, grid, x, y);
+}
+
+bool entropyQueuePop(EntropyQueue *q, uint16_t **grid, uint32_t *outX, uint32_t *outY, CgsmeRng *rng)
+{
+	if (q->heap)
+		return heapPop(q->heap, grid, outX, outY);
+	return bucketPop(q->buckets, grid, outX, outY, rng);
+}
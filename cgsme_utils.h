@@ -6,6 +6,99 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "cgsme_debug.h"
+#include "threadRandom.h"
+
+// --- SCRATCH ARENA ---
+// bump allocator for per-call scratch memory. blocks are kept between calls, so once an
+// arena has seen the largest map it will not touch the heap again.
+typedef struct ArenaBlock
+{
+    struct ArenaBlock *next;
+    size_t size; // usable bytes after the header
+    size_t used;
+} ArenaBlock;
+
+typedef struct
+{
+    ArenaBlock *first;
+    ArenaBlock *current;
+    size_t used;       // bytes handed out (including padding at block ends)
+    size_t peak;       // high-water mark of `used`
+    size_t reserved;   // bytes owned across all blocks
+    uint64_t heapAllocs; // number of block mallocs so far (steady state: no growth)
+} CgsmeArena;
+
+// position to roll back to with arenaRelease (allocations are stack-like)
+typedef struct
+{
+    ArenaBlock *block;
+    size_t blockUsed;
+    size_t used;
+} ArenaMark;
+
+/// @brief Initialize an empty arena (no memory is reserved until the first allocation).
+/// @param a Pointer to the arena.
+void arenaInit(CgsmeArena *a);
+
+/// @brief Allocate `size` bytes (16-byte aligned) from the arena.
+/// @param a Pointer to the arena.
+/// @param size Number of bytes.
+/// @return Pointer to uninitialized memory, NULL if the arena could not grow.
+void *arenaAlloc(CgsmeArena *a, size_t size);
+
+/// @brief Allocate `count * size` zeroed bytes from the arena.
+/// @param a Pointer to the arena.
+/// @param count Number of elements.
+/// @param size Size of one element.
+/// @return Pointer to zeroed memory, NULL if the arena could not grow.
+void *arenaCalloc(CgsmeArena *a, size_t count, size_t size);
+
+/// @brief Remember the current fill level.
+/// @param a Pointer to the arena.
+/// @return Mark to pass to arenaRelease.
+ArenaMark arenaGetMark(const CgsmeArena *a);
+
+/// @brief Free everything allocated after `mark`. Rolling back to an empty arena that had to
+///        chain several blocks merges them into one block of `peak` bytes.
+/// @param a Pointer to the arena.
+/// @param mark Mark returned by arenaGetMark.
+void arenaRelease(CgsmeArena *a, ArenaMark mark);
+
+/// @brief Make an empty arena own at least `size` bytes in one block, so allocations up to that
+///        much do not touch the heap. Does nothing if it already does or if it is not empty.
+/// @param a Pointer to the arena.
+/// @param size Bytes the first block must hold.
+/// @return false if the block could not be allocated (the arena is left empty).
+bool arenaReserve(CgsmeArena *a, size_t size);
+
+/// @brief Return all blocks to the heap.
+/// @param a Pointer to the arena.
+void arenaDestroy(CgsmeArena *a);
+
+// --- CLOCK ---
+// monotonic time for the phase statistics (release builds too, unlike cgsme_now_us)
+
+/// @brief Microseconds since an arbitrary fixed point.
+/// @return Monotonic timestamp in microseconds.
+uint64_t monotonicUs(void);
+
+// --- PADDED LAYER ---
+// working copy of a layer with a one cell sentinel ring around it: rows -1 and `length`,
+// columns -1 and `width` are valid, so neighbour lookups need no bounds checks.
+
+/// @brief Allocate a zeroed padded layer (the ring reads as Empty_Tile).
+/// @param width Number of columns (without the ring).
+/// @param length Number of rows (without the ring).
+/// @param arena Arena the rows and the row table are taken from.
+/// @return Row table indexed as [y][x] with -1 <= x <= width, -1 <= y <= length, NULL if out of memory.
+uint16_t **allocPaddedLayer(uint32_t width, uint32_t length, CgsmeArena *arena);
+
+/// @brief Allocate a zeroed padded 32-bit plane (region labels, 0 = void, the ring too).
+/// @param width Number of columns (without the ring).
+/// @param length Number of rows (without the ring).
+/// @param arena Arena the rows and the row table are taken from.
+/// @return Row table indexed as [y][x] with -1 <= x <= width, -1 <= y <= length, NULL if out of memory.
+uint32_t **allocPaddedLabels(uint32_t width, uint32_t length, CgsmeArena *arena);
 
 // --- QUEUE FOR FLOOD FILL ---
 typedef struct
@@ -61,12 +154,9 @@ typedef struct
 /// @brief Initialize a min-heap for the given grid dimensions.
 /// @param width Grid width.
 /// @param length Grid length.
-/// @return Pointer to the newly allocated MinHeap.
-MinHeap *initHeap(uint32_t width, uint32_t length);
-
-/// @brief Free the heap memory.
-/// @param h Pointer to the heap to free.
-void freeHeap(MinHeap *h);
+/// @param arena Arena the heap storage is taken from (released by the caller).
+/// @return Pointer to the MinHeap, NULL if the arena is out of memory.
+MinHeap *initHeap(uint32_t width, uint32_t length, CgsmeArena *arena);
 
 /// @brief Swap two nodes in the heap and update the index map.
 /// @param h Pointer to the heap.
@@ -91,7 +181,7 @@ void bubbleDown(MinHeap *h, uint32_t index);
 /// @param y Y coordinate.
 /// @param distMap Distance map for score calculation.
 /// @param rng Pointer to random state.
-void heapInsertOrUpdate(MinHeap *h, uint16_t **grid, uint32_t x, uint32_t y, float **distMap, uint32_t *rng);
+void heapInsertOrUpdate(MinHeap *h, uint16_t **grid, uint32_t x, uint32_t y, float **distMap, CgsmeRng *rng);
 
 /// @brief Pop the minimum node from the heap.
 /// @param h Pointer to the heap.
@@ -101,4 +191,146 @@ void heapInsertOrUpdate(MinHeap *h, uint16_t **grid, uint32_t x, uint32_t y, flo
 /// @return true if a valid node was found, false if heap is empty.
 bool heapPop(MinHeap *h, uint16_t **grid, uint32_t *outX, uint32_t *outY);
 
+// BUCKET QUEUE (entropy scheduler)
+
+// entropy is popcount(tile): 0..16
+#define ENTROPY_BUCKETS 17
+
+// every queued cell lives in one array, grouped into buckets by entropy. buckets are
+// stored from high to low entropy so the lowest one always ends at the tail of the array:
+// pop swaps with the last slot, insert/decrease shift at most one cell per bucket boundary.
+typedef struct
+{
+	uint32_t *slots;                       // cell indices (y * width + x), grouped by bucket
+	int32_t *position;                     // map[cell] = slot (or -1)
+	uint8_t *rank;                         // bucket of the cell: rank = 16 - entropy
+	uint32_t start[ENTROPY_BUCKETS + 1];   // bucket r = slots[start[r] .. start[r + 1]), start[17] = count
+	uint32_t width;
+	uint32_t length;
+} BucketQueue;
+
+/// @brief Initialize an empty bucket queue for the given grid dimensions.
+/// @param width Grid width.
+/// @param length Grid length.
+/// @param arena Arena the queue storage is taken from (released by the caller).
+/// @return Pointer to the BucketQueue, NULL if the arena is out of memory.
+BucketQueue *initBucketQueue(uint32_t width, uint32_t length, CgsmeArena *arena);
+
+/// @brief Insert a cell or move it to its (lower) entropy bucket. O(1), at most 16 slot moves.
+/// @param q Pointer to the queue.
+/// @param grid Pointer to the grid layer.
+/// @param x X coordinate.
+/// @param y Y coordinate.
+void bucketInsertOrUpdate(BucketQueue *q, uint16_t **grid, uint32_t x, uint32_t y);
+
+/// @brief Pop a random cell among the ones with the lowest entropy.
+/// @param q Pointer to the queue.
+/// @param grid Pointer to the grid layer (stale entries are refiled or dropped).
+/// @param outX Output X coordinate.
+/// @param outY Output Y coordinate.
+/// @param rng Pointer to random state (tie-break).
+/// @return true if a valid cell was found, false if the queue is empty.
+bool bucketPop(BucketQueue *q, uint16_t **grid, uint32_t *outX, uint32_t *outY, CgsmeRng *rng);
+
+// CELL INDEX (two level bitset)
+
+// set of cell indices with a summary bit per non-empty 64 bit word, so a search skips
+// 4096 empty cells per summary word it reads
+typedef struct
+{
+	uint64_t *words;   // bit per cell
+	uint64_t *summary; // bit per word of `words` that is non-zero
+	uint32_t cellCount;
+	uint32_t wordCount;
+	uint32_t summaryCount;
+	uint32_t count; // cells in the index
+} CellIndex;
+
+/// @brief Initialize an empty cell index.
+/// @param cellCount Number of cells (width * length).
+/// @param arena Arena the storage is taken from (released by the caller).
+/// @return Pointer to the CellIndex, NULL if the arena is out of memory.
+CellIndex *initCellIndex(uint32_t cellCount, CgsmeArena *arena);
+
+/// @brief Add a cell to the index.
+/// @param idx Pointer to the index.
+/// @param cell Cell index (y * width + x).
+void cellIndexSet(CellIndex *idx, uint32_t cell);
+
+/// @brief Remove a cell from the index.
+/// @param idx Pointer to the index.
+/// @param cell Cell index (y * width + x).
+void cellIndexClear(CellIndex *idx, uint32_t cell);
+
+/// @brief Check whether a cell is in the index.
+/// @param idx Pointer to the index.
+/// @param cell Cell index (y * width + x).
+/// @return true if the cell is in the index.
+static inline bool cellIndexHas(const CellIndex *idx, uint32_t cell)
+{
+	return (idx->words[cell >> 6] >> (cell & 63)) & 1;
+}
+
+/// @brief Find the cell that has `rank` indexed cells before it.
+/// @param idx Pointer to the index.
+/// @param rank Rank of the cell, must be below idx->count.
+/// @return Cell index.
+uint32_t cellIndexSelect(const CellIndex *idx, uint32_t rank);
+
+/// @brief Find the first cell in the index at or after `from`, wrapping around at the end.
+/// @param idx Pointer to the index.
+/// @param from Cell to start searching at.
+/// @param outCell Output cell index.
+/// @return false if the index is empty.
+bool cellIndexNext(const CellIndex *idx, uint32_t from, uint32_t *outCell);
+
+// CELL STACK
+
+// LIFO of cell indices with a fixed capacity, for worklists with a known bound
+typedef struct
+{
+	uint32_t *cells; // cell indices (y * width + x)
+	uint32_t count;
+} CellStack;
+
+/// @brief Initialize an empty cell stack.
+/// @param capacity Most cells it has to hold at once (pushes are not checked).
+/// @param arena Arena the storage is taken from (released by the caller).
+/// @return Pointer to the CellStack, NULL if the arena is out of memory.
+CellStack *initCellStack(uint32_t capacity, CgsmeArena *arena);
+
+// ENTROPY SCHEDULER (bucket queue or the legacy heap, picked per generation)
+
+typedef struct
+{
+	MinHeap *heap;        // set when the heap is used
+	BucketQueue *buckets; // set otherwise
+} EntropyQueue;
+
+/// @brief Initialize the scheduler of one layer.
+/// @param width Grid width.
+/// @param length Grid length.
+/// @param useHeap true for the float score MinHeap, false for the bucket queue.
+/// @param arena Arena the storage is taken from (released by the caller).
+/// @return Pointer to the EntropyQueue, NULL if the arena is out of memory.
+EntropyQueue *initEntropyQueue(uint32_t width, uint32_t length, bool useHeap, CgsmeArena *arena);
+
+/// @brief Schedule a cell (or refresh its priority).
+/// @param q Pointer to the scheduler.
+/// @param grid Pointer to the grid layer.
+/// @param x X coordinate.
+/// @param y Y coordinate.
+/// @param distMap Distance map (heap score only).
+/// @param rng Pointer to random state (heap score noise only).
+void entropyQueuePush(EntropyQueue *q, uint16_t **grid, uint32_t x, uint32_t y, float **distMap, CgsmeRng *rng);
+
+/// @brief Take the next cell to collapse.
+/// @param q Pointer to the scheduler.
+/// @param grid Pointer to the grid layer.
+/// @param outX Output X coordinate.
+/// @param outY Output Y coordinate.
+/// @param rng Pointer to random state (bucket tie-break only).
+/// @return true if a valid cell was found, false if nothing is left.
+bool entropyQueuePop(EntropyQueue *q, uint16_t **grid, uint32_t *outX, uint32_t *outY, CgsmeRng *rng);
+
 #endif // __cgsme_UTILS_H__
\ No newline at end of file
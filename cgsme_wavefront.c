@@ -0,0 +1,247 @@
+#include "cgsme_wavefront.h"
+#include "cgsme_solver.h"
+#include "cgsme_debug.h"
+#include <string.h>
+
+// per tile flags
+#define WF_PENDING 1 // in the frontier list of its colour
+#define WF_TOUCHED 2 // in the pull list of the current round
+
+typedef struct
+{
+	uint16_t **grid;
+	const uint32_t *cells;
+	uint32_t count;
+	uint32_t width;
+	const float *rates; // NULL: narrow the tiles instead of collapsing them
+	CgsmeRng rng;		// parent stream, every tile splits its own from it
+} WavefrontJob;
+
+static int runWavefrontJob(void *args)
+{
+	CGSME_PROFILE_FUNC();
+	WavefrontJob *job = (WavefrontJob *)args;
+	uint16_t **grid = job->grid;
+	float rates[NUM_TILE_TYPES];
+	if (job->rates)
+		memcpy(rates, job->rates, sizeof(rates));
+
+	for (uint32_t i = 0; i < job->count; i++)
+	{
+		uint32_t cell = job->cells[i];
+		uint32_t x = cell % job->width;
+		uint32_t y = cell / job->width;
+		if (job->rates)
+		{
+			CgsmeRng rng = cgsme_rng_split(&job->rng, cell);
+			collapseTile(&grid[y][x], rates, &rng);
+		}
+		else
+			constrainFromNeighbours(grid, x, y);
+	}
+	return 0;
+}
+
+// one step over `cells` (all of one colour), chunked over the pool
+static void runWavefrontStep(CgsmePool *pool, WavefrontJob *jobs, const WavefrontJob *proto, const uint32_t *cells, uint32_t count)
+{
+	uint32_t chunks = (count + WAVEFRONT_CHUNK - 1) / WAVEFRONT_CHUNK;
+	if (!pool || chunks < 2)
+	{
+		WavefrontJob job = *proto;
+		job.cells = cells;
+		job.count = count;
+		runWavefrontJob(&job);
+		return;
+	}
+
+	for (uint32_t i = 0; i < chunks; i++)
+	{
+		jobs[i] = *proto;
+		jobs[i].cells = cells + (size_t)i * WAVEFRONT_CHUNK;
+		jobs[i].count = i + 1 < chunks ? WAVEFRONT_CHUNK : count - i * WAVEFRONT_CHUNK;
+	}
+	cgsme_pool_run(pool, runWavefrontJob, jobs, sizeof(WavefrontJob), chunks);
+}
+
+bool solveWavefront(uint16_t **gridLayer, uint32_t width, uint32_t length, uint32_t fulness, float *rates, int *collapsed,
+					int target, CellIndex *open, CellStack *forced, CgsmeRng *rng, CgsmePool *pool, CgsmeArena *arena, uint32_t *outReseeds)
+{
+	CGSME_PROFILE_FUNC();
+	ArenaMark mark = arenaGetMark(arena);
+	uint32_t cellCount = width * length;
+	uint32_t half = cellCount / 2 + 1; // most tiles one colour can have
+
+	uint8_t *flags = arenaCalloc(arena, cellCount, sizeof(uint8_t));
+	uint32_t *frontier[2] = {arenaAlloc(arena, sizeof(uint32_t) * half), arenaAlloc(arena, sizeof(uint32_t) * half)};
+	uint32_t frontierCount[2] = {0, 0};
+	uint32_t *batch = arenaAlloc(arena, sizeof(uint32_t) * half);
+	uint32_t *sources = arenaAlloc(arena, sizeof(uint32_t) * half); // decided tiles whose neighbours are pulled
+	uint32_t *pulled = arenaAlloc(arena, sizeof(uint32_t) * half);
+	WavefrontJob *jobs = arenaAlloc(arena, sizeof(WavefrontJob) * (half / WAVEFRONT_CHUNK + 1));
+	if (!flags || !frontier[0] || !frontier[1] || !batch || !sources || !pulled || !jobs)
+	{
+		arenaRelease(arena, mark);
+		return false;
+	}
+
+	// first frontier: open tiles next to a decided one (voids, stairs, the center seed).
+	// the ring is left out like in the queue schedulers, growth starts inside the layer
+	for (uint32_t y = 0; y < length; y++)
+	{
+		for (uint32_t x = 0; x < width; x++)
+		{
+			if (__builtin_popcount(gridLayer[y][x]) <= 1)
+				continue;
+			bool nextToDecided = (y > 0 && __builtin_popcount(gridLayer[y - 1][x]) <= 1) ||
+								 (y + 1 < length && __builtin_popcount(gridLayer[y + 1][x]) <= 1) ||
+								 (x > 0 && __builtin_popcount(gridLayer[y][x - 1]) <= 1) ||
+								 (x + 1 < width && __builtin_popcount(gridLayer[y][x + 1]) <= 1);
+			if (nextToDecided)
+			{
+				uint32_t cell = y * width + x;
+				flags[cell] = WF_PENDING;
+				frontier[(x + y) & 1][frontierCount[(x + y) & 1]++] = cell;
+			}
+		}
+	}
+
+	WavefrontJob proto = {gridLayer, NULL, 0, width, NULL, *rng};
+	uint32_t colour = 0;
+	uint32_t sourceCount = 0; // sources are always of the current colour
+	uint32_t idle = 0;		  // rounds in a row without work, 2 = both colours are done
+	uint32_t reseeds = 0;
+	uint64_t maxRounds = (uint64_t)cellCount * 4 + 16;
+
+	for (uint64_t round = 0; *collapsed < target && round < maxRounds; round++)
+	{
+		if (idle >= 2)
+		{
+			// both frontiers ran dry: reseed like the queue schedulers
+			uint32_t sx, sy;
+			if (!findBestSeedLocation(gridLayer, width, length, open, &sx, &sy, rng))
+				break;
+			reseeds++;
+			gridLayer[sy][sx] = widestTile(gridLayer[sy][sx]);
+			(*collapsed)++;
+			colour = (sx + sy) & 1;
+			sources[0] = sy * width + sx;
+			sourceCount = 1;
+			idle = 0;
+		}
+
+		// Only use dynamic pacing if NOT in mask mode
+		if (fulness >= 100)
+			update_spawnrates(rates, *collapsed, target);
+
+		// 1. BATCH: the lowest entropy band of this colour's frontier, solved tiles are dropped
+		uint32_t *list = frontier[colour];
+		uint32_t kept = 0;
+		int lowest = 17;
+		for (uint32_t i = 0; i < frontierCount[colour]; i++)
+		{
+			uint32_t cell = list[i];
+			int options = __builtin_popcount(gridLayer[cell / width][cell % width]);
+			if (options <= 1)
+			{
+				flags[cell] &= (uint8_t)~WF_PENDING;
+				continue;
+			}
+			lowest = options < lowest ? options : lowest;
+			list[kept++] = cell;
+		}
+		uint32_t batchCount = 0;
+		frontierCount[colour] = 0;
+		for (uint32_t i = 0; i < kept; i++)
+		{
+			uint32_t cell = list[i];
+			if (__builtin_popcount(gridLayer[cell / width][cell % width]) <= lowest + WAVEFRONT_ENTROPY_BAND)
+			{
+				flags[cell] &= (uint8_t)~WF_PENDING;
+				batch[batchCount++] = cell;
+			}
+			else
+				list[frontierCount[colour]++] = cell;
+		}
+
+		if (batchCount == 0 && sourceCount == 0)
+		{
+			idle++;
+			colour ^= 1;
+			continue;
+		}
+		idle = 0;
+
+		// 2. COLLAPSE the batch (no two of them are neighbours)
+		proto.rates = rates;
+		runWavefrontStep(pool, jobs, &proto, batch, batchCount);
+		for (uint32_t i = 0; i < batchCount; i++)
+			sources[sourceCount++] = batch[i];
+		*collapsed += (int)batchCount;
+
+		// 3. PULL: the open neighbours of everything decided this round narrow against all sides
+		uint32_t pulledCount = 0;
+		for (uint32_t i = 0; i < sourceCount; i++)
+		{
+			uint32_t cell = sources[i];
+			uint32_t x = cell % width;
+			uint32_t y = cell / width;
+			uint32_t around[4] = {cell - width, cell + width, cell - 1, cell + 1};
+			bool inside[4] = {y > 0, y + 1 < length, x > 0, x + 1 < width};
+			for (int d = 0; d < 4; d++)
+			{
+				uint32_t n = around[d];
+				if (inside[d] && !(flags[n] & WF_TOUCHED) && __builtin_popcount(gridLayer[n / width][n % width]) > 1)
+				{
+					flags[n] |= WF_TOUCHED;
+					pulled[pulledCount++] = n;
+				}
+			}
+		}
+		proto.rates = NULL;
+		runWavefrontStep(pool, jobs, &proto, pulled, pulledCount);
+
+		// 4. MERGE: tiles the pull decided (forced or void) are the next round's sources, the
+		// rest joins the frontier of the other colour
+		uint32_t other = colour ^ 1;
+		sourceCount = 0;
+		for (uint32_t i = 0; i < pulledCount; i++)
+		{
+			uint32_t cell = pulled[i];
+			int options = __builtin_popcount(gridLayer[cell / width][cell % width]);
+			flags[cell] &= (uint8_t)~WF_TOUCHED;
+			if (options <= 1)
+			{
+				*collapsed += options;
+				sources[sourceCount++] = cell;
+			}
+			else if (!(flags[cell] & WF_PENDING))
+			{
+				flags[cell] |= WF_PENDING;
+				frontier[other][frontierCount[other]++] = cell;
+			}
+		}
+
+		// VOID LOGIC (Only for Ocean Mode), on the last batch like the queue schedulers
+		if (fulness >= 100 && *collapsed >= target)
+		{
+			for (uint32_t i = 0; i < batchCount; i++)
+			{
+				uint32_t x = batch[i] % width;
+				uint32_t y = batch[i] / width;
+				if (!isTileRequired(gridLayer, width, length, x, y))
+				{
+					gridLayer[y][x] = Empty_Tile;
+					updateNeighbours(gridLayer, width, length, x, y, NULL, NULL, NULL, forced);
+					(*collapsed)--;
+				}
+			}
+		}
+
+		colour = other;
+	}
+
+	*outReseeds = reseeds;
+	arenaRelease(arena, mark);
+	return true;
+}
@@ -0,0 +1,44 @@
+#ifndef CGSME_WAVEFRONT_H
+#define CGSME_WAVEFRONT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "cgsme_utils.h"
+#include "cgsme_pool.h"
+#include "threadRandom.h"
+#include "tiles.h"
+
+// WAVEFRONT SCHEDULER (CGSME_SCHEDULER_WAVEFRONT)
+// instead of one tile per step in entropy order, the frontier is collapsed in rounds. the layer
+// is coloured like a checkerboard ((x + y) & 1); tiles of one colour are never 4-neighbours, so
+// a round collapses every frontier tile of the current colour within WAVEFRONT_ENTROPY_BAND
+// options of the lowest entropy at once, then narrows their open neighbours (the other colour)
+// by pulling from all four sides. both steps only write the tile they work on and read tiles
+// that stay fixed during the step, so they run as chunks on the worker pool. every tile draws
+// from its own stream split off the solver stream, so the result does not depend on the pool.
+
+// a round takes the frontier tiles with at most this many options more than the lowest one
+#define WAVEFRONT_ENTROPY_BAND 4
+
+// tiles per pool job, smaller batches run on the calling thread
+#define WAVEFRONT_CHUNK 4096
+
+/// @brief Solve a padded layer whose initial constraints are already propagated (see solveLayer).
+/// @param gridLayer Padded layer, solved in place.
+/// @param width Layer width.
+/// @param length Layer length.
+/// @param fulness Fulness percentage (>= 100 paces the spawn rates and removes unneeded tiles at the end).
+/// @param rates Spawn rates (NUM_TILE_TYPES), updated while pacing.
+/// @param collapsed In/out, number of collapsed tiles.
+/// @param target Number of tiles to collapse.
+/// @param open Index of the tiles still in superposition (reseed search).
+/// @param forced Scratch of width * length cells for updateNeighbours (removing unneeded tiles).
+/// @param rng Solver stream: reseeds draw from it, collapses from per-tile streams split off it.
+/// @param pool Worker pool for the rounds, NULL runs them on the calling thread.
+/// @param arena Arena for the frontier lists (released before returning).
+/// @param outReseeds Output, number of reseeds.
+/// @return false if the arena is out of memory.
+bool solveWavefront(uint16_t **gridLayer, uint32_t width, uint32_t length, uint32_t fulness, float *rates, int *collapsed,
+					int target, CellIndex *open, CellStack *forced, CgsmeRng *rng, CgsmePool *pool, CgsmeArena *arena, uint32_t *outReseeds);
+
+#endif // CGSME_WAVEFRONT_H
@@ -19,14 +19,18 @@
 #include "cgsme_noise.h"
 #include "cgsme_topology.h"
 #include "cgsme_solver.h"
+#include "cgsme_wavefront.h"
+#include "cgsme_pool.h"
+#include "cgsme_context.h"
+#include <string.h>
 
 #ifndef __linux__
 #define MAX(a, b) ((a) > (b) ? a : b)
 #define MIN(a, b) ((a) < (b) ? a : b)
 #endif
 
-uint16_t ***globalGrid;
-uint32_t w, l;
+// library owned worker pool (NULL = spawn a thread per layer)
+static CgsmePool *g_workerPool = NULL;
 
 /// Generate a 3D grid using Wave Function Collapse (WFC).
 ///
@@ -47,8 +51,9 @@ uint32_t w, l;
 ///
 /// Behavior / Notes:
 ///     - Allocates memory with `malloc` for the top-level array, each layer,
-///       and each row, then spawns one thread per layer via `thrd_create` to
-///       run `generateLayerThread`.
+///       and each row, then runs `generateLayerThread` once per layer, either
+///       on the worker pool (see `cgsme_init_workers`) or, if no pool is
+///       running, on one freshly spawned thread per layer via `thrd_create`.
 ///     - The function currently does not perform robust malloc error handling;
 ///       partial allocation may lead to undefined behavior if memory allocation
 ///       fails.
@@ -73,28 +78,10 @@ void freeGrid(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t height
 //     args - pointer to a `layerGenerationArgs` struct (defined in generator.h).
 // Returns:
 //     thrd-compatible int (thread return code). Populates the provided
-//     `gridLayer` inside `args` and uses a per-thread RNG seeded from
-//     `args->seed`.
+//     `gridLayer` inside `args` and uses RNG streams keyed by
+//     (`args->seed`, `args->layerIndex`).
 int generateLayerThread(void *args);
 
-/// Clean reachable tiles starting from (x,y) inside a single layer.
-///
-/// Parameters:
-///     gridLayer - pointer to the layer (2D array indexed as [y][x]).
-///     width     - number of columns.
-///     length    - number of rows.
-///     x, y      - starting coordinates for the cleaning flood-fill.
-///
-/// Behavior:
-///     - Performs a recursive flood-fill over tiles reachable from (x,y) by
-///       following open connections (uses directional masks such as
-///       `North_Open_Mask`).
-///     - Marks visited tiles by inverting their bits in-place (the
-///       implementation flips bits to indicate visitation).
-///     - Performs bounds checks and stops at tiles that are already
-///       multi-state (popcount > 1) or outside the grid.
-void cleanGrid(uint16_t **gridLayer, uint32_t width, uint32_t length, uint32_t x, uint32_t y);
-
 void printProgressBar(int percentage)
 {
     CGSME_PROFILE_FUNC(); // bugg
@@ -115,19 +102,12 @@ void printProgressBar(int percentage)
     fflush(stdout);
 }
 
-// EDGE FIXUP LOGIC
-
-// Internal flags for direction manipulation (N=1, E=2, S=4, W=8)
-#define DIR_N 1
-#define DIR_E 2
-#define DIR_S 4
-#define DIR_W 8
-
 // ARCHITECT LOGIC (pre-seeding)
-// runs purely on the main thread before any threads are spawned
-void runArchitect(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t height, uint32_t fulness, uint32_t seed)
+// runs purely on the calling thread before any layer job starts, all randomness comes from `seed`
+void runArchitect(cgsme_context *ctx, uint16_t ***grid, uint32_t width, uint32_t length, uint32_t height, uint32_t fulness, uint32_t seed)
 {
     CGSME_PROFILE_FUNC();
+    uint64_t startUs = monotonicUs();
 
     // because of calloc the grid is already initialized to Empty_Tile (0)
 
@@ -136,7 +116,7 @@ void runArchitect(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t he
     {
         // the generator will write All_Possible_State (65535)
         // to valid locations. everything else stays 0
-        generateRidgedMask(grid, width, length, height, fulness, seed);
+        generateRidgedMask(grid, width, length, height, fulness, seed, &ctx->mainArena);
     }
     else
     {
@@ -145,6 +125,8 @@ void runArchitect(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t he
                 for (uint32_t x = 0; x < width; x++)
                     grid[z][y][x] = All_Possible_State;
     }
+    uint64_t maskEndUs = monotonicUs();
+    ctx->maskUs = maskEndUs - startUs;
 
     // place stairs
     int stairsPerLayer = (width * length) / 400;
@@ -156,12 +138,13 @@ void runArchitect(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t he
         int placedCount = 0;
         int attempts = 0;
         int maxAttempts = stairsPerLayer * 20;
+        CgsmeRng stairRng = cgsme_rng_init(seed, z, 0, CGSME_RNG_ARCHITECT);
 
         while (placedCount < stairsPerLayer && attempts < maxAttempts)
         {
             attempts++;
-            int x = rand() % width;
-            int y = rand() % length;
+            int x = cgsme_rng_bounded(&stairRng, width);
+            int y = cgsme_rng_bounded(&stairRng, length);
 
             // bounds
             if (x < 1 || y < 1 || x >= width - 1 || y >= length - 1)
@@ -184,21 +167,33 @@ void runArchitect(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t he
             placedCount++;
         }
     }
+    ctx->architectUs = monotonicUs() - maskEndUs;
 }
 
-int generateLayerThread(void *args)
+// queue the neighbours of (x,y) that are still in superposition (the void ring never is)
+static void pushOpenNeighbours(EntropyQueue *queue, uint16_t **gridLayer, uint32_t x, uint32_t y, float **distMap, CgsmeRng *rng)
 {
-    CGSME_PROFILE_FUNC();
-    layerGenerationArgs *arg = (layerGenerationArgs *)args;
-    uint16_t **gridLayer = arg->gridLayer;
-    uint32_t width = arg->width;
-    uint32_t length = arg->length;
-    int32_t startX = arg->startX;
-    int32_t startY = arg->startY;
-    uint32_t seed = arg->seed;
-    uint32_t fulness = arg->fulness;
+    int32_t cx = (int32_t)x;
+    int32_t cy = (int32_t)y;
+    if (__builtin_popcount(gridLayer[cy - 1][cx]) > 1)
+        entropyQueuePush(queue, gridLayer, x, y - 1, distMap, rng);
+    if (__builtin_popcount(gridLayer[cy + 1][cx]) > 1)
+        entropyQueuePush(queue, gridLayer, x, y + 1, distMap, rng);
+    if (__builtin_popcount(gridLayer[cy][cx - 1]) > 1)
+        entropyQueuePush(queue, gridLayer, x - 1, y, distMap, rng);
+    if (__builtin_popcount(gridLayer[cy][cx + 1]) > 1)
+        entropyQueuePush(queue, gridLayer, x + 1, y, distMap, rng);
+}
 
-    uint32_t rngState = seed;
+// SOLVER
+// solves one padded layer in place: the whole layer, or one window of it (tile / seam strip)
+// in tiled mode. the ring around it is what the edges propagate against: void (0) at the map
+// border, the neighbouring tiles once they are solved. the wavefront scheduler runs its rounds
+// on `pool` (may be NULL).
+static bool solveLayer(uint16_t **gridLayer, uint32_t width, uint32_t length, int32_t startX, int32_t startY, uint32_t fulness, cgsme_scheduler scheduler, CgsmePool *pool, CgsmeRng rng, CgsmeArena *arena, uint32_t *outReseeds)
+{
+    CGSME_PROFILE_FUNC();
+    ArenaMark mark = arenaGetMark(arena);
 
     // --- WEIGHTS CONFIGURATION ---
     float current_spawnrates[NUM_TILE_TYPES];
@@ -219,6 +214,20 @@ int generateLayerThread(void *args)
             current_spawnrates[i] = 1.0f / (float)NUM_TILE_TYPES;
     }
 
+    // 1. DISTANCE MAP (Initialized to 0 if Mask Mode to prevent bias, or standard calculation)
+    float **distMap = arenaAlloc(arena, sizeof(float *) * length);
+    float *distData = arenaAlloc(arena, sizeof(float) * width * length);
+    // the wavefront scheduler has no queue, it keeps its own frontier lists
+    bool wavefront = scheduler == CGSME_SCHEDULER_WAVEFRONT;
+    EntropyQueue *queue = wavefront ? NULL : initEntropyQueue(width, length, scheduler == CGSME_SCHEDULER_HEAP, arena);
+    CellIndex *open = initCellIndex(width * length, arena);
+    CellStack *forced = initCellStack(width * length, arena);
+    if (!distMap || !distData || (!queue && !wavefront) || !open || !forced)
+    {
+        arenaRelease(arena, mark);
+        return false;
+    }
+
     // --- EXACT TARGET COUNTING ---
     // Count exact mask size
     int target_collapsed_count = 0;
@@ -233,11 +242,9 @@ int generateLayerThread(void *args)
 
     int valid_collapsed_count = 0;
 
-    // 1. DISTANCE MAP (Initialized to 0 if Mask Mode to prevent bias, or standard calculation)
-    float **distMap = malloc(sizeof(float *) * length);
     for (uint32_t i = 0; i < length; i++)
     {
-        distMap[i] = malloc(sizeof(float) * width);
+        distMap[i] = &distData[(size_t)i * width];
         for (uint32_t j = 0; j < width; j++)
         {
             // If Mask Mode, we don't want center-bias, we want mask-bias.
@@ -249,9 +256,27 @@ int generateLayerThread(void *args)
         }
     }
 
-    MinHeap *heap = initHeap(width, length);
-
     // 2. INIT & CONSTRAINT PROPAGATION
+    // the ring first: edge tiles lose every port that leads off the map (void ring) and take
+    // the ports a solved neighbour window demands. they are not queued, the solver still grows
+    // from the voids / the center like before
+    int32_t lastRow = (int32_t)length - 1;
+    int32_t lastCol = (int32_t)width - 1;
+    for (int32_t j = 0; j < (int32_t)width; j++)
+    {
+        if (__builtin_popcount(gridLayer[0][j]) > 1)
+            gridLayer[0][j] &= PROPAGATION_MASKS[propagationRow(gridLayer[-1][j])][2]; // south neighbour of the ring
+        if (__builtin_popcount(gridLayer[lastRow][j]) > 1)
+            gridLayer[lastRow][j] &= PROPAGATION_MASKS[propagationRow(gridLayer[lastRow + 1][j])][0];
+    }
+    for (int32_t i = 0; i < (int32_t)length; i++)
+    {
+        if (__builtin_popcount(gridLayer[i][0]) > 1)
+            gridLayer[i][0] &= PROPAGATION_MASKS[propagationRow(gridLayer[i][-1])][1];
+        if (__builtin_popcount(gridLayer[i][lastCol]) > 1)
+            gridLayer[i][lastCol] &= PROPAGATION_MASKS[propagationRow(gridLayer[i][lastCol + 1])][3];
+    }
+
     for (uint32_t i = 0; i < length; i++)
     {
         for (uint32_t j = 0; j < width; j++)
@@ -259,33 +284,43 @@ int generateLayerThread(void *args)
             if (gridLayer[i][j] == Empty_Tile)
             {
                 // Mask Void: Tell neighbors "I am a wall"
-                updateNeighbours(gridLayer, width, length, j, i, heap, distMap, &rngState);
+                updateNeighbours(gridLayer, width, length, j, i, queue, distMap, &rng, forced);
             }
             else if (__builtin_popcount(gridLayer[i][j]) == 1)
             {
                 // Pre-placed Stairs: Propagate constraints
                 valid_collapsed_count++;
-                updateNeighbours(gridLayer, width, length, j, i, heap, distMap, &rngState);
+                updateNeighbours(gridLayer, width, length, j, i, queue, distMap, &rng, forced);
             }
         }
     }
 
+    // every tile still open after propagation, the reseed search skips the rest
+    for (uint32_t i = 0; i < length; i++)
+        for (uint32_t j = 0; j < width; j++)
+            if (__builtin_popcount(gridLayer[i][j]) > 1)
+                cellIndexSet(open, i * width + j);
+    uint32_t reseeds = 0;
+
     // 3. SEED CENTER (If valid)
+    // seeds take the most open tile still allowed (Normal X unless a void or an edge is next to it)
     if (gridLayer[startY][startX] != Empty_Tile && __builtin_popcount(gridLayer[startY][startX]) > 1)
     {
-        gridLayer[startY][startX] = Normal_X_Corridor;
-        updateNeighbours(gridLayer, width, length, startX, startY, heap, distMap, &rngState);
+        gridLayer[startY][startX] = widestTile(gridLayer[startY][startX]);
+        updateNeighbours(gridLayer, width, length, startX, startY, queue, distMap, &rng, forced);
         valid_collapsed_count++;
 
-        // Add neighbors to heap to kickstart
-        if (startY > 0)
-            heapInsertOrUpdate(heap, gridLayer, startX, startY - 1, distMap, &rngState);
-        if (startY < length - 1)
-            heapInsertOrUpdate(heap, gridLayer, startX, startY + 1, distMap, &rngState);
-        if (startX > 0)
-            heapInsertOrUpdate(heap, gridLayer, startX - 1, startY, distMap, &rngState);
-        if (startX < width - 1)
-            heapInsertOrUpdate(heap, gridLayer, startX + 1, startY, distMap, &rngState);
+        // Add neighbors to the queue to kickstart
+        if (queue)
+            pushOpenNeighbours(queue, gridLayer, startX, startY, distMap, &rng);
+    }
+
+    if (wavefront)
+    {
+        bool ok = solveWavefront(gridLayer, width, length, fulness, current_spawnrates, &valid_collapsed_count,
+                                 target_collapsed_count, open, forced, &rng, pool, arena, outReseeds);
+        arenaRelease(arena, mark);
+        return ok;
     }
 
     // High safety limit for complex masks
@@ -304,32 +339,26 @@ int generateLayerThread(void *args)
         }
 
         uint32_t cx, cy;
-        bool found = heapPop(heap, gridLayer, &cx, &cy);
+        bool found = entropyQueuePop(queue, gridLayer, &cx, &cy, &rng);
 
         if (!found)
         {
             // HEAP EMPTY: Reseed using AGGRESSIVE finder
             // This will pick any tile inside the mask that isn't solved yet
-            if (findBestSeedLocation(gridLayer, width, length, distMap, &cx, &cy, &rngState))
+            if (findBestSeedLocation(gridLayer, width, length, open, &cx, &cy, &rng))
             {
                 found = true;
+                reseeds++;
 
-                // Force seed a tile type (Normal X is flexible)
+                // Force seed a tile type (the most open one still allowed, X is flexible)
                 if (__builtin_popcount(gridLayer[cy][cx]) > 1)
                 {
-                    gridLayer[cy][cx] = Normal_X_Corridor;
-                    updateNeighbours(gridLayer, width, length, cx, cy, heap, distMap, &rngState);
+                    gridLayer[cy][cx] = widestTile(gridLayer[cy][cx]);
+                    updateNeighbours(gridLayer, width, length, cx, cy, queue, distMap, &rng, forced);
                     valid_collapsed_count++;
 
                     // Add neighbors
-                    if (cy > 0)
-                        heapInsertOrUpdate(heap, gridLayer, cx, cy - 1, distMap, &rngState);
-                    if (cy < length - 1)
-                        heapInsertOrUpdate(heap, gridLayer, cx, cy + 1, distMap, &rngState);
-                    if (cx > 0)
-                        heapInsertOrUpdate(heap, gridLayer, cx - 1, cy, distMap, &rngState);
-                    if (cx < width - 1)
-                        heapInsertOrUpdate(heap, gridLayer, cx + 1, cy, distMap, &rngState);
+                    pushOpenNeighbours(queue, gridLayer, cx, cy, distMap, &rng);
 
                     continue; // Skip the collapse step for this iteration
                 }
@@ -344,8 +373,8 @@ int generateLayerThread(void *args)
         // Collapse
         if (__builtin_popcount(gridLayer[cy][cx]) > 1)
         {
-            collapseTile(&gridLayer[cy][cx], current_spawnrates, &rngState);
-            updateNeighbours(gridLayer, width, length, cx, cy, heap, distMap, &rngState);
+            collapseTile(&gridLayer[cy][cx], current_spawnrates, &rng);
+            updateNeighbours(gridLayer, width, length, cx, cy, queue, distMap, &rng, forced);
 
             // Note: Because updateNeighbours now revives dead tiles, gridLayer will never be Empty_Tile
             // unless it was Mask Void. It will be All_Possible if it failed.
@@ -353,16 +382,9 @@ int generateLayerThread(void *args)
                 valid_collapsed_count++;
         }
 
-        // Add neighbors to heap
+        // Add neighbors to the queue
         // Only add if they are still uncollapsed candidates
-        if (cy > 0 && __builtin_popcount(gridLayer[cy - 1][cx]) > 1)
-            heapInsertOrUpdate(heap, gridLayer, cx, cy - 1, distMap, &rngState);
-        if (cy < length - 1 && __builtin_popcount(gridLayer[cy + 1][cx]) > 1)
-            heapInsertOrUpdate(heap, gridLayer, cx, cy + 1, distMap, &rngState);
-        if (cx > 0 && __builtin_popcount(gridLayer[cy][cx - 1]) > 1)
-            heapInsertOrUpdate(heap, gridLayer, cx - 1, cy, distMap, &rngState);
-        if (cx < width - 1 && __builtin_popcount(gridLayer[cy][cx + 1]) > 1)
-            heapInsertOrUpdate(heap, gridLayer, cx + 1, cy, distMap, &rngState);
+        pushOpenNeighbours(queue, gridLayer, cx, cy, distMap, &rng);
 
         // VOID LOGIC (Only for Ocean Mode)
         // If we hit target count in non-masked mode, start deleting unnecessary tiles
@@ -371,50 +393,382 @@ int generateLayerThread(void *args)
             if (!isTileRequired(gridLayer, width, length, cx, cy))
             {
                 gridLayer[cy][cx] = Empty_Tile;
-                updateNeighbours(gridLayer, width, length, cx, cy, heap, distMap, &rngState);
+                updateNeighbours(gridLayer, width, length, cx, cy, queue, distMap, &rng, forced);
                 valid_collapsed_count--; // Adjust count
             }
         }
     }
 
+    *outReseeds = reseeds;
+    arenaRelease(arena, mark);
+    return true;
+}
+
+// TILED MODE
+// a layer is cut into tiles that are solved concurrently, each walled in by void. then the
+// seams are re-solved: every strip of 2 * SEAM_HALF cells across a seam is reset to the
+// architect's state and solved again against the solved cells on both sides (vertical seams
+// first, then horizontal ones, which also cross the vertical strips). windows solved at the
+// same time never touch each other's cells or rings, and every window has its own stream, so
+// the result only depends on the seed and the tile size, not on the thread count.
+#define SEAM_HALF 2
+
+typedef struct
+{
+    uint16_t **work;       // padded working layer (whole layer)
+    uint16_t **arch;       // architect's layer, what a window starts from
+    uint16_t **ringSource; // where the ring is read: arch for tiles, work for seam strips
+    uint32_t layerWidth, layerLength;
+    uint32_t x0, y0, width, length;
+    uint32_t fulness;
+    cgsme_scheduler scheduler;
+    CgsmeRng rng;
+    cgsme_context *ctx;
+    uint32_t layerIndex;
+    uint32_t reseeds; // out
+    int result;       // out, 0 = ok
+} WindowJob;
+
+static int solveWindowJob(void *args)
+{
+    CGSME_PROFILE_FUNC();
+    WindowJob *job = (WindowJob *)args;
+    CgsmeArena *arena = contextAcquireLayerArena(job->ctx);
+    if (!arena)
+    {
+        job->result = -1;
+        return -1;
+    }
+    ArenaMark mark = arenaGetMark(arena);
+    uint32_t w = job->width, l = job->length;
+
+    uint16_t **sub = allocPaddedLayer(w, l, arena);
+    if (!sub)
+    {
+        contextReleaseLayerArena(job->ctx, arena);
+        job->result = -1;
+        return -1;
+    }
+
+    // interior from the architect, ring from the surroundings. the map border stays void and
+    // cells that are not decided (still open) count as void too
+    for (int32_t y = -1; y <= (int32_t)l; y++)
+    {
+        int64_t gy = (int64_t)job->y0 + y;
+        bool inside = y >= 0 && y < (int32_t)l;
+        for (int32_t x = -1; x <= (int32_t)w; x++)
+        {
+            int64_t gx = (int64_t)job->x0 + x;
+            if (inside && x >= 0 && x < (int32_t)w)
+                sub[y][x] = job->arch[gy][gx];
+            else if (gy >= 0 && gx >= 0 && gy < job->layerLength && gx < job->layerWidth)
+            {
+                uint16_t v = job->ringSource[gy][gx];
+                sub[y][x] = __builtin_popcount(v) <= 1 ? v : Empty_Tile;
+            }
+        }
+    }
+
+    bool ok = solveLayer(sub, w, l, (int32_t)w / 2, (int32_t)l / 2, job->fulness, job->scheduler, job->ctx->pool, job->rng, arena, &job->reseeds);
+    if (ok)
+        for (uint32_t y = 0; y < l; y++)
+            memcpy(&job->work[job->y0 + y][job->x0], sub[y], sizeof(uint16_t) * w);
+
+    arenaRelease(arena, mark);
+    contextReleaseLayerArena(job->ctx, arena);
+    job->result = ok ? 0 : -1;
+    return job->result;
+}
+
+// windows of one phase run concurrently on the pool (serially without one), each in a slot of
+// its own
+static bool runWindowJobs(cgsme_context *ctx, WindowJob *jobs, uint32_t count, uint32_t *reseeds)
+{
+    if (ctx->pool)
+        cgsme_pool_run(ctx->pool, solveWindowJob, jobs, sizeof(WindowJob), count);
+    else
+        for (uint32_t i = 0; i < count; i++)
+            solveWindowJob(&jobs[i]);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if (jobs[i].result != 0)
+            return false;
+        *reseeds += jobs[i].reseeds;
+    }
+    return true;
+}
+
+// even split of `size` cells into pieces of about `tile` (at least one piece)
+static uint32_t tileCount(uint32_t size, uint32_t tile)
+{
+    uint32_t n = (size + tile / 2) / tile;
+    return n ? n : 1;
+}
+
+static uint32_t tileStart(uint32_t size, uint32_t count, uint32_t i)
+{
+    return (uint32_t)((uint64_t)size * i / count);
+}
+
+// tiles are only worth it when there is more than one
+static bool layerIsTiled(uint32_t width, uint32_t length, uint32_t tileSize)
+{
+    return tileSize && (tileCount(width, tileSize) > 1 || tileCount(length, tileSize) > 1);
+}
+
+static bool solveLayerTiled(layerGenerationArgs *arg, uint16_t **gridLayer, uint32_t tileSize, CgsmeArena *arena, uint32_t *outReseeds)
+{
+    CGSME_PROFILE_FUNC();
+    uint32_t width = arg->width, length = arg->length;
+    uint32_t cols = tileCount(width, tileSize);
+    uint32_t rows = tileCount(length, tileSize);
+    uint32_t maxJobs = cols * rows;
+    if (cols - 1 > maxJobs)
+        maxJobs = cols - 1;
+    if (rows - 1 > maxJobs)
+        maxJobs = rows - 1;
+
+    ArenaMark mark = arenaGetMark(arena);
+    WindowJob *jobs = arenaAlloc(arena, sizeof(WindowJob) * maxJobs);
+    if (!jobs)
+        return false;
+
+    WindowJob proto = {gridLayer, arg->gridLayer, arg->gridLayer, width, length, 0, 0, 0, 0, arg->fulness,
+                       arg->ctx->scheduler, {0, 0}, arg->ctx, arg->layerIndex, 0, 0};
+    uint32_t window = 0; // stream index, stable across phases
+    uint32_t reseeds = 0;
+    bool ok = true;
+
+    // 1. tiles, walled in by the architect's state of their surroundings
+    for (uint32_t ty = 0; ty < rows; ty++)
+    {
+        for (uint32_t tx = 0; tx < cols; tx++)
+        {
+            WindowJob *job = &jobs[ty * cols + tx];
+            *job = proto;
+            job->x0 = tileStart(width, cols, tx);
+            job->y0 = tileStart(length, rows, ty);
+            job->width = tileStart(width, cols, tx + 1) - job->x0;
+            job->length = tileStart(length, rows, ty + 1) - job->y0;
+            job->rng = cgsme_rng_init(arg->seed, arg->layerIndex, ++window, CGSME_RNG_SOLVER);
+        }
+    }
+    ok = runWindowJobs(arg->ctx, jobs, cols * rows, &reseeds);
+
+    // 2. vertical seams (full length strips), 3. horizontal seams (full width strips)
+    proto.ringSource = gridLayer;
+    for (int pass = 0; pass < 2 && ok; pass++)
+    {
+        uint32_t seams = pass == 0 ? cols - 1 : rows - 1;
+        for (uint32_t i = 0; i < seams; i++)
+        {
+            WindowJob *job = &jobs[i];
+            *job = proto;
+            if (pass == 0)
+            {
+                job->x0 = tileStart(width, cols, i + 1) - SEAM_HALF;
+                job->width = 2 * SEAM_HALF;
+                job->length = length;
+            }
+            else
+            {
+                job->y0 = tileStart(length, rows, i + 1) - SEAM_HALF;
+                job->length = 2 * SEAM_HALF;
+                job->width = width;
+            }
+            job->rng = cgsme_rng_init(arg->seed, arg->layerIndex, ++window, CGSME_RNG_SOLVER);
+        }
+        ok = runWindowJobs(arg->ctx, jobs, seams, &reseeds);
+    }
+
+    arenaRelease(arena, mark);
+    *outReseeds = reseeds;
+    return ok;
+}
+
+static int generateLayer(layerGenerationArgs *arg, CgsmeArena *arena)
+{
+    uint64_t startUs = monotonicUs();
+    uint16_t **outLayer = arg->gridLayer;
+    uint32_t width = arg->width;
+    uint32_t length = arg->length;
+
+    // independent streams per consumer, none of them depends on another layer
+    CgsmeRng rng = cgsme_rng_init(arg->seed, arg->layerIndex, 0, CGSME_RNG_SOLVER);
+    CgsmeRng welderRng = cgsme_rng_init(arg->seed, arg->layerIndex, 0, CGSME_RNG_WELDER);
+
+    ArenaMark mark = arenaGetMark(arena);
+
+    // 0. WORKING LAYER
+    // solved in a padded copy: the void ring around it is what the edges propagate against,
+    // so no neighbour access on the hot paths needs a bounds check
+    uint16_t **gridLayer = allocPaddedLayer(width, length, arena);
+    if (!gridLayer)
+    {
+        arenaRelease(arena, mark);
+        return -1;
+    }
+    for (uint32_t y = 0; y < length; y++)
+        memcpy(gridLayer[y], outLayer[y], sizeof(uint16_t) * width);
+
+    // 1-4. SOLVE, in one piece or in tiles
+    uint32_t tileSize = arg->ctx->tileSize;
+    uint32_t reseeds = 0;
+    bool solved;
+    if (layerIsTiled(width, length, tileSize))
+        solved = solveLayerTiled(arg, gridLayer, tileSize, arena, &reseeds);
+    else
+        solved = solveLayer(gridLayer, width, length, arg->startX, arg->startY, arg->fulness,
+                            arg->ctx->scheduler, arg->ctx->pool, rng, arena, &reseeds);
+    if (!solved)
+    {
+        arenaRelease(arena, mark);
+        return -1;
+    }
+
+    // each layer owns its slot, no locking needed
+    CgsmeLayerStats *stats = &arg->ctx->layerStats[arg->layerIndex];
+    stats->reseeds = reseeds;
+    uint64_t weldStartUs = monotonicUs();
+    stats->solveUs = weldStartUs - startUs;
+    cgsme_log("layer %u: %u reseeds\n", arg->layerIndex, reseeds);
+
     // 5. CLEANUP & WELDING
     for (uint32_t i = 0; i < length; i++)
     {
         for (uint32_t j = 0; j < width; j++)
         {
             // If anything is still superposition (shouldn't be), kill it
-            if (__builtin_popcount(gridLayer[i][j]) > 1)
+            if (gridLayer[i][j] & (gridLayer[i][j] - 1))
                 gridLayer[i][j] = Empty_Tile;
         }
     }
 
+    // no edge fixup: nothing was ever allowed to open into the ring
     sealMazeEdges(gridLayer, width, length);
-    fixupEdges(gridLayer, width, length);
-    findConnectedRegionsInPlace(gridLayer, width, length);
-    germanWelderInPlace(gridLayer, width, length, &rngState);
 
-    // Free memory
-    freeHeap(heap);
-    for (uint32_t i = 0; i < length; i++)
-        free(distMap[i]);
-    free(distMap);
+    // regions are labeled in their own 32-bit plane, the tiles stay as they are
+    uint32_t **regionLabels = allocPaddedLabels(width, length, arena);
+    if (!regionLabels)
+    {
+        arenaRelease(arena, mark);
+        return -1;
+    }
+    uint32_t regions = findConnectedRegions(gridLayer, regionLabels, width, length, arena);
 
-    // Unpack Regions
+    // straight into the caller's (unpadded) layer, the welder only opens walls in there
     for (uint32_t i = 0; i < length; i++)
+        memcpy(outLayer[i], gridLayer[i], sizeof(uint16_t) * width);
+    germanWelderInPlace(outLayer, regionLabels, regions, width, length, &welderRng, arena);
+    stats->weldUs = monotonicUs() - weldStartUs;
+
+    // Free memory
+    arenaRelease(arena, mark);
+    return 0;
+}
+
+int generateLayerThread(void *args)
+{
+    CGSME_PROFILE_FUNC();
+    layerGenerationArgs *arg = (layerGenerationArgs *)args;
+
+    // all scratch of this layer lives in a slot checked out for the job
+    CgsmeArena *arena = contextAcquireLayerArena(arg->ctx);
+    if (!arena)
     {
-        for (uint32_t j = 0; j < width; j++)
+        arg->result = -1;
+        return -1;
+    }
+    arg->result = generateLayer(arg, arena);
+    contextReleaseLayerArena(arg->ctx, arena);
+    return arg->result;
+}
+
+// shared by generateGrid and cgsme_context_generate: fills an already allocated grid.
+// all scratch memory comes from the context arenas, the layers run on `pool` (NULL = thread per layer).
+static bool runGeneration(cgsme_context *ctx, CgsmePool *pool, uint16_t ***grid, uint32_t width, uint32_t length, uint32_t height, uint32_t seed, uint32_t fulness)
+{
+    CGSME_PROFILE_FUNC();
+    CgsmeArena *arena = &ctx->mainArena;
+    ArenaMark mark = arenaGetMark(arena);
+
+    if (!contextPrepareLayers(ctx, pool, height, layerIsTiled(width, length, ctx->tileSize)))
+    {
+        arenaRelease(arena, mark);
+        return false;
+    }
+
+    // ARCHITECT PHASE
+    runArchitect(ctx, grid, width, length, height, fulness, seed);
+
+    // LAYER GENERATION PHASE (MULTI-THREADING)
+    layerGenerationArgs *args = arenaAlloc(arena, sizeof(layerGenerationArgs) * height);
+    if (!args)
+    {
+        arenaRelease(arena, mark);
+        return false;
+    }
+
+    // standard start point is center
+    int32_t centerX = width / 2;
+    int32_t centerY = length / 2;
+
+    for (uint32_t i = 0; i < height; i++)
+    {
+        // esvery layer attempts to start seeding from the center (and the Architect seeds)
+
+        args[i].gridLayer = grid[i];
+        args[i].width = width;
+        args[i].length = length;
+
+        args[i].startX = centerX;
+        args[i].startY = centerY;
+
+        args[i].endX = centerX;
+        args[i].endY = centerY;
+
+        args[i].seed = seed; // layers key their own streams with (seed, layerIndex)
+        args[i].fulness = fulness;
+        args[i].layerIndex = i;
+        args[i].ctx = ctx;
+        args[i].result = -1; // a layer that never ran failed
+    }
+
+    if (pool)
+    {
+        // persistent workers, blocks until every layer is done
+        cgsme_pool_run(pool, generateLayerThread, args, sizeof(layerGenerationArgs), height);
+    }
+    else
+    {
+        thrd_t *threads = arenaAlloc(arena, sizeof(thrd_t) * height);
+        bool *started = arenaAlloc(arena, sizeof(bool) * height);
+        if (!threads || !started)
         {
-            if (gridLayer[i][j] == 0xFFFF)
-                gridLayer[i][j] = Empty_Tile;
-            else
-            {
-                uint8_t index = gridLayer[i][j] & 0xF;
-                gridLayer[i][j] = indexToMask(index);
-            }
+            arenaRelease(arena, mark);
+            return false;
         }
+
+        for (uint32_t i = 0; i < height; i++)
+            started[i] = thrd_create(&threads[i], generateLayerThread, (void *)&args[i]) == thrd_success;
+
+        // wait for threads
+        for (uint32_t i = 0; i < height; i++)
+            if (started[i])
+                thrd_join(threads[i], NULL);
     }
 
-    return 0;
+    // size the slots this call could reach but did not need this time
+    contextBalanceLayerArenas(ctx);
+
+    // a layer that ran out of scratch left its part of the grid half written
+    bool ok = true;
+    for (uint32_t i = 0; i < height; i++)
+        ok = ok && args[i].result == 0;
+
+    arenaRelease(arena, mark);
+    return ok;
 }
 
 uint16_t ***generateGrid(uint32_t width, uint32_t length, uint32_t height, uint32_t seed, uint32_t fulness)
@@ -429,12 +783,6 @@ uint16_t ***generateGrid(uint32_t width, uint32_t length, uint32_t height, uint3
         return NULL; // fail instead of crashing
     }
 
-    /* overall generator instrumentation */
-#ifdef cgsme_DEBUG
-    uint64_t __cgsme_grid_start = cgsme_now_us();
-    uint64_t __cgsme_grid_start_cycles = cgsme_now_cycles();
-#endif
-
     // uint16_t ***grid = malloc(sizeof(uint16_t **) * height);
 
     // for (int32_t i = 0; i < height; i++)
@@ -467,55 +815,207 @@ uint16_t ***generateGrid(uint32_t width, uint32_t length, uint32_t height, uint3
         }
     }
 
-    srand(seed);
+    cgsme_context *ctx = cgsme_context_create();
+    if (!ctx || !runGeneration(ctx, g_workerPool, grid, width, length, height, seed, fulness))
+    {
+        cgsme_context_destroy(ctx);
+        freeGrid(grid, width, length, height);
+        return NULL;
+    }
+    cgsme_context_destroy(ctx);
 
-    // ARCHITECT PHASE
-    runArchitect(grid, width, length, height, fulness, seed);
+    // the generateGrid row itself comes from the CGSME_PROFILE_FUNC scope above
+    cgsme_profile_set_runinfo(height, width, length, seed, fulness);
 
-    // LAYER GENERATION PHASE (MULTI-THREADING)
-    thrd_t *threads = malloc(sizeof(thrd_t) * height);
-    layerGenerationArgs *args = malloc(sizeof(layerGenerationArgs) * height);
+    return grid;
+}
 
-    // standard start point is center
-    int32_t centerX = width / 2;
-    int32_t centerY = length / 2;
+uint16_t ***cgsme_context_generate(cgsme_context *ctx, uint32_t width, uint32_t length, uint32_t height, uint32_t seed, uint32_t fulness)
+{
+    CGSME_PROFILE_FUNC();
+    if (!ctx || width < 4 || length < 4 || height < 1)
+        return NULL;
 
-    for (uint32_t i = 0; i < height; i++)
+    // grow the owned output grid, it only shrinks when the context dies
+    size_t cells = (size_t)height * length * width;
+    size_t rows = (size_t)height * length;
+    if (cells > ctx->gridDataCap)
     {
-        // esvery layer attempts to start seeding from the center (and the Architect seeds)
+        free(ctx->gridData);
+        ctx->gridData = malloc(sizeof(uint16_t) * cells);
+        ctx->gridDataCap = ctx->gridData ? cells : 0;
+    }
+    if (rows > ctx->gridRowsCap)
+    {
+        free(ctx->gridRows);
+        ctx->gridRows = malloc(sizeof(uint16_t *) * rows);
+        ctx->gridRowsCap = ctx->gridRows ? rows : 0;
+    }
+    if (height > ctx->gridLayersCap)
+    {
+        free(ctx->grid);
+        ctx->grid = malloc(sizeof(uint16_t **) * height);
+        ctx->gridLayersCap = ctx->grid ? height : 0;
+    }
+    if (!ctx->gridData || !ctx->gridRows || !ctx->grid)
+        return NULL;
 
-        args[i].gridLayer = grid[i];
-        args[i].width = width;
-        args[i].length = length;
+    memset(ctx->gridData, 0, sizeof(uint16_t) * cells);
+    for (uint32_t i = 0; i < height; i++)
+    {
+        ctx->grid[i] = &ctx->gridRows[i * length];
+        for (uint32_t j = 0; j < length; j++)
+            ctx->grid[i][j] = &ctx->gridData[((size_t)i * length + j) * width];
+    }
 
-        args[i].startX = centerX;
-        args[i].startY = centerY;
+    if (!runGeneration(ctx, g_workerPool, ctx->grid, width, length, height, seed, fulness))
+        return NULL;
+    return ctx->grid;
+}
 
-        args[i].endX = centerX;
-        args[i].endY = centerY;
+// shared by generateGridInto, cgsme_context_generate_into and the batch: the row tables live in
+// the main arena and point straight into the caller's buffer, the generator never sees a difference.
+static int generateIntoBuffer(cgsme_context *ctx, CgsmePool *pool, uint32_t width, uint32_t length, uint32_t height, uint32_t seed, uint32_t fulness, uint16_t *out, size_t rowStride)
+{
+    if (!ctx || !out || width < 4 || length < 4 || height < 1 || rowStride < width)
+        return -1;
 
-        args[i].seed = nextRandom(&seed); // Use deterministic derivative seeds
-        args[i].fulness = fulness;
-        args[i].layerIndex = i;
+    CgsmeArena *arena = &ctx->mainArena;
+    ArenaMark mark = arenaGetMark(arena);
 
-        thrd_create(&threads[i], generateLayerThread, (void *)&args[i]);
+    uint16_t ***grid = arenaAlloc(arena, sizeof(uint16_t **) * height);
+    uint16_t **rows = arenaAlloc(arena, sizeof(uint16_t *) * height * length);
+    if (!grid || !rows)
+    {
+        arenaRelease(arena, mark);
+        return -1;
     }
 
-    // wait for threads
+    size_t layerStride = rowStride * length;
     for (uint32_t i = 0; i < height; i++)
-        thrd_join(threads[i], NULL);
+    {
+        grid[i] = &rows[(size_t)i * length];
+        for (uint32_t j = 0; j < length; j++)
+        {
+            grid[i][j] = &out[i * layerStride + j * rowStride];
+            // only the used part of the row, padding belongs to the caller
+            memset(grid[i][j], 0, sizeof(uint16_t) * width);
+        }
+    }
 
-    free((void *)threads);
-    free((void *)args);
+    bool ok = runGeneration(ctx, pool, grid, width, length, height, seed, fulness);
+    arenaRelease(arena, mark);
+    return ok ? 0 : -1;
+}
 
-#ifdef cgsme_DEBUG
-    uint64_t __cgsme_grid_end = cgsme_now_us();
-    uint64_t __cgsme_grid_end_cycles = cgsme_now_cycles();
-    cgsme_profile_record("generateGrid", (unsigned long long)(__cgsme_grid_end - __cgsme_grid_start), (unsigned long long)(__cgsme_grid_end_cycles - __cgsme_grid_start_cycles));
-    cgsme_profile_set_runinfo(height, width, length, seed, fulness);
-#endif
+int generateGridInto(uint32_t width, uint32_t length, uint32_t height, uint32_t seed, uint32_t fulness, uint16_t *out, size_t rowStride)
+{
+    CGSME_PROFILE_FUNC();
+    cgsme_context *ctx = cgsme_context_create();
+    int result = generateIntoBuffer(ctx, g_workerPool, width, length, height, seed, fulness, out, rowStride);
+    cgsme_context_destroy(ctx);
+    return result;
+}
 
-    return grid;
+int cgsme_context_generate_into(cgsme_context *ctx, uint32_t width, uint32_t length, uint32_t height, uint32_t seed, uint32_t fulness, uint16_t *out, size_t rowStride)
+{
+    CGSME_PROFILE_FUNC();
+    return generateIntoBuffer(ctx, g_workerPool, width, length, height, seed, fulness, out, rowStride);
+}
+
+// one maze of a batch. the worker running it generates through its own context
+typedef struct
+{
+    const cgsme_batch_params *params;
+    cgsme_batch_output *output;
+    cgsme_context **contexts; // one per worker, the calling thread (helping out) takes the last one
+    CgsmePool *pool;
+} BatchJob;
+
+static int runBatchJob(void *args)
+{
+    CGSME_PROFILE_FUNC();
+    BatchJob *job = (BatchJob *)args;
+    uint32_t worker = cgsme_pool_worker_index();
+    uint32_t callerSlot = cgsme_pool_thread_count(job->pool);
+    cgsme_context *ctx = job->contexts[worker < callerSlot ? worker : callerSlot];
+    const cgsme_batch_params *p = job->params;
+    job->output->result = generateIntoBuffer(ctx, job->pool, p->width, p->length, p->height, p->seed, p->fulness,
+                                             job->output->out, job->output->rowStride);
+    return 0;
+}
+
+// biggest maze first, so the long ones do not start last
+static int compareBatchJobs(const void *a, const void *b)
+{
+    const cgsme_batch_params *pa = ((const BatchJob *)a)->params;
+    const cgsme_batch_params *pb = ((const BatchJob *)b)->params;
+    uint64_t ca = (uint64_t)pa->width * pa->length * pa->height;
+    uint64_t cb = (uint64_t)pb->width * pb->length * pb->height;
+    return ca < cb ? 1 : ca > cb ? -1 : 0;
+}
+
+int cgsme_generate_batch(const cgsme_batch_params *params, uint32_t n, cgsme_batch_output *outputs)
+{
+    CGSME_PROFILE_FUNC();
+    if (n == 0)
+        return 0;
+    if (!params || !outputs)
+        return -1;
+
+    // the library pool if there is one, else one for this call
+    CgsmePool *pool = g_workerPool ? g_workerPool : cgsme_pool_create(0);
+    uint32_t contextCount = pool ? cgsme_pool_thread_count(pool) + 1 : 0;
+    BatchJob *jobs = malloc(sizeof(BatchJob) * n);
+    cgsme_context **contexts = calloc(contextCount ? contextCount : 1, sizeof(cgsme_context *));
+    bool ok = pool && jobs && contexts;
+    for (uint32_t i = 0; ok && i < contextCount; i++)
+        ok = (contexts[i] = cgsme_context_create()) != NULL;
+
+    if (ok)
+    {
+        for (uint32_t i = 0; i < n; i++)
+        {
+            outputs[i].result = -1;
+            jobs[i] = (BatchJob){&params[i], &outputs[i], contexts, pool};
+        }
+        qsort(jobs, n, sizeof(BatchJob), compareBatchJobs);
+
+        // maze jobs start their layer jobs on the same pool (nested runs are fine, see cgsme_pool_run)
+        cgsme_pool_run(pool, runBatchJob, jobs, sizeof(BatchJob), n);
+        for (uint32_t i = 0; i < n; i++)
+            ok = ok && outputs[i].result == 0;
+    }
+    else
+    {
+        for (uint32_t i = 0; i < n; i++)
+            outputs[i].result = -1;
+    }
+
+    for (uint32_t i = 0; contexts && i < contextCount; i++)
+        cgsme_context_destroy(contexts[i]);
+    free(contexts);
+    free(jobs);
+    if (pool != g_workerPool)
+        cgsme_pool_destroy(pool);
+    return ok ? 0 : -1;
+}
+
+int cgsme_init_workers(uint32_t threadCount)
+{
+    CGSME_PROFILE_FUNC();
+    // re-init with a different size: drop the old workers first
+    cgsme_shutdown_workers();
+
+    g_workerPool = cgsme_pool_create(threadCount);
+    return g_workerPool ? 0 : -1;
+}
+
+void cgsme_shutdown_workers(void)
+{
+    CGSME_PROFILE_FUNC();
+    cgsme_pool_destroy(g_workerPool);
+    g_workerPool = NULL;
 }
 
 void freeGrid(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t height)
@@ -535,50 +1035,29 @@ void freeGrid(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t height
     }
 }
 
-void cleanGrid(uint16_t **gridLayer, uint32_t width, uint32_t length, uint32_t x, uint32_t y)
-{
-    CGSME_PROFILE_FUNC();
-
-    // recursive algorithm where we flip all the bits to mark it as visited
-
-    // base case if we leave the grid
-    //  __builtin_popcount(gridLayer[y][x]) > 1
-    //  all the already collapsed 16 corridors can be 0 1 10 100 1000 10000 and so on...
-    //  so if the popcount is more than 1 it means its not collapsed yet, skip that (should not happen but just in case)
-    if (x >= width || x < 0 || y >= length || y < 0 || __builtin_popcount((unsigned)gridLayer[y][x]) > 1)
-        return;
-
-    uint16_t tmp = gridLayer[y][x];
-    gridLayer[y][x] = ~gridLayer[y][x];
-
-    // if the direction is open then we recursively keep going else return
-    if (tmp & South_Open_Mask)
-        cleanGrid(gridLayer, width, length, x, y - 1);
-    if (tmp & North_Open_Mask)
-        cleanGrid(gridLayer, width, length, x, y + 1);
-    if (tmp & West_Open_Mask)
-        cleanGrid(gridLayer, width, length, x + 1, y);
-    if (tmp & East_Open_Mask)
-        cleanGrid(gridLayer, width, length, x - 1, y);
-}
-
 void updateTileEntropy(uint16_t **gridLayer, uint32_t width, uint32_t length, uint32_t x, uint32_t y)
 {
     CGSME_PROFILE_FUNC();
+    (void)width;
+    (void)length;
+
+    // padded layer: the void ring is never a single tile, so no bounds checks
+    int32_t cx = (int32_t)x;
+    int32_t cy = (int32_t)y;
 
     uint16_t northMask = All_Possible_State;
     uint16_t eastMask = All_Possible_State;
     uint16_t southMask = All_Possible_State;
     uint16_t westMask = All_Possible_State;
 
-    if (y != 0 && __builtin_popcount(gridLayer[y - 1][x]) == 1)
+    if (__builtin_popcount(gridLayer[cy - 1][cx]) == 1)
         northMask = South_Open_Mask;
-    if (y != length - 1 && __builtin_popcount(gridLayer[y + 1][x]) == 1)
+    if (__builtin_popcount(gridLayer[cy + 1][cx]) == 1)
         southMask = North_Open_Mask;
-    if (x != 0 && __builtin_popcount(gridLayer[y][x - 1]) == 1)
+    if (__builtin_popcount(gridLayer[cy][cx - 1]) == 1)
         westMask = East_Open_Mask;
-    if (x != width - 1 && __builtin_popcount(gridLayer[y][x + 1]) == 1)
+    if (__builtin_popcount(gridLayer[cy][cx + 1]) == 1)
         eastMask = West_Open_Mask;
 
-    gridLayer[y][x] &= northMask & southMask & eastMask & westMask;
+    gridLayer[cy][cx] &= northMask & southMask & eastMask & westMask;
 }
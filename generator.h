@@ -3,12 +3,112 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stdlib.h>
+#include <stddef.h>
+#include "threadRandom.h"
 
-void collapseTile(uint16_t *tile, float *rates, uint32_t *rng);
+void collapseTile(uint16_t *tile, float *rates, CgsmeRng *rng);
 uint16_t ***generateGrid(uint32_t width, uint32_t length, uint32_t height, uint32_t seed, uint32_t fulness);
 
 void freeGrid(uint16_t ***grid, uint32_t width, uint32_t length, uint32_t height);
 
+// writes the maze straight into a caller owned buffer instead of allocating a grid.
+// cell (x, y, layer) lands at out[layer * rowStride * length + y * rowStride + x].
+// rowStride is in elements and must be >= width (padding after each row is left untouched).
+// returns 0 on success, -1 on invalid arguments or out of memory. no freeGrid needed.
+int generateGridInto(uint32_t width, uint32_t length, uint32_t height, uint32_t seed, uint32_t fulness, uint16_t *out, size_t rowStride);
+
+// worker pool used by generateGrid for the per-layer jobs.
+// threadCount 0 = one worker per hardware thread. returns 0 on success, -1 on failure.
+// without a pool generateGrid falls back to spawning one thread per layer per call.
+// call these outside of generation (not while another thread is inside generateGrid).
+int cgsme_init_workers(uint32_t threadCount);
+void cgsme_shutdown_workers(void);
+
+// reusable generation context. owns all scratch memory (per-thread arenas sized to the
+// largest map seen) and the output grid, so repeated calls through it stop allocating.
+// a context must not be used by two threads at the same time; use one per host thread.
+typedef struct cgsme_context cgsme_context;
+
+cgsme_context *cgsme_context_create(void);
+void cgsme_context_destroy(cgsme_context *ctx);
+
+// same as generateGrid, but the grid belongs to the context: it stays valid until the next
+// call on ctx or cgsme_context_destroy. do NOT pass it to freeGrid.
+uint16_t ***cgsme_context_generate(cgsme_context *ctx, uint32_t width, uint32_t length, uint32_t height, uint32_t seed, uint32_t fulness);
+
+// generateGridInto through a context (no allocation in steady state)
+int cgsme_context_generate_into(cgsme_context *ctx, uint32_t width, uint32_t length, uint32_t height, uint32_t seed, uint32_t fulness, uint16_t *out, size_t rowStride);
+
+// one maze of a cgsme_generate_batch call
+typedef struct cgsme_batch_params
+{
+    uint32_t width;
+    uint32_t length;
+    uint32_t height;
+    uint32_t seed;
+    uint32_t fulness;
+} cgsme_batch_params;
+
+// where a maze of the batch goes (same layout as generateGridInto) and how it went
+typedef struct cgsme_batch_output
+{
+    uint16_t *out;    // caller owned, rowStride * length * height elements
+    size_t rowStride; // elements, >= width
+    int result;       // written by the batch: 0 on success, -1 like generateGridInto
+} cgsme_batch_output;
+
+// generates params[i] into outputs[i] for i < n. whole mazes are handed out to the worker pool
+// (biggest first) and their layers run on it too, every worker reuses one context for all the
+// mazes it takes. without cgsme_init_workers a pool of one worker per hardware thread lives for
+// the call. every maze is identical to generateGridInto with the same arguments.
+// returns 0 if every maze succeeded, -1 otherwise (see outputs[i].result).
+int cgsme_generate_batch(const cgsme_batch_params *params, uint32_t n, cgsme_batch_output *outputs);
+
+// how the solver picks the next cell to collapse (lowest entropy first, random tie-break)
+typedef enum cgsme_scheduler
+{
+    CGSME_SCHEDULER_BUCKET = 0, // one bucket per entropy value, O(1) push/decrease/pop (default)
+    CGSME_SCHEDULER_HEAP = 1,   // legacy binary heap on a float score (entropy + noise)
+    CGSME_SCHEDULER_WAVEFRONT = 2, // checkerboard rounds: every frontier cell of one colour in the lowest
+                                   // entropy band at once, chunked over the worker pool (own output)
+} cgsme_scheduler;
+
+// scheduler used by the following calls on ctx. generateGrid/generateGridInto use the default.
+void cgsme_context_set_scheduler(cgsme_context *ctx, cgsme_scheduler scheduler);
+
+// smallest tile cgsme_context_set_tile_size accepts (smaller sizes are raised to it)
+#define CGSME_MIN_TILE_SIZE 16
+
+// split every layer into tiles of about tileSize x tileSize that are solved concurrently on the
+// worker pool (serially without one), then re-solve the seams between them. lets one big layer
+// use more than one core. the output depends on seed and tile size only, not on the thread
+// count, but differs from the untiled result. 0 (default) solves each layer in one piece.
+void cgsme_context_set_tile_size(cgsme_context *ctx, uint32_t tileSize);
+
+// how often the solver of `layer` ran out of queued cells and had to reseed an island
+// during the last call on ctx (0 for layers out of range)
+uint32_t cgsme_context_layer_reseeds(const cgsme_context *ctx, uint32_t layer);
+
+// stages of a generation call, see cgsme_context_phase_us
+typedef enum cgsme_phase
+{
+    CGSME_PHASE_MASK = 0,      // ridged noise mask, sanitize and rescue (calling thread)
+    CGSME_PHASE_ARCHITECT = 1, // stairs and the rest of the pre-seeding (calling thread)
+    CGSME_PHASE_SOLVE = 2,     // per-layer propagation and collapse loop
+    CGSME_PHASE_WELD = 3,      // per-layer cleanup, sealing, labeling and welding
+    CGSME_PHASE_COUNT
+} cgsme_phase;
+
+// microseconds the last call on ctx spent in `phase`. solve and weld are summed over all
+// layers, which run in parallel, so they can add up to more than the wall time of the call.
+uint64_t cgsme_context_phase_us(const cgsme_context *ctx, cgsme_phase phase);
+
+// high-water mark of the context's scratch arenas (bytes, every arena slot at its own peak added up)
+size_t cgsme_context_peak_bytes(const cgsme_context *ctx);
+
+// number of heap allocations the arenas made so far (stays constant in steady state)
+uint64_t cgsme_context_heap_allocations(const cgsme_context *ctx);
+
 
 typedef struct layerGenerationArgs
 {
@@ -21,7 +121,9 @@ typedef struct layerGenerationArgs
     int32_t endY;
     uint32_t seed;
     uint8_t fulness;
-    uint8_t layerIndex;
+    uint32_t layerIndex;
+    cgsme_context *ctx; // scratch memory source
+    int result;         // out, 0 = ok (what generateLayerThread returned)
 } layerGenerationArgs;
 
 
@@ -3,8 +3,1737 @@
 #include <stdint.h>
 #include <string.h>
 #include "generator.h"
+#include "threadRandom.h"
+#include "cgsme_solver.h"
+#include "cgsme_topology.h"
+#include "cgsme_unionfind.h"
+#include "cgsme_noise.h"
+#include "cgsme_bitplane.h"
+#include "cgsme_reach.h"
+#include "cgsme_pool.h"
 #include "cgsme_debug.h"
 #include <time.h>
+#ifdef __linux__
+#include <threads.h>
+#else
+#include "tinycthread/tinycthread.h"
+#endif
+
+// average wall time of `iterations` generateGrid calls (after one warmup call)
+static double benchAverageUs(uint32_t width, uint32_t length, uint32_t height, uint32_t iterations)
+{
+    uint16_t ***warm = generateGrid(width, length, height, 5, 70);
+    freeGrid(warm, width, length, height);
+
+    uint64_t start_us = cgsme_now_us();
+    for (uint32_t i = 0; i < iterations; i++)
+    {
+        uint16_t ***grid = generateGrid(width, length, height, 5 + i, 70);
+        freeGrid(grid, width, length, height);
+    }
+    return (double)(cgsme_now_us() - start_us) / (double)iterations;
+}
+
+// --cgsme-bench-pool: spawn-per-call layer threads vs the persistent worker pool
+// (needs the cgsme_DEBUG build, release builds have no timer)
+static void benchWorkerPool(void)
+{
+    // width, length, height, iterations
+    const uint32_t configs[][4] = {
+        {25, 25, 5, 400},    // runtime chunk
+        {50, 50, 3, 200},
+        {200, 200, 5, 20},   // full map
+        {100, 100, 100, 3},  // many layers
+    };
+
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        uint32_t w = configs[c][0], l = configs[c][1], h = configs[c][2], it = configs[c][3];
+
+        double spawnUs = benchAverageUs(w, l, h, it);
+
+        cgsme_init_workers(0);
+        double poolUs = benchAverageUs(w, l, h, it);
+        cgsme_shutdown_workers();
+
+        printf("BENCH: %ux%ux%u spawn=%.1f us pool=%.1f us (x%.2f)\n", w, l, h, spawnUs, poolUs, poolUs > 0.0 ? spawnUs / poolUs : 0.0);
+    }
+}
+
+// --cgsme-bench-context: generateGrid vs a reused cgsme_context, heap allocations
+// of the context must stop growing after the first call
+static void benchContext(void)
+{
+    const uint32_t configs[][4] = {
+        {25, 25, 5, 400},
+        {200, 200, 5, 20},
+    };
+
+    cgsme_init_workers(0);
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        uint32_t w = configs[c][0], l = configs[c][1], h = configs[c][2], it = configs[c][3];
+
+        double plainUs = benchAverageUs(w, l, h, it);
+
+        cgsme_context *ctx = cgsme_context_create();
+        cgsme_context_generate(ctx, w, l, h, 5, 70); // warmup sizes the arenas
+        uint64_t allocsAfterWarmup = cgsme_context_heap_allocations(ctx);
+
+        uint64_t start_us = cgsme_now_us();
+        for (uint32_t i = 0; i < it; i++)
+            cgsme_context_generate(ctx, w, l, h, 5 + i, 70);
+        double ctxUs = (double)(cgsme_now_us() - start_us) / (double)it;
+
+        uint64_t extraAllocs = cgsme_context_heap_allocations(ctx) - allocsAfterWarmup;
+        printf("BENCH: %ux%ux%u generateGrid=%.1f us context=%.1f us peak=%zu bytes steady-state allocs=%llu%s\n",
+               w, l, h, plainUs, ctxUs, cgsme_context_peak_bytes(ctx), (unsigned long long)extraAllocs,
+               extraAllocs ? " (FAIL)" : "");
+        cgsme_context_destroy(ctx);
+    }
+    cgsme_shutdown_workers();
+}
+
+// --cgsme-bench-scheduler: legacy float MinHeap vs the entropy bucket queue
+static void benchScheduler(void)
+{
+    const uint32_t configs[][4] = {
+        {200, 200, 5, 10},
+        {1000, 1000, 1, 3},
+    };
+    const cgsme_scheduler schedulers[2] = {CGSME_SCHEDULER_HEAP, CGSME_SCHEDULER_BUCKET};
+
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        uint32_t w = configs[c][0], l = configs[c][1], h = configs[c][2], it = configs[c][3];
+        double us[2];
+
+        for (int s = 0; s < 2; s++)
+        {
+            cgsme_context *ctx = cgsme_context_create();
+            cgsme_context_set_scheduler(ctx, schedulers[s]);
+            cgsme_context_generate(ctx, w, l, h, 5, 70); // warmup
+
+            uint64_t start_us = cgsme_now_us();
+            for (uint32_t i = 0; i < it; i++)
+                cgsme_context_generate(ctx, w, l, h, 5 + i, 70);
+            us[s] = (double)(cgsme_now_us() - start_us) / (double)it;
+            cgsme_context_destroy(ctx);
+        }
+
+        printf("BENCH: %ux%ux%u heap=%.1f us bucket=%.1f us (x%.2f)\n", w, l, h, us[0], us[1], us[1] > 0.0 ? us[0] / us[1] : 0.0);
+    }
+}
+
+// --cgsme-bench-wavefront: single large layers, sequential heap / bucket solvers vs the
+// checkerboard wavefront (on the calling thread and on the worker pool). the wavefront output
+// must not depend on the pool
+static bool benchWavefront(void)
+{
+    const uint32_t configs[][4] = {
+        {1024, 1024, 70, 3},
+        {1024, 1024, 100, 3},
+        {2048, 2048, 70, 1},
+    };
+    const cgsme_scheduler schedulers[4] = {CGSME_SCHEDULER_HEAP, CGSME_SCHEDULER_BUCKET, CGSME_SCHEDULER_WAVEFRONT,
+                                           CGSME_SCHEDULER_WAVEFRONT};
+    bool allOk = true;
+
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        uint32_t w = configs[c][0], l = configs[c][1], f = configs[c][2], it = configs[c][3];
+        size_t cells = (size_t)w * l;
+        uint16_t *out[4];
+        double us[4];
+
+        for (int s = 0; s < 4; s++)
+        {
+            if (s == 3)
+                cgsme_init_workers(0);
+            out[s] = malloc(sizeof(uint16_t) * cells);
+            cgsme_context *ctx = cgsme_context_create();
+            cgsme_context_set_scheduler(ctx, schedulers[s]);
+            cgsme_context_generate_into(ctx, w, l, 1, 5, f, out[s], w); // warmup
+
+            uint64_t start_us = cgsme_now_us();
+            for (uint32_t i = 0; i < it; i++)
+                cgsme_context_generate_into(ctx, w, l, 1, 5, f, out[s], w);
+            us[s] = (double)(cgsme_now_us() - start_us) / (double)it;
+            cgsme_context_destroy(ctx);
+            if (s == 3)
+                cgsme_shutdown_workers();
+        }
+
+        bool same = memcmp(out[2], out[3], sizeof(uint16_t) * cells) == 0;
+        printf("BENCH: %ux%ux1 f=%u heap=%.1f ms bucket=%.1f ms wavefront=%.1f ms (x%.2f vs heap) wavefront+pool=%.1f ms (x%.2f)%s\n",
+               w, l, f, us[0] / 1000.0, us[1] / 1000.0, us[2] / 1000.0, us[2] > 0.0 ? us[0] / us[2] : 0.0, us[3] / 1000.0,
+               us[3] > 0.0 ? us[0] / us[3] : 0.0, same ? "" : " (FAIL: pool changed the output)");
+        allOk = allOk && same;
+        for (int s = 0; s < 4; s++)
+            free(out[s]);
+    }
+    return allOk;
+}
+
+// --cgsme-bench-propagation: table-driven propagation kernel and ports <-> tile lookups
+// on a random padded layer (collapsed tiles, voids and superpositions)
+static void benchPropagation(void)
+{
+    enum { W = 256, L = 256, N = 20000000 };
+    CgsmeArena arena;
+    arenaInit(&arena);
+    uint16_t *data = malloc(sizeof(uint16_t) * W * L);
+    uint16_t **rows = allocPaddedLayer(W, L, &arena);
+    CellStack *forced = initCellStack(W * L, &arena);
+    uint32_t *cells = malloc(sizeof(uint32_t) * N);
+
+    CgsmeRng rng = cgsme_rng_init(1, 0, 0, CGSME_RNG_SOLVER);
+    for (uint32_t i = 0; i < W * L; i++)
+    {
+        uint32_t k = cgsme_rng_bounded(&rng, 20);
+        data[i] = k < 16 ? (uint16_t)(1u << k) : (k == 16 ? Empty_Tile : All_Possible_State);
+    }
+    for (uint32_t i = 0; i < N; i++)
+        cells[i] = cgsme_rng_bounded(&rng, W * L);
+
+    for (uint32_t y = 0; y < L; y++)
+        memcpy(rows[y], &data[y * W], sizeof(uint16_t) * W);
+    uint64_t start_us = cgsme_now_us();
+    for (uint32_t i = 0; i < N; i++)
+    {
+        updateNeighbours(rows, W, L, cells[i] % W, cells[i] / W, NULL, NULL, NULL, forced);
+        if ((i & 0xFFFF) == 0) // keep superpositions around
+            for (uint32_t y = 0; y < L; y++)
+                memcpy(rows[y], &data[y * W], sizeof(uint16_t) * W);
+    }
+    double propagateNs = (double)(cgsme_now_us() - start_us) * 1000.0 / N;
+
+    volatile uint64_t sink = 0;
+    uint64_t acc = 0;
+    start_us = cgsme_now_us();
+    for (uint32_t i = 0; i < N; i++)
+        acc += getTileFromFlags(getTileFlags(data[cells[i]]) | (1u << (i & 3)));
+    sink = acc;
+    double flagsNs = (double)(cgsme_now_us() - start_us) * 1000.0 / N;
+    (void)sink;
+
+    printf("BENCH: updateNeighbours %.2f ns/call, ports round trip %.2f ns/call\n", propagateNs, flagsNs);
+    free(cells);
+    free(data);
+    arenaDestroy(&arena);
+}
+
+// decided tiles that disagree with a decided neighbour about their shared side (a port without
+// one back, the ring counts as void). tiles in superposition are skipped (for --cgsme-bench-bitplane)
+static uint32_t countBrokenTiles(uint16_t **layer, uint32_t w, uint32_t l)
+{
+    static const int dx[4] = {0, 1, 0, -1}, dy[4] = {-1, 0, 1, 0};
+    uint32_t broken = 0;
+    for (int32_t y = 0; y < (int32_t)l; y++)
+    {
+        for (int32_t x = 0; x < (int32_t)w; x++)
+        {
+            uint16_t v = layer[y][x];
+            if (__builtin_popcount(v) > 1)
+                continue;
+            uint8_t ports = v ? TILE_PORTS[__builtin_ctz(v)] : 0;
+            for (int d = 0; d < 4; d++)
+            {
+                uint16_t n = layer[y + dy[d]][x + dx[d]];
+                if (__builtin_popcount(n) > 1)
+                    continue;
+                uint8_t back = __builtin_popcount(n) == 1 ? TILE_PORTS[__builtin_ctz(n)] : 0;
+                if (((ports >> d) & 1) != ((back >> ((d + 2) & 3)) & 1))
+                {
+                    broken++;
+                    break;
+                }
+            }
+        }
+    }
+    return broken;
+}
+
+// --cgsme-bench-bitplane: the experimental bitplane layer (cgsme_bitplane.h) vs the uint16_t
+// state. init: void / stair propagation of a 2048x2048 layer (30% random voids, a few stairs),
+// updateNeighbours over every decided tile vs word-parallel sweeps. the sweeps narrow against all
+// sides at once, updateNeighbours freezes a tile as soon as it is forced (e.g. a dead end facing a
+// void that is visited later, the seal pass fixes those), so the states differ there: both sides
+// report their broken tiles. full: "Ocean" fill of an open 2048x2048 layer, the bucket solver
+// (solve phase of one context call) vs checkerboard rounds, which must leave no open or broken tile
+static bool benchBitplane(void)
+{
+    enum { N = 2048 };
+    CgsmeArena arena;
+    arenaInit(&arena);
+    uint16_t *data = malloc(sizeof(uint16_t) * N * N);
+    uint16_t **ref = allocPaddedLayer(N, N, &arena);
+    uint16_t **out = allocPaddedLayer(N, N, &arena);
+    CellStack *forced = initCellStack(N * N, &arena);
+    BitplaneLayer *bp = createBitplaneLayer(N, N, &arena);
+    if (!data || !ref || !out || !forced || !bp)
+        return false;
+
+    CgsmeRng rng = cgsme_rng_init(7, 0, 0, CGSME_RNG_SOLVER);
+    for (uint32_t i = 0; i < N * N; i++)
+    {
+        uint32_t k = cgsme_rng_bounded(&rng, 1000);
+        data[i] = k < 300 ? Empty_Tile : (k < 302 ? (uint16_t)(1u << cgsme_rng_bounded(&rng, 16)) : All_Possible_State);
+    }
+
+    // INIT, reference: the edge pass and the propagation loop of the solver
+    for (uint32_t y = 0; y < N; y++)
+        memcpy(ref[y], &data[y * N], sizeof(uint16_t) * N);
+    uint64_t start_us = cgsme_now_us();
+    for (uint32_t j = 0; j < N; j++)
+    {
+        // (X_Closed_Mask: what may sit in direction X of a tile without a port there)
+        if (__builtin_popcount(ref[0][j]) > 1)
+            ref[0][j] &= South_Closed_Mask;
+        if (__builtin_popcount(ref[N - 1][j]) > 1)
+            ref[N - 1][j] &= North_Closed_Mask;
+        if (__builtin_popcount(ref[j][0]) > 1)
+            ref[j][0] &= East_Closed_Mask;
+        if (__builtin_popcount(ref[j][N - 1]) > 1)
+            ref[j][N - 1] &= West_Closed_Mask;
+    }
+    for (uint32_t y = 0; y < N; y++)
+        for (uint32_t x = 0; x < N; x++)
+            if (__builtin_popcount(ref[y][x]) <= 1)
+                updateNeighbours(ref, N, N, x, y, NULL, NULL, NULL, forced);
+    double refInitMs = (double)(cgsme_now_us() - start_us) / 1000.0;
+    printf("BENCH: bitplane init %ux%u updateNeighbours %.2f ms, %u broken tiles\n", N, N, refInitMs, countBrokenTiles(ref, N, N));
+
+    bool allOk = true;
+    for (int isa = 0; isa < CGSME_BITPLANE_ISA_COUNT; isa++)
+    {
+        if (!bitplaneIsaSupported((CgsmeBitplaneIsa)isa))
+            continue;
+
+        for (uint32_t y = 0; y < N; y++)
+            memcpy(out[y], &data[y * N], sizeof(uint16_t) * N);
+        start_us = cgsme_now_us();
+        bitplaneLoad(bp, out);
+        uint64_t loaded_us = cgsme_now_us();
+        uint32_t sweeps = bitplanePropagate(bp, (CgsmeBitplaneIsa)isa);
+        uint64_t propagated_us = cgsme_now_us();
+        bitplaneStore(bp, out);
+        uint64_t end_us = cgsme_now_us();
+
+        uint32_t differing = 0;
+        for (uint32_t y = 0; y < N; y++)
+            for (uint32_t x = 0; x < N; x++)
+                differing += out[y][x] != ref[y][x];
+        printf("BENCH: bitplane init %-6s load %.2f ms, propagate %.2f ms (%u sweeps, x%.1f vs updateNeighbours), store %.2f ms, %u tiles differ, %u broken tiles\n",
+               bitplaneIsaName((CgsmeBitplaneIsa)isa), (loaded_us - start_us) / 1000.0, (propagated_us - loaded_us) / 1000.0, sweeps,
+               propagated_us > loaded_us ? refInitMs * 1000.0 / (double)(propagated_us - loaded_us) : 0.0,
+               (end_us - propagated_us) / 1000.0, differing, countBrokenTiles(out, N, N));
+    }
+
+    // FULL, reference: the solve phase of the bucket solver on one open layer
+    cgsme_context *ctx = cgsme_context_create();
+    uint16_t *maze = malloc(sizeof(uint16_t) * N * N);
+    cgsme_context_generate_into(ctx, N, N, 1, 7, 100, maze, N);
+    double refSolveMs = (double)cgsme_context_phase_us(ctx, CGSME_PHASE_SOLVE) / 1000.0;
+    cgsme_context_destroy(ctx);
+    free(maze);
+    printf("BENCH: bitplane full %ux%u bucket solver %.2f ms\n", N, N, refSolveMs);
+
+    float rates[NUM_TILE_TYPES];
+    for (int i = 0; i < NUM_TILE_TYPES; ++i)
+        rates[i] = 1.0f / (float)NUM_TILE_TYPES;
+    for (int isa = 0; isa < CGSME_BITPLANE_ISA_COUNT; isa++)
+    {
+        if (!bitplaneIsaSupported((CgsmeBitplaneIsa)isa))
+            continue;
+
+        for (uint32_t y = 0; y < N; y++)
+            for (uint32_t x = 0; x < N; x++)
+                out[y][x] = All_Possible_State;
+        start_us = cgsme_now_us();
+        bitplaneLoad(bp, out);
+        uint32_t rounds = bitplaneFill(bp, rates, &rng, (CgsmeBitplaneIsa)isa);
+        bitplaneStore(bp, out);
+        double ms = (double)(cgsme_now_us() - start_us) / 1000.0;
+
+        uint32_t broken = countBrokenTiles(out, N, N);
+        uint32_t voids = 0;
+        for (uint32_t y = 0; y < N; y++)
+            for (uint32_t x = 0; x < N; x++)
+            {
+                voids += out[y][x] == Empty_Tile;
+                broken += __builtin_popcount(out[y][x]) > 1; // left open
+            }
+        printf("BENCH: bitplane full %-6s %.2f ms (%u rounds, x%.1f vs bucket solver), %u voids, %u open or broken tiles%s\n",
+               bitplaneIsaName((CgsmeBitplaneIsa)isa), ms, rounds, ms > 0.0 ? refSolveMs / ms : 0.0, voids, broken,
+               broken ? " (FAIL)" : "");
+        allOk = allOk && broken == 0;
+    }
+
+    free(data);
+    arenaDestroy(&arena);
+    return allOk;
+}
+
+// full-layer scan the reseed used before the cell index (reference for --cgsme-bench-reseed)
+static bool legacySeedScan(uint16_t **grid, uint32_t width, uint32_t length, uint32_t *outX, uint32_t *outY, CgsmeRng *rng)
+{
+    float minScore = 1e9f;
+    bool found = false;
+    uint64_t scanBase = rng->ctr;
+    rng->ctr += (uint64_t)width * length;
+    for (uint32_t i = 0; i < length; i++)
+        for (uint32_t j = 0; j < width; j++)
+        {
+            if (__builtin_popcount(grid[i][j]) <= 1)
+                continue;
+            float noise = (float)(cgsme_rng_at(rng, scanBase + (uint64_t)i * width + j) >> 16) * 0.001f;
+            if (noise < minScore)
+            {
+                minScore = noise;
+                *outX = j;
+                *outY = i;
+                found = true;
+            }
+        }
+    return found;
+}
+
+// --cgsme-bench-reseed: worst case for the reseed path (every open tile is its own pocket,
+// so the queue runs dry after each collapse), then reseed counts of real generations
+static void benchReseed(void)
+{
+    const uint32_t width = 1000, length = 1000, pockets = 1000;
+    uint16_t *data = malloc(sizeof(uint16_t) * width * length);
+    uint16_t **rows = malloc(sizeof(uint16_t *) * length);
+    for (uint32_t i = 0; i < length; i++)
+        rows[i] = &data[i * width];
+
+    double us[2];
+    for (int mode = 0; mode < 2; mode++)
+    {
+        CgsmeRng rng = cgsme_rng_init(7, 0, 0, CGSME_RNG_SOLVER);
+        CgsmeArena arena;
+        arenaInit(&arena);
+        CellIndex *open = initCellIndex(width * length, &arena);
+
+        // collapsed everywhere, scattered open pockets
+        for (uint32_t i = 0; i < width * length; i++)
+            data[i] = Normal_X_Corridor;
+        for (uint32_t p = 0; p < pockets; p++)
+            data[cgsme_rng_bounded(&rng, width * length)] = All_Possible_State;
+        for (uint32_t i = 0; i < width * length; i++)
+            if (__builtin_popcount(data[i]) > 1)
+                cellIndexSet(open, i);
+
+        uint32_t x, y, reseeds = 0;
+        uint64_t start_us = cgsme_now_us();
+        while (mode ? findBestSeedLocation(rows, width, length, open, &x, &y, &rng) : legacySeedScan(rows, width, length, &x, &y, &rng))
+        {
+            rows[y][x] = Normal_X_Corridor;
+            reseeds++;
+        }
+        us[mode] = (double)(cgsme_now_us() - start_us);
+        printf("BENCH: %ux%u %s: %u reseeds in %.1f us (%.2f us/reseed)\n", width, length, mode ? "cell index" : "full scan ",
+               reseeds, us[mode], reseeds ? us[mode] / reseeds : 0.0);
+        arenaDestroy(&arena);
+    }
+    free(rows);
+    free(data);
+
+    const uint32_t configs[][4] = {{200, 200, 5, 70}, {500, 500, 1, 15}, {100, 100, 3, 100}};
+    cgsme_context *ctx = cgsme_context_create();
+    for (size_t c = 0; c < sizeof(configs) / sizeof(configs[0]); c++)
+    {
+        cgsme_context_generate(ctx, configs[c][0], configs[c][1], configs[c][2], 5, configs[c][3]);
+        printf("BENCH: %ux%ux%u f=%u reseeds per layer:", configs[c][0], configs[c][1], configs[c][2], configs[c][3]);
+        for (uint32_t z = 0; z < configs[c][2]; z++)
+            printf(" %u", cgsme_context_layer_reseeds(ctx, z));
+        printf("\n");
+    }
+    cgsme_context_destroy(ctx);
+}
+
+// the generator the library used before the counter-based streams (reference for --cgsme-bench-rng)
+static inline uint32_t legacyLcg(uint32_t *state)
+{
+    *state = (*state * 1664525 + 1013904223);
+    return *state;
+}
+
+// --cgsme-bench-rng: legacy LCG vs the Squares streams, in the shapes the solver uses them
+// (bounded pick in collapseTile, float noise in calculateScore, bulk fill). the per-tile draws
+// use the 3 round variant, which has to keep up with the LCG; every loop is timed 3 times and
+// the best run counts, so one preemption does not flip the verdict.
+static void benchRng(void)
+{
+    enum { N = 20000000, RUNS = 3 };
+    volatile uint32_t sinkU = 0;
+    volatile float sinkF = 0.0f;
+    uint32_t lcg = 5;
+    CgsmeRng rng = cgsme_rng_init(5, 0, 0, CGSME_RNG_SOLVER);
+    uint64_t best[3];
+
+    for (int k = 0; k < 3; k++)
+        best[k] = UINT64_MAX;
+    for (int run = 0; run < RUNS; run++)
+    {
+        uint64_t t0 = cgsme_now_us();
+        uint32_t acc = 0;
+        for (uint32_t i = 0; i < N; i++)
+            acc += legacyLcg(&lcg) % (2 + (i & 7)); // pop_count style bound
+        sinkU = acc;
+        uint64_t t1 = cgsme_now_us();
+        acc = 0;
+        for (uint32_t i = 0; i < N; i++)
+            acc += cgsme_rng_bounded_fast(&rng, 2 + (i & 7));
+        sinkU = acc;
+        uint64_t t2 = cgsme_now_us();
+        acc = 0;
+        for (uint32_t i = 0; i < N; i++)
+            acc += cgsme_rng_bounded(&rng, 2 + (i & 7));
+        sinkU = acc;
+        uint64_t t3 = cgsme_now_us();
+        best[0] = t1 - t0 < best[0] ? t1 - t0 : best[0];
+        best[1] = t2 - t1 < best[1] ? t2 - t1 : best[1];
+        best[2] = t3 - t2 < best[2] ? t3 - t2 : best[2];
+    }
+    printf("BENCH: bounded  lcg%%=%.2f ns squares3-lemire=%.2f ns%s (squares4-lemire=%.2f ns)\n", best[0] * 1000.0 / N,
+           best[1] * 1000.0 / N, best[1] > best[0] ? " (slower than the LCG)" : "", best[2] * 1000.0 / N);
+
+    for (int k = 0; k < 3; k++)
+        best[k] = UINT64_MAX;
+    for (int run = 0; run < RUNS; run++)
+    {
+        float accF = 0.0f;
+        uint64_t t0 = cgsme_now_us();
+        for (uint32_t i = 0; i < N; i++)
+            accF += ((float)legacyLcg(&lcg) / 4294967296.0f) * 0.01f; // calculateScore noise
+        sinkF = accF;
+        uint64_t t1 = cgsme_now_us();
+        accF = 0.0f;
+        for (uint32_t i = 0; i < N; i++)
+            accF += cgsme_rng_float01_fast(&rng) * 0.01f;
+        sinkF = accF;
+        uint64_t t2 = cgsme_now_us();
+        accF = 0.0f;
+        for (uint32_t i = 0; i < N; i++)
+            accF += cgsme_rng_float01(&rng) * 0.01f;
+        sinkF = accF;
+        uint64_t t3 = cgsme_now_us();
+        best[0] = t1 - t0 < best[0] ? t1 - t0 : best[0];
+        best[1] = t2 - t1 < best[1] ? t2 - t1 : best[1];
+        best[2] = t3 - t2 < best[2] ? t3 - t2 : best[2];
+    }
+    printf("BENCH: float01  lcg=%.2f ns squares3=%.2f ns%s (squares4=%.2f ns)\n", best[0] * 1000.0 / N, best[1] * 1000.0 / N,
+           best[1] > best[0] ? " (slower than the LCG)" : "", best[2] * 1000.0 / N);
+
+    // bulk fill stays on 4 rounds, nothing hot draws from it
+    enum { BATCH = 4096 };
+    uint32_t buffer[BATCH];
+    best[0] = best[1] = UINT64_MAX;
+    for (int run = 0; run < RUNS; run++)
+    {
+        uint64_t t0 = cgsme_now_us();
+        for (uint32_t i = 0; i < N / BATCH; i++)
+        {
+            for (uint32_t k = 0; k < BATCH; k++)
+                buffer[k] = legacyLcg(&lcg);
+            sinkU = buffer[i & (BATCH - 1)];
+        }
+        uint64_t t1 = cgsme_now_us();
+        for (uint32_t i = 0; i < N / BATCH; i++)
+        {
+            cgsme_rng_fill(&rng, buffer, BATCH);
+            sinkU = buffer[i & (BATCH - 1)];
+        }
+        uint64_t t2 = cgsme_now_us();
+        best[0] = t1 - t0 < best[0] ? t1 - t0 : best[0];
+        best[1] = t2 - t1 < best[1] ? t2 - t1 : best[1];
+    }
+    printf("BENCH: fill     lcg=%.2f ns squares4=%.2f ns (per number)%s\n", best[0] * 1000.0 / N, best[1] * 1000.0 / N,
+           best[1] > best[0] ? " (slower than the LCG)" : "");
+    (void)sinkU;
+    (void)sinkF;
+}
+
+// --cgsme-bench-noise: ridged noise row kernels on a 2000x2000 mask (the parameters
+// generateRidgedMask uses), pixels per second and the largest deviation from scalar
+static bool benchNoise(void)
+{
+    enum { W = 2000, L = 2000 };
+    float *reference = malloc(sizeof(float) * W * L);
+    float *scores = malloc(sizeof(float) * W * L);
+    float baseFreq = 12.0f / (float)(W + L);
+    NoiseParams params = {baseFreq * 0.5f, 4.0f, baseFreq, 7};
+    bool ok = true;
+
+    for (int isa = 0; isa < CGSME_NOISE_ISA_COUNT; isa++)
+    {
+        if (!noiseIsaSupported((CgsmeNoiseIsa)isa))
+            continue;
+
+        float *out = isa == CGSME_NOISE_SCALAR ? reference : scores;
+        uint64_t start_us = cgsme_now_us();
+        for (uint32_t y = 0; y < L; y++)
+            ridgedNoiseRow(&out[(size_t)y * W], y, W, &params, (CgsmeNoiseIsa)isa);
+        uint64_t elapsed = cgsme_now_us() - start_us;
+
+        float maxDiff = 0.0f;
+        for (size_t i = 0; i < (size_t)W * L; i++)
+        {
+            float d = fabsf(out[i] - reference[i]);
+            if (d > maxDiff)
+                maxDiff = d;
+        }
+        ok = ok && maxDiff <= CGSME_NOISE_SIMD_EPSILON;
+        printf("BENCH: noise %-6s %7.1f Mpixels/s (%6.1f ms) max |diff| vs scalar = %g%s\n", noiseIsaName((CgsmeNoiseIsa)isa),
+               (double)W * L / (elapsed ? elapsed : 1), elapsed / 1000.0, maxDiff, isa == noiseBestIsa() ? " (used)" : "");
+    }
+
+    free(scores);
+    free(reference);
+    return ok;
+}
+
+// the pixel list + qsort the mask threshold used before the radix select (reference for
+// --cgsme-bench-select), ties broken by index so both sides define the same set
+typedef struct
+{
+    uint16_t x;
+    uint16_t y;
+    float score;
+} LegacyPixel;
+
+static int legacyComparePixels(const void *a, const void *b)
+{
+    const LegacyPixel *pa = a, *pb = b;
+    if (pa->score != pb->score)
+        return pa->score < pb->score ? 1 : -1;
+    if (pa->y != pb->y)
+        return pa->y < pb->y ? -1 : 1;
+    return pa->x < pb->x ? -1 : (pa->x > pb->x);
+}
+
+// --cgsme-bench-select: top N% of a 2048x2048 noise mask, qsort over every pixel vs the
+// radix select, the selected cells must be the same
+static bool benchSelect(void)
+{
+    enum { W = 2048, L = 2048 };
+    float *scores = malloc(sizeof(float) * W * L);
+    LegacyPixel *pixels = malloc(sizeof(LegacyPixel) * W * L);
+    uint8_t *chosen = malloc(W * L);
+    float baseFreq = 12.0f / (float)(W + L);
+    NoiseParams params = {baseFreq * 0.5f, 4.0f, baseFreq, 11};
+    CgsmeArena arena;
+    arenaInit(&arena);
+    bool ok = true;
+
+    for (uint32_t y = 0; y < L; y++)
+        ridgedNoiseRow(&scores[(size_t)y * W], y, W, &params, noiseBestIsa());
+
+    const uint32_t fullness[] = {15, 70};
+    for (int f = 0; f < 2; f++)
+    {
+        uint32_t k = (uint32_t)((uint64_t)W * L * fullness[f] / 100);
+
+        uint64_t t0 = cgsme_now_us();
+        for (uint32_t i = 0; i < W * L; i++)
+            pixels[i] = (LegacyPixel){(uint16_t)(i % W), (uint16_t)(i / W), scores[i]};
+        qsort(pixels, W * L, sizeof(LegacyPixel), legacyComparePixels);
+        memset(chosen, 0, W * L);
+        for (uint32_t i = 0; i < k; i++)
+            chosen[pixels[i].y * W + pixels[i].x] = 1;
+        uint64_t t1 = cgsme_now_us();
+
+        uint32_t cutoff, ties;
+        selectTopScores(scores, W * L, k, &arena, &cutoff, &ties);
+        uint32_t mismatches = 0, selectedCount = 0;
+        for (uint32_t i = 0; i < W * L; i++)
+        {
+            uint32_t key = scoreKey(scores[i]);
+            bool selected = key > cutoff;
+            if (key == cutoff && ties > 0)
+            {
+                selected = true;
+                ties--;
+            }
+            selectedCount += selected;
+            mismatches += selected != chosen[i];
+        }
+        uint64_t t2 = cgsme_now_us();
+
+        ok = ok && mismatches == 0 && selectedCount == k;
+        printf("BENCH: select %ux%u top %u%% qsort=%.1f ms radix=%.1f ms (x%.1f) mismatches=%u\n", W, L, fullness[f],
+               (t1 - t0) / 1000.0, (t2 - t1) / 1000.0, (double)(t1 - t0) / (t2 - t1 ? t2 - t1 : 1), mismatches);
+    }
+
+    arenaDestroy(&arena);
+    free(chosen);
+    free(pixels);
+    free(scores);
+    return ok;
+}
+
+// BFS island removal the mask sanitize used before the labeling (reference for
+// --cgsme-bench-islands): one BFS per island, a second one over the largest
+static int legacyRemoveIslands(uint16_t ***grid, int w, int l, bool *visited, uint32_t *queue)
+{
+    static const int dx[] = {0, 0, 1, -1}, dy[] = {1, -1, 0, 0};
+    int best = -1, bestSize = 0;
+    memset(visited, 0, (size_t)w * l);
+    for (int i = 0; i < w * l; i++)
+    {
+        if (grid[0][i / w][i % w] == Empty_Tile || visited[i])
+            continue;
+        int head = 0, tail = 0;
+        queue[tail++] = i;
+        visited[i] = true;
+        while (head < tail)
+        {
+            int c = queue[head++];
+            for (int d = 0; d < 4; d++)
+            {
+                int nx = c % w + dx[d], ny = c / w + dy[d];
+                if (nx < 0 || ny < 0 || nx >= w || ny >= l || visited[ny * w + nx] || grid[0][ny][nx] == Empty_Tile)
+                    continue;
+                visited[ny * w + nx] = true;
+                queue[tail++] = ny * w + nx;
+            }
+        }
+        if (tail > bestSize)
+        {
+            bestSize = tail;
+            best = i;
+        }
+    }
+    if (best < 0)
+        return 0;
+
+    memset(visited, 0, (size_t)w * l);
+    int head = 0, tail = 0;
+    queue[tail++] = best;
+    visited[best] = true;
+    while (head < tail)
+    {
+        int c = queue[head++];
+        for (int d = 0; d < 4; d++)
+        {
+            int nx = c % w + dx[d], ny = c / w + dy[d];
+            if (nx < 0 || ny < 0 || nx >= w || ny >= l || visited[ny * w + nx] || grid[0][ny][nx] == Empty_Tile)
+                continue;
+            visited[ny * w + nx] = true;
+            queue[tail++] = ny * w + nx;
+        }
+    }
+    for (int i = 0; i < w * l; i++)
+        if (!visited[i])
+            grid[0][i / w][i % w] = Empty_Tile;
+    return bestSize;
+}
+
+// --cgsme-bench-islands: island removal on 2048x2048 masks full of islands (random 45% land,
+// noise top 15%), per island BFS vs two-pass labeling, the surviving cells must match
+static bool benchIslands(void)
+{
+    enum { W = 2048, L = 2048 };
+    uint16_t *source = malloc(sizeof(uint16_t) * W * L);
+    uint16_t *dataA = malloc(sizeof(uint16_t) * W * L);
+    uint16_t *dataB = malloc(sizeof(uint16_t) * W * L);
+    uint16_t **rowsA = malloc(sizeof(uint16_t *) * L);
+    uint16_t **rowsB = malloc(sizeof(uint16_t *) * L);
+    bool *visited = malloc(W * L);
+    uint32_t *queue = malloc(sizeof(uint32_t) * W * L);
+    float *scores = malloc(sizeof(float) * W * L);
+    for (uint32_t y = 0; y < L; y++)
+    {
+        rowsA[y] = &dataA[y * W];
+        rowsB[y] = &dataB[y * W];
+    }
+    uint16_t ***gridA = &rowsA, ***gridB = &rowsB;
+    CgsmeArena arena;
+    arenaInit(&arena);
+    bool ok = true;
+
+    for (int pattern = 0; pattern < 2; pattern++)
+    {
+        if (pattern == 0)
+        {
+            CgsmeRng rng = cgsme_rng_init(3, 0, 0, CGSME_RNG_ARCHITECT);
+            for (uint32_t i = 0; i < W * L; i++)
+                source[i] = cgsme_rng_bounded(&rng, 100) < 45 ? All_Possible_State : Empty_Tile;
+        }
+        else
+        {
+            float baseFreq = 12.0f / (float)(W + L);
+            NoiseParams params = {baseFreq * 0.5f, 4.0f, baseFreq, 3};
+            for (uint32_t y = 0; y < L; y++)
+                ridgedNoiseRow(&scores[(size_t)y * W], y, W, &params, noiseBestIsa());
+            uint32_t cutoff, ties;
+            selectTopScores(scores, W * L, W * L / 100 * 15, &arena, &cutoff, &ties);
+            for (uint32_t i = 0; i < W * L; i++)
+            {
+                uint32_t key = scoreKey(scores[i]);
+                bool selected = key > cutoff || (key == cutoff && ties > 0 && ties--);
+                source[i] = selected ? All_Possible_State : Empty_Tile;
+            }
+        }
+        memcpy(dataA, source, sizeof(uint16_t) * W * L);
+        memcpy(dataB, source, sizeof(uint16_t) * W * L);
+
+        uint64_t t0 = cgsme_now_us();
+        int keptA = legacyRemoveIslands(gridA, W, L, visited, queue);
+        uint64_t t1 = cgsme_now_us();
+        int keptB = removeMaskIslands(gridB, W, L, 1, &arena);
+        uint64_t t2 = cgsme_now_us();
+
+        bool same = keptA == keptB && memcmp(dataA, dataB, sizeof(uint16_t) * W * L) == 0;
+        ok = ok && same;
+        printf("BENCH: islands %s bfs=%.1f ms labeling=%.1f ms (x%.1f) kept=%d %s\n", pattern == 0 ? "random 45%" : "noise 15% ",
+               (t1 - t0) / 1000.0, (t2 - t1) / 1000.0, (double)(t1 - t0) / (t2 - t1 ? t2 - t1 : 1), keptB, same ? "same" : "DIFFERENT");
+    }
+
+    arenaDestroy(&arena);
+    free(scores);
+    free(queue);
+    free(visited);
+    free(rowsB);
+    free(rowsA);
+    free(dataB);
+    free(dataA);
+    free(source);
+    return ok;
+}
+
+// the rescue as it was before the ring distances (for --cgsme-bench-dilate): one full
+// rescan and per-layer write per 1-pixel dilation, ring 1 always, then up to 1000 more
+static int legacyDilate(uint16_t ***grid, int w, int l, int h, int maxToAdd, bool *toAdd)
+{
+    int added = 0;
+    memset(toAdd, 0, (size_t)w * l);
+    for (int y = 0; y < l; y++)
+        for (int x = 0; x < w; x++)
+            if (grid[0][y][x] == Empty_Tile &&
+                ((x > 0 && grid[0][y][x - 1] != Empty_Tile) || (x < w - 1 && grid[0][y][x + 1] != Empty_Tile) ||
+                 (y > 0 && grid[0][y - 1][x] != Empty_Tile) || (y < l - 1 && grid[0][y + 1][x] != Empty_Tile)))
+                toAdd[y * w + x] = true;
+    for (int i = 0; i < w * l && added < maxToAdd; i++)
+    {
+        if (!toAdd[i])
+            continue;
+        for (int z = 0; z < h; z++)
+            grid[z][i / w][i % w] = All_Possible_State;
+        added++;
+    }
+    return added;
+}
+
+static int legacyRescue(uint16_t ***grid, int w, int l, int h, int filled, int target, bool *toAdd)
+{
+    int start = filled;
+    filled += legacyDilate(grid, w, l, h, 1000000, toAdd);
+    for (int safety = 0; filled < target && safety < 1000; safety++)
+    {
+        int added = legacyDilate(grid, w, l, h, target - filled, toAdd);
+        if (added == 0)
+            break;
+        filled += added;
+    }
+    return filled - start;
+}
+
+// --cgsme-bench-dilate: rescue of a sanitized 1024x1024 noise mask (top 5%) back up to 15%
+// and 60%, iterative dilation vs ring distances. only layer 0 is compared, the new path
+// leaves the broadcast to the caller.
+static bool benchDilate(void)
+{
+    enum { W = 1024, L = 1024, H = 4 };
+    uint16_t *source = malloc(sizeof(uint16_t) * W * L);
+    uint16_t *dataA = malloc(sizeof(uint16_t) * W * L * H);
+    uint16_t *dataB = malloc(sizeof(uint16_t) * W * L * H);
+    uint16_t **rowsA = malloc(sizeof(uint16_t *) * L * H);
+    uint16_t **rowsB = malloc(sizeof(uint16_t *) * L * H);
+    uint16_t **layersA[H], **layersB[H];
+    bool *toAdd = malloc(W * L);
+    float *scores = malloc(sizeof(float) * W * L);
+    for (uint32_t i = 0; i < L * H; i++)
+    {
+        rowsA[i] = &dataA[i * W];
+        rowsB[i] = &dataB[i * W];
+    }
+    for (uint32_t z = 0; z < H; z++)
+    {
+        layersA[z] = &rowsA[z * L];
+        layersB[z] = &rowsB[z * L];
+    }
+    CgsmeArena arena;
+    arenaInit(&arena);
+
+    float baseFreq = 12.0f / (float)(W + L);
+    NoiseParams params = {baseFreq * 0.5f, 4.0f, baseFreq, 5};
+    for (uint32_t y = 0; y < L; y++)
+        ridgedNoiseRow(&scores[(size_t)y * W], y, W, &params, noiseBestIsa());
+    uint32_t cutoff, ties;
+    selectTopScores(scores, W * L, W * L / 100 * 5, &arena, &cutoff, &ties);
+    for (uint32_t i = 0; i < W * L; i++)
+    {
+        uint32_t key = scoreKey(scores[i]);
+        bool selected = key > cutoff || (key == cutoff && ties > 0 && ties--);
+        source[i] = selected ? All_Possible_State : Empty_Tile;
+    }
+    uint16_t **sourceRows[1] = {rowsA};
+    memcpy(dataA, source, sizeof(uint16_t) * W * L);
+    int kept = removeMaskIslands(sourceRows, W, L, 1, &arena);
+    memcpy(source, dataA, sizeof(uint16_t) * W * L);
+
+    bool ok = true;
+    static const int targets[] = {15, 60};
+    for (int t = 0; t < 2; t++)
+    {
+        int target = W * L / 100 * targets[t];
+        for (uint32_t z = 0; z < H; z++)
+        {
+            memcpy(&dataA[z * W * L], source, sizeof(uint16_t) * W * L);
+            memcpy(&dataB[z * W * L], source, sizeof(uint16_t) * W * L);
+        }
+
+        uint64_t t0 = cgsme_now_us();
+        int addedA = legacyRescue(layersA, W, L, H, kept, target, toAdd);
+        uint64_t t1 = cgsme_now_us();
+        int addedB = dilateMaskRings(layersB, W, L, 1, MASK_RESCUE_RINGS, target - kept, &arena);
+        uint64_t t2 = cgsme_now_us();
+
+        bool same = addedA == addedB && memcmp(dataA, dataB, sizeof(uint16_t) * W * L) == 0;
+        ok = ok && same;
+        printf("BENCH: dilate %ux%u 5%% -> %d%% iterative=%.1f ms rings=%.1f ms (x%.1f) added=%d %s\n", W, L, targets[t],
+               (t1 - t0) / 1000.0, (t2 - t1) / 1000.0, (double)(t1 - t0) / (t2 - t1 ? t2 - t1 : 1), addedB, same ? "same" : "DIFFERENT");
+    }
+
+    arenaDestroy(&arena);
+    free(scores);
+    free(toAdd);
+    free(rowsB);
+    free(rowsA);
+    free(dataB);
+    free(dataA);
+    free(source);
+    return ok;
+}
+
+// --cgsme-bench-weld: labeling + welding of layers tiled with closed 2x2 loops (one region
+// per loop, far past the old 4095 region limit of the packed format). afterwards the
+// layer must be a single region and exactly regions-1 bridges may have been opened.
+// reports the transient memory of the welder and the peak of a whole generated maze.
+static bool benchWeld(void)
+{
+    static const uint32_t sizes[] = {1024, 8192};
+    bool ok = true;
+
+    for (int s = 0; s < 2; s++)
+    {
+        uint32_t n = sizes[s];
+        CgsmeArena arena;
+        arenaInit(&arena);
+        uint16_t **layer = allocPaddedLayer(n, n, &arena);
+        uint32_t **labels = allocPaddedLabels(n, n, &arena);
+        uint32_t **check = allocPaddedLabels(n, n, &arena);
+        if (!layer || !labels || !check)
+        {
+            printf("BENCH: weld %ux%u out of memory\n", n, n);
+            arenaDestroy(&arena);
+            return false;
+        }
+
+        static const uint16_t loop[2][2] = {{South_East_Corridor, South_West_Corridor},
+                                            {North_East_Corridor, North_West_Corridor}};
+        uint64_t portsBefore = 0;
+        for (uint32_t y = 0; y < n; y++)
+        {
+            for (uint32_t x = 0; x < n; x++)
+            {
+                layer[y][x] = loop[y & 1][x & 1];
+                portsBefore += __builtin_popcount(getTileFlags(layer[y][x]));
+            }
+        }
+
+        // the welder gets an arena of its own, its peak is the transient memory of the weld
+        CgsmeArena weldArena;
+        arenaInit(&weldArena);
+        CgsmeRng rng = cgsme_rng_init(9, 0, 0, CGSME_RNG_WELDER);
+        uint64_t t0 = cgsme_now_us();
+        uint32_t regions = findConnectedRegions(layer, labels, n, n, &arena);
+        uint64_t t1 = cgsme_now_us();
+        germanWelderInPlace(layer, labels, regions, n, n, &rng, &weldArena);
+        uint64_t t2 = cgsme_now_us();
+        size_t weldPeak = weldArena.peak;
+        arenaDestroy(&weldArena);
+
+        uint64_t portsAfter = 0;
+        for (uint32_t y = 0; y < n; y++)
+            for (uint32_t x = 0; x < n; x++)
+                portsAfter += __builtin_popcount(getTileFlags(layer[y][x]));
+        uint32_t after = findConnectedRegions(layer, check, n, n, &arena);
+        uint64_t bridges = (portsAfter - portsBefore) / 2;
+
+        bool pass = regions == (n / 2) * (n / 2) && after == 1 && bridges == (uint64_t)regions - 1;
+        ok = ok && pass;
+        printf("BENCH: weld %ux%u regions=%u label=%.1f ms weld=%.1f ms weld peak=%.1f MB bridges=%llu regions after=%u%s\n", n, n,
+               regions, (t1 - t0) / 1000.0, (t2 - t1) / 1000.0, weldPeak / 1048576.0, (unsigned long long)bridges, after,
+               pass ? "" : " (FAIL)");
+        arenaDestroy(&arena);
+    }
+
+    // a real maze: peak of every arena of the call (the welder is the largest user of a layer arena)
+    cgsme_context *ctx = cgsme_context_create();
+    uint64_t t0 = cgsme_now_us();
+    bool generated = cgsme_context_generate(ctx, 2048, 2048, 1, 5, 70) != NULL;
+    printf("BENCH: weld maze 2048x2048x1 %.1f ms context peak=%.1f MB%s\n", (cgsme_now_us() - t0) / 1000.0,
+           cgsme_context_peak_bytes(ctx) / 1048576.0, generated ? "" : " (FAIL)");
+    cgsme_context_destroy(ctx);
+    return ok && generated;
+}
+
+// findConnectedRegions as it was before cgsme_reach (reference for --cgsme-bench-reach): one
+// regionMarkerIterative BFS per unlabeled tile, the queue is shared by every region
+static uint32_t findConnectedRegionsBfs(uint16_t **grid, uint32_t **labels, uint32_t width, uint32_t length, TopoNode *queue)
+{
+    uint32_t regionID = 0;
+    for (uint32_t i = 0; i < length; i++)
+        for (uint32_t j = 0; j < width; j++)
+            if (grid[i][j] != Empty_Tile && labels[i][j] == 0)
+                regionMarkerIterative(grid, labels, ++regionID, j, i, queue);
+    return regionID;
+}
+
+// main.lua's traversal overlay (reference for --cgsme-bench-reach): BFS from the first single
+// tile in raster order, a step needs two single tiles with ports facing each other.
+// marks the reached tiles in `seen` and returns their number
+static uint64_t reachableBfs(uint16_t **grid, uint32_t width, uint32_t length, uint8_t *seen, TopoNode *queue)
+{
+    static const int dx[4] = {0, 1, 0, -1}, dy[4] = {-1, 0, 1, 0};
+    memset(seen, 0, (size_t)width * length);
+    size_t head = 0, tail = 0;
+    for (size_t i = 0; i < (size_t)width * length && tail == 0; i++)
+    {
+        if (__builtin_popcount(grid[i / width][i % width]) == 1)
+        {
+            seen[i] = 1;
+            queue[tail++] = (TopoNode){(uint32_t)(i % width), (uint32_t)(i / width)};
+        }
+    }
+
+    while (head < tail)
+    {
+        TopoNode c = queue[head++];
+        uint8_t ports = TILE_PORTS[__builtin_ctz(grid[c.y][c.x])];
+        for (int d = 0; d < 4; d++)
+        {
+            int32_t nx = (int32_t)c.x + dx[d], ny = (int32_t)c.y + dy[d];
+            if (!((ports >> d) & 1) || nx < 0 || ny < 0 || nx >= (int32_t)width || ny >= (int32_t)length)
+                continue;
+            uint16_t n = grid[ny][nx];
+            size_t ni = (size_t)ny * width + nx;
+            if (seen[ni] || __builtin_popcount(n) != 1 || !((TILE_PORTS[__builtin_ctz(n)] >> ((d + 2) & 3)) & 1))
+                continue;
+            seen[ni] = 1;
+            queue[tail++] = (TopoNode){(uint32_t)nx, (uint32_t)ny};
+        }
+    }
+    return tail;
+}
+
+// --cgsme-bench-reach: region labels (findConnectedRegions) and main.lua style reachability
+// (from the first tile, ports facing each other) on 2048x2048 layers, BFS vs the word-parallel
+// floods of cgsme_reach.h, and findConnectedRegions (BFS or floods, picked per layer). layers: a generated maze, closed 2x2 loops (a region per 4 tiles) and
+// one corridor winding down and up the columns (the worst case for the row sweeps).
+// labels and reached tiles must match
+static bool benchReach(void)
+{
+    enum { N = 2048 };
+    static const char *names[3] = {"maze", "loops", "serpentine"};
+    static const uint16_t loop[2][2] = {{South_East_Corridor, South_West_Corridor},
+                                        {North_East_Corridor, North_West_Corridor}};
+    CgsmeArena arena;
+    arenaInit(&arena);
+    uint16_t **layer = allocPaddedLayer(N, N, &arena);
+    uint32_t **labelsA = allocPaddedLabels(N, N, &arena);
+    uint32_t **labelsB = allocPaddedLabels(N, N, &arena);
+    uint32_t **labelsC = allocPaddedLabels(N, N, &arena);
+    TopoNode *queue = arenaAlloc(&arena, sizeof(TopoNode) * N * N);
+    uint8_t *seen = arenaAlloc(&arena, (size_t)N * N);
+    ReachLayer *reach = createReachLayer(N, N, &arena);
+    cgsme_context *ctx = cgsme_context_create();
+    uint16_t ***maze = ctx ? cgsme_context_generate(ctx, N, N, 1, 5, 70) : NULL;
+    if (!layer || !labelsA || !labelsB || !labelsC || !queue || !seen || !reach || !maze)
+    {
+        printf("BENCH: reach out of memory\n");
+        cgsme_context_destroy(ctx);
+        arenaDestroy(&arena);
+        return false;
+    }
+
+    bool ok = true;
+    for (int c = 0; c < 3; c++)
+    {
+        uint64_t tiles = 0;
+        for (uint32_t y = 0; y < N; y++)
+        {
+            for (uint32_t x = 0; x < N; x++)
+            {
+                uint16_t v;
+                if (c == 0)
+                    v = maze[0][y][x];
+                else if (c == 1)
+                    v = loop[y & 1][x & 1];
+                else
+                {
+                    // even columns run down and turn east at the bottom, odd ones run up and turn east at the top
+                    bool turn = (x & 1) ? y == 0 : y == N - 1;
+                    bool entry = (x & 1) ? y == N - 1 : y == 0;
+                    uint8_t ports = (y > 0 ? DIR_N : 0) | (y + 1 < N ? DIR_S : 0) | (turn && x + 1 < N ? DIR_E : 0) |
+                                    (entry && x > 0 ? DIR_W : 0);
+                    v = getTileFromFlags(ports);
+                }
+                layer[y][x] = v;
+                tiles += v != Empty_Tile;
+            }
+        }
+        // the label planes are one block each, ring included
+        memset(&labelsA[-1][-1], 0, sizeof(uint32_t) * (N + 2) * (N + 2));
+        memset(&labelsB[-1][-1], 0, sizeof(uint32_t) * (N + 2) * (N + 2));
+        memset(&labelsC[-1][-1], 0, sizeof(uint32_t) * (N + 2) * (N + 2));
+
+        uint64_t t0 = cgsme_now_us();
+        uint32_t regionsA = findConnectedRegionsBfs(layer, labelsA, N, N, queue);
+        uint64_t t1 = cgsme_now_us();
+        reachLoad(reach, layer, false);
+        uint64_t t2 = cgsme_now_us();
+        uint32_t regionsB = reachLabelRegions(reach, labelsB);
+        uint64_t t3 = cgsme_now_us();
+        uint32_t regionsC = findConnectedRegions(layer, labelsC, N, N, &arena);
+        uint64_t t4 = cgsme_now_us();
+        bool labelsSame = regionsA == regionsB && regionsA == regionsC;
+        for (uint32_t y = 0; y < N && labelsSame; y++)
+            labelsSame = memcmp(labelsA[y], labelsB[y], sizeof(uint32_t) * N) == 0 &&
+                         memcmp(labelsA[y], labelsC[y], sizeof(uint32_t) * N) == 0;
+
+        uint64_t t5 = cgsme_now_us();
+        uint64_t reachedA = reachableBfs(layer, N, N, seen, queue);
+        uint64_t t6 = cgsme_now_us();
+        reachLoad(reach, layer, true);
+        uint32_t sx, sy;
+        uint64_t reachedB = reachNextSeed(reach, &sx, &sy) ? reachFlood(reach, sx, sy) : 0;
+        uint64_t t7 = cgsme_now_us();
+        bool reachSame = reachedA == reachedB;
+        for (uint32_t i = 0; i < N * N && reachSame; i++)
+            reachSame = seen[i] == reachVisited(reach, i % N, i / N);
+
+        double bfsUs = (double)(t1 - t0) + 1, bitUs = (double)(t3 - t1) + 1, pickUs = (double)(t4 - t3) + 1;
+        printf("BENCH: reach %s %ux%u labels bfs=%.1f ms (%.0f Mtiles/s) bitboard=%.1f ms incl. load %.1f ms (%.0f Mtiles/s, x%.1f) "
+               "findConnectedRegions=%.1f ms (x%.1f) regions=%u %s\n",
+               names[c], N, N, bfsUs / 1000.0, tiles / bfsUs, bitUs / 1000.0, (t2 - t1) / 1000.0, tiles / bitUs, bfsUs / bitUs,
+               pickUs / 1000.0, bfsUs / pickUs, regionsC, labelsSame ? "same" : "DIFFERENT");
+        bfsUs = (double)(t6 - t5) + 1;
+        bitUs = (double)(t7 - t6) + 1;
+        printf("BENCH: reach %s %ux%u from first tile bfs=%.1f ms (%.0f Mtiles/s) bitboard=%.1f ms incl. load (%.0f Mtiles/s, x%.1f) reached=%llu %s\n",
+               names[c], N, N, bfsUs / 1000.0, reachedA / bfsUs, bitUs / 1000.0, reachedB / bitUs, bfsUs / bitUs,
+               (unsigned long long)reachedB, reachSame ? "same" : "DIFFERENT");
+        ok = ok && labelsSame && reachSame;
+    }
+
+    cgsme_context_destroy(ctx);
+    arenaDestroy(&arena);
+    return ok;
+}
+
+// the welder's union-find before cgsme_unionfind (for --cgsme-bench-unionfind): full path
+// compression, no union by size, unionSets finds both roots again
+typedef struct
+{
+    uint32_t *parent;
+} LegacyUnionFind;
+
+static uint32_t legacyFindSet(LegacyUnionFind *uf, uint32_t i)
+{
+    CGSME_PROFILE_FUNC();
+    uint32_t root = i;
+    while (uf->parent[root] != root)
+        root = uf->parent[root];
+    while (uf->parent[i] != root)
+    {
+        uint32_t next = uf->parent[i];
+        uf->parent[i] = root;
+        i = next;
+    }
+    return root;
+}
+
+static void legacyUnionSets(LegacyUnionFind *uf, uint32_t i, uint32_t j)
+{
+    CGSME_PROFILE_FUNC();
+    uint32_t root_i = legacyFindSet(uf, i);
+    uint32_t root_j = legacyFindSet(uf, j);
+    if (root_i != root_j)
+        uf->parent[root_i] = root_j;
+}
+
+// --cgsme-bench-unionfind: legacy vs cgsme_unionfind on 4M elements. kruskal over the shuffled
+// edges of a 2048x2048 grid graph (the welder's pattern), random unions, and a chain of
+// unions in order (deep trees without union by size). the partitions must match.
+static bool benchUnionFind(void)
+{
+    enum { SIDE = 2048, N = SIDE * SIDE, EDGES = 2 * N };
+    uint32_t *a = malloc(sizeof(uint32_t) * EDGES);
+    uint32_t *b = malloc(sizeof(uint32_t) * EDGES);
+    uint32_t *legacyParent = malloc(sizeof(uint32_t) * N);
+    uint32_t *setsA = malloc(sizeof(uint32_t) * N);
+    uint32_t *setsB = malloc(sizeof(uint32_t) * N);
+    CgsmeArena arena;
+    arenaInit(&arena);
+    bool ok = true;
+
+    static const char *names[] = {"kruskal", "random ", "chain  "};
+    for (int pattern = 0; pattern < 3; pattern++)
+    {
+        CgsmeRng rng = cgsme_rng_init(11, 0, pattern, CGSME_RNG_WELDER);
+        uint32_t edges = 0;
+        if (pattern == 0)
+        {
+            for (uint32_t y = 0; y < SIDE; y++)
+            {
+                for (uint32_t x = 0; x < SIDE; x++)
+                {
+                    if (x + 1 < SIDE)
+                        a[edges] = y * SIDE + x, b[edges++] = y * SIDE + x + 1;
+                    if (y + 1 < SIDE)
+                        a[edges] = y * SIDE + x, b[edges++] = (y + 1) * SIDE + x;
+                }
+            }
+            for (uint32_t i = edges - 1; i > 0; i--)
+            {
+                uint32_t j = cgsme_rng_bounded(&rng, i + 1);
+                uint32_t ta = a[i], tb = b[i];
+                a[i] = a[j], b[i] = b[j];
+                a[j] = ta, b[j] = tb;
+            }
+        }
+        else if (pattern == 1)
+        {
+            for (; edges < N; edges++)
+                a[edges] = cgsme_rng_bounded(&rng, N), b[edges] = cgsme_rng_bounded(&rng, N);
+        }
+        else
+        {
+            for (; edges < N - 1; edges++)
+                a[edges] = edges, b[edges] = edges + 1;
+        }
+
+        LegacyUnionFind legacy = {legacyParent};
+        uint64_t t0 = cgsme_now_us();
+        for (uint32_t i = 0; i < N; i++)
+            legacyParent[i] = i;
+        uint32_t mergedA = 0;
+        for (uint32_t i = 0; i < edges; i++)
+        {
+            if (legacyFindSet(&legacy, a[i]) != legacyFindSet(&legacy, b[i]))
+            {
+                legacyUnionSets(&legacy, a[i], b[i]);
+                mergedA++;
+            }
+        }
+        uint64_t t1 = cgsme_now_us();
+        ArenaMark mark = arenaGetMark(&arena);
+        UnionFind *uf = createUnionFind(N, N, &arena);
+        uint32_t mergedB = 0;
+        for (uint32_t i = 0; i < edges; i++)
+            mergedB += unionSets(uf, a[i], b[i]);
+        uint64_t t2 = cgsme_now_us();
+
+        // same partition: dense IDs by smallest element must agree
+        uint32_t countB = compactSets(uf, setsB);
+        uint32_t countA = 0;
+        memset(setsA, 0, sizeof(uint32_t) * N);
+        for (uint32_t i = 0; i < N; i++)
+        {
+            uint32_t root = legacyFindSet(&legacy, i);
+            if (setsA[root] == 0)
+                setsA[root] = ++countA;
+            setsA[i] = setsA[root];
+        }
+        arenaRelease(&arena, mark);
+
+        bool same = mergedA == mergedB && countA == countB && memcmp(setsA, setsB, sizeof(uint32_t) * N) == 0;
+        ok = ok && same;
+        printf("BENCH: unionfind %s %u unions legacy=%.1f ms new=%.1f ms (x%.1f) sets=%u %s\n", names[pattern], edges,
+               (t1 - t0) / 1000.0, (t2 - t1) / 1000.0, (double)(t1 - t0) / (t2 - t1 ? t2 - t1 : 1), countB, same ? "same" : "DIFFERENT");
+    }
+
+    arenaDestroy(&arena);
+    free(setsB);
+    free(setsA);
+    free(legacyParent);
+    free(b);
+    free(a);
+    return ok;
+}
+
+// the post-solve stages fused into one raster sweep, as generateLayerThread ran them before the
+// word-parallel labels made the separate sweeps faster (reference for --cgsme-bench-postsolve).
+// a row is sealed once the row below it is cleaned, and labeled once it is sealed (west and
+// north are final by then) with provisional labels merged through a union-find. regionOf maps
+// a label to its region, numbered by first tile like the flood fill (the welder wants regions,
+// the caller remaps the plane)
+static bool fusedSealAndLabelRows(uint16_t **grid, uint16_t **outLayer, uint32_t **labels, uint32_t **regionOf, uint32_t *regionCount, uint32_t width, uint32_t length, CgsmeArena *arena)
+{
+    // one provisional label per tile at most, label 0 = void
+    UnionFind *uf = createUnionFind(width * length + 1, 1, arena);
+    if (!uf)
+        return false;
+
+    for (int32_t y = -1; y < (int32_t)length; y++)
+    {
+        // CLEANUP of the row below: anything still in superposition (shouldn't be) is killed
+        if (y + 1 < (int32_t)length)
+        {
+            uint16_t *below = grid[y + 1];
+            for (uint32_t x = 0; x < width; x++)
+                if (below[x] & (below[x] - 1))
+                    below[x] = Empty_Tile;
+        }
+        if (y < 0)
+            continue;
+
+        uint16_t *row = grid[y];
+        const uint16_t *above = grid[y - 1];
+        const uint16_t *below = grid[y + 1];
+        uint32_t *labelRow = labels[y];
+        const uint32_t *labelAbove = labels[y - 1];
+        for (int32_t x = 0; x < (int32_t)width; x++)
+        {
+            uint16_t tile = row[x];
+
+            // SEAL: a void tile takes a port towards every neighbour pointing at it
+            if (tile == Empty_Tile)
+            {
+                uint8_t flags = ((above[x] & North_Open_Mask) ? DIR_N : 0) |
+                                ((below[x] & South_Open_Mask) ? DIR_S : 0) |
+                                ((row[x - 1] & West_Open_Mask) ? DIR_W : 0) |
+                                ((row[x + 1] & East_Open_Mask) ? DIR_E : 0);
+                tile = PORTS_TO_TILE[flags];
+                row[x] = tile;
+            }
+            outLayer[y][x] = tile;
+
+            if (tile == Empty_Tile)
+            {
+                labelRow[x] = 0;
+                continue;
+            }
+
+            // IDENTIFY: join the west / north label if a port links the two tiles
+            uint8_t ports = TILE_PORTS[__builtin_ctz(tile)];
+            uint32_t label = 0;
+            if ((ports & DIR_W) || (row[x - 1] & West_Open_Mask))
+                label = labelRow[x - 1];
+            if ((ports & DIR_N) || (above[x] & North_Open_Mask))
+            {
+                uint32_t north = labelAbove[x];
+                if (label == 0)
+                    label = north;
+                else if (north != 0 && north != label)
+                {
+                    uint32_t a = findSet(uf, label);
+                    uint32_t b = findSet(uf, north);
+                    label = a == b ? a : unionRoots(uf, a, b);
+                }
+            }
+            labelRow[x] = label ? label : makeSet(uf);
+        }
+    }
+
+    // regions in the order of their first tile (like the flood fill), label 0 stays void
+    uint32_t *regions = arenaAlloc(arena, sizeof(uint32_t) * uf->count);
+    if (!regions)
+        return false;
+    uint32_t sets = compactSets(uf, regions);
+    for (uint32_t l = 0; l < uf->count; l++)
+        regions[l]--;
+
+    *regionOf = regions;
+    *regionCount = sets - 1;
+    return true;
+}
+
+// --cgsme-bench-postsolve: the post-solve stages of a layer on a synthetic 4096x4096 solved
+// layer (random reciprocal ports, some holes and leftover superpositions to seal), run as
+// separate sweeps (cleanup, sealMazeEdges, findConnectedRegions, copy out, what
+// generateLayerThread does) and as the fused single sweep plus the label -> region remap the
+// welder needs. sealed tiles, regions and the welded layer must match bit for bit.
+static bool benchPostSolve(void)
+{
+    enum { N = 4096 };
+    CgsmeArena arena;
+    arenaInit(&arena);
+    uint16_t **gridA = allocPaddedLayer(N, N, &arena);
+    uint16_t **gridB = allocPaddedLayer(N, N, &arena);
+    uint32_t **labelsA = allocPaddedLabels(N, N, &arena);
+    uint32_t **labelsB = allocPaddedLabels(N, N, &arena);
+    uint16_t *outDataA = malloc(sizeof(uint16_t) * N * N);
+    uint16_t *outDataB = malloc(sizeof(uint16_t) * N * N);
+    uint16_t **outA = malloc(sizeof(uint16_t *) * N);
+    uint16_t **outB = malloc(sizeof(uint16_t *) * N);
+    uint8_t *east = malloc(N * N), *south = malloc(N * N);
+    if (!gridA || !gridB || !labelsA || !labelsB || !outDataA || !outDataB || !outA || !outB || !east || !south)
+    {
+        printf("BENCH: postsolve out of memory\n");
+        return false;
+    }
+    for (uint32_t y = 0; y < N; y++)
+    {
+        outA[y] = &outDataA[y * N];
+        outB[y] = &outDataB[y * N];
+    }
+
+    CgsmeRng rng = cgsme_rng_init(21, 0, 0, CGSME_RNG_SOLVER);
+    for (uint32_t i = 0; i < N * N; i++)
+    {
+        east[i] = (i % N) + 1 < N && cgsme_rng_bounded(&rng, 100) < 55;
+        south[i] = i / N + 1 < N && cgsme_rng_bounded(&rng, 100) < 55;
+    }
+    for (uint32_t y = 0; y < N; y++)
+    {
+        for (uint32_t x = 0; x < N; x++)
+        {
+            uint32_t i = y * N + x;
+            uint8_t ports = (east[i] ? DIR_E : 0) | (south[i] ? DIR_S : 0) | (x > 0 && east[i - 1] ? DIR_W : 0) |
+                            (y > 0 && south[i - N] ? DIR_N : 0);
+            uint32_t roll = cgsme_rng_bounded(&rng, 100);
+            gridA[y][x] = roll < 3 ? All_Possible_State : roll < 6 ? Empty_Tile : getTileFromFlags(ports);
+        }
+        memcpy(gridB[y], gridA[y], sizeof(uint16_t) * N);
+    }
+
+    // separate sweeps
+    uint64_t t0 = cgsme_now_us();
+    for (uint32_t y = 0; y < N; y++)
+        for (uint32_t x = 0; x < N; x++)
+            if (__builtin_popcount(gridA[y][x]) > 1)
+                gridA[y][x] = Empty_Tile;
+    sealMazeEdges(gridA, N, N);
+    uint32_t regionsA = findConnectedRegions(gridA, labelsA, N, N, &arena);
+    for (uint32_t y = 0; y < N; y++)
+        memcpy(outA[y], gridA[y], sizeof(uint16_t) * N);
+    uint64_t t1 = cgsme_now_us();
+
+    // fused
+    uint32_t *regionOf = NULL;
+    uint32_t regionsB = 0;
+    bool fused = fusedSealAndLabelRows(gridB, outB, labelsB, &regionOf, &regionsB, N, N, &arena);
+    for (uint32_t y = 0; fused && y < N; y++)
+        for (uint32_t x = 0; x < N; x++)
+            labelsB[y][x] = regionOf[labelsB[y][x]];
+    uint64_t t2 = cgsme_now_us();
+
+    bool sealedSame = fused && memcmp(outDataA, outDataB, sizeof(uint16_t) * N * N) == 0;
+    bool regionsSame = fused && regionsA == regionsB;
+    for (uint32_t y = 0; y < N && regionsSame; y++)
+        regionsSame = memcmp(labelsA[y], labelsB[y], sizeof(uint32_t) * N) == 0;
+
+    CgsmeRng weldA = cgsme_rng_init(21, 0, 0, CGSME_RNG_WELDER), weldB = weldA;
+    uint64_t t3 = cgsme_now_us();
+    germanWelderInPlace(outA, labelsA, regionsA, N, N, &weldA, &arena);
+    uint64_t t4 = cgsme_now_us();
+    if (fused)
+        germanWelderInPlace(outB, labelsB, regionsB, N, N, &weldB, &arena);
+    bool weldedSame = sealedSame && regionsSame && memcmp(outDataA, outDataB, sizeof(uint16_t) * N * N) == 0;
+
+    printf("BENCH: postsolve %ux%u cleanup+seal+label+copy separate=%.1f ms (used) fused+remap=%.1f ms (x%.1f) sealed %s, regions=%u %s\n",
+           N, N, (t1 - t0) / 1000.0, (t2 - t1) / 1000.0, (double)(t2 - t1) / (t1 - t0 ? t1 - t0 : 1),
+           sealedSame ? "same" : "DIFFERENT", regionsB, regionsSame ? "same" : "DIFFERENT");
+    printf("BENCH: postsolve %ux%u weld=%.1f ms, welded %s\n", N, N, (t4 - t3) / 1000.0, weldedSame ? "same" : "DIFFERENT");
+
+    free(south);
+    free(east);
+    free(outB);
+    free(outA);
+    free(outDataB);
+    free(outDataA);
+    arenaDestroy(&arena);
+    return weldedSame;
+}
+
+// one host thread of the stress bench: generates its maze into its own buffer
+typedef struct
+{
+    uint32_t width, length, height, seed;
+    uint16_t *out;
+    int result;
+} StressJob;
+
+static int stressThread(void *arg)
+{
+    StressJob *job = (StressJob *)arg;
+    job->result = generateGridInto(job->width, job->length, job->height, job->seed, 70, job->out, job->width);
+    return 0;
+}
+
+// --cgsme-bench-stress: N host threads generate at the same time, every output must be
+// bit-identical to the same call made serially (with and without the worker pool)
+static bool benchStress(void)
+{
+    enum { THREADS = 8, ROUNDS = 4 };
+    const uint32_t w = 64, l = 48, h = 4;
+    size_t cells = (size_t)w * l * h;
+
+    uint16_t *expected = malloc(sizeof(uint16_t) * cells * THREADS);
+    uint16_t *actual = malloc(sizeof(uint16_t) * cells * THREADS);
+    if (!expected || !actual)
+        return false;
+
+    for (uint32_t t = 0; t < THREADS; t++)
+        generateGridInto(w, l, h, 1000 + t, 70, &expected[t * cells], w);
+
+    bool allOk = true;
+    for (int withPool = 0; withPool < 2; withPool++)
+    {
+        if (withPool)
+            cgsme_init_workers(0);
+
+        uint32_t mismatches = 0;
+        uint64_t start_us = cgsme_now_us();
+        for (int r = 0; r < ROUNDS; r++)
+        {
+            thrd_t threads[THREADS];
+            StressJob jobs[THREADS];
+            memset(actual, 0, sizeof(uint16_t) * cells * THREADS);
+
+            for (uint32_t t = 0; t < THREADS; t++)
+            {
+                jobs[t] = (StressJob){w, l, h, 1000 + t, &actual[t * cells], -1};
+                thrd_create(&threads[t], stressThread, &jobs[t]);
+            }
+            for (uint32_t t = 0; t < THREADS; t++)
+                thrd_join(threads[t], NULL);
+
+            for (uint32_t t = 0; t < THREADS; t++)
+            {
+                if (jobs[t].result != 0 || memcmp(&actual[t * cells], &expected[t * cells], sizeof(uint16_t) * cells) != 0)
+                    mismatches++;
+            }
+        }
+        double us = (double)(cgsme_now_us() - start_us) / (double)(ROUNDS * THREADS);
+
+        if (withPool)
+            cgsme_shutdown_workers();
+
+        printf("BENCH: stress %ux%ux%u %d threads x %d rounds (%s) %.1f us/maze, mismatches=%u%s\n",
+               w, l, h, THREADS, ROUNDS, withPool ? "pool" : "spawn", us, mismatches, mismatches ? " (FAIL)" : "");
+        allOk = allOk && mismatches == 0;
+    }
+
+    free(expected);
+    free(actual);
+    return allOk;
+}
+
+// --cgsme-bench-batch: matchmaking style pre-generation, 1000 chunk mazes (half 25x25x5, half
+// 50x50x3, own seeds). individual generateGridInto calls without a pool (a thread spawn per
+// layer) vs with the pool vs one cgsme_generate_batch call, in mazes per second at 1 to N pool
+// threads. the pooled individual calls and every batch output must be bit-identical to the
+// spawned individual calls
+static bool benchBatch(void)
+{
+    enum { MAZES = 1000 };
+    cgsme_batch_params *params = malloc(sizeof(cgsme_batch_params) * MAZES);
+    cgsme_batch_output *outputs = malloc(sizeof(cgsme_batch_output) * MAZES);
+    size_t *offsets = malloc(sizeof(size_t) * (MAZES + 1));
+    if (!params || !outputs || !offsets)
+    {
+        free(params);
+        free(outputs);
+        free(offsets);
+        return false;
+    }
+    offsets[0] = 0;
+    for (uint32_t i = 0; i < MAZES; i++)
+    {
+        bool small = (i & 1) == 0;
+        params[i] = (cgsme_batch_params){small ? 25 : 50, small ? 25 : 50, small ? 5 : 3, 7000 + i, 70};
+        offsets[i + 1] = offsets[i] + (size_t)params[i].width * params[i].length * params[i].height;
+    }
+    uint16_t *expected = malloc(sizeof(uint16_t) * offsets[MAZES]);
+    uint16_t *actual = malloc(sizeof(uint16_t) * offsets[MAZES]);
+    if (!expected || !actual)
+    {
+        free(expected);
+        free(actual);
+        free(params);
+        free(outputs);
+        free(offsets);
+        return false;
+    }
+
+    cgsme_shutdown_workers();
+    uint64_t t0 = cgsme_now_us();
+    for (uint32_t i = 0; i < MAZES; i++)
+        generateGridInto(params[i].width, params[i].length, params[i].height, params[i].seed, params[i].fulness,
+                         &expected[offsets[i]], params[i].width);
+    double spawnRate = MAZES * 1e6 / (double)(cgsme_now_us() - t0 + 1);
+    printf("BENCH: batch %u mazes individual calls (spawn) %.0f mazes/s\n", MAZES, spawnRate);
+
+    bool ok = true;
+    uint32_t hardware = cgsme_hardware_threads();
+    for (uint32_t threads = 1;; threads = threads * 2 < hardware ? threads * 2 : hardware)
+    {
+        cgsme_init_workers(threads);
+        t0 = cgsme_now_us();
+        for (uint32_t i = 0; i < MAZES; i++)
+            generateGridInto(params[i].width, params[i].length, params[i].height, params[i].seed, params[i].fulness,
+                             &actual[offsets[i]], params[i].width);
+        uint64_t t1 = cgsme_now_us();
+        bool poolSame = memcmp(actual, expected, sizeof(uint16_t) * offsets[MAZES]) == 0;
+
+        memset(actual, 0, sizeof(uint16_t) * offsets[MAZES]);
+        for (uint32_t i = 0; i < MAZES; i++)
+            outputs[i] = (cgsme_batch_output){&actual[offsets[i]], params[i].width, -1};
+        uint64_t t2 = cgsme_now_us();
+        int result = cgsme_generate_batch(params, MAZES, outputs);
+        uint64_t t3 = cgsme_now_us();
+        cgsme_shutdown_workers();
+
+        bool same = result == 0 && memcmp(actual, expected, sizeof(uint16_t) * offsets[MAZES]) == 0;
+        ok = ok && poolSame && same;
+        double poolRate = MAZES * 1e6 / (double)(t1 - t0 + 1), batchRate = MAZES * 1e6 / (double)(t3 - t2 + 1);
+        printf("BENCH: batch %u mazes %u threads individual calls (pool) %.0f mazes/s, batch %.0f mazes/s (x%.1f vs pool, x%.1f vs spawn) pool %s, batch %s\n",
+               MAZES, threads, poolRate, batchRate, batchRate / poolRate, batchRate / spawnRate, poolSame ? "same" : "DIFFERENT",
+               same ? "same" : "DIFFERENT");
+        if (threads >= hardware)
+            break;
+    }
+
+    free(actual);
+    free(expected);
+    free(offsets);
+    free(outputs);
+    free(params);
+    return ok;
+}
+
+// the profiler before the per-thread tables (for --cgsme-bench-profiler): one mutex around a
+// strcmp search over every entry, taken on each scope exit
+typedef struct
+{
+    const char *name;
+    uint64_t count, total_us, total_cycles;
+} LegacyProfileEntry;
+
+static mtx_t g_legacyProfileMtx;
+static LegacyProfileEntry g_legacyProfiles[64];
+static size_t g_legacyProfileCount = 0;
+
+static void legacyProfileRecord(const char *name, uint64_t elapsed_us, uint64_t elapsed_cycles)
+{
+    if (!cgsme_get_enabled())
+        return;
+    mtx_lock(&g_legacyProfileMtx);
+    LegacyProfileEntry *p = NULL;
+    for (size_t i = 0; i < g_legacyProfileCount && !p; i++)
+        if (strcmp(g_legacyProfiles[i].name, name) == 0)
+            p = &g_legacyProfiles[i];
+    if (!p && g_legacyProfileCount < 64)
+    {
+        p = &g_legacyProfiles[g_legacyProfileCount++];
+        *p = (LegacyProfileEntry){name, 0, 0, 0};
+    }
+    if (p)
+    {
+        p->count++;
+        p->total_us += elapsed_us;
+        p->total_cycles += elapsed_cycles;
+    }
+    mtx_unlock(&g_legacyProfileMtx);
+}
+
+static __attribute__((noinline)) void profiledLeaf(volatile uint32_t *sink)
+{
+    CGSME_PROFILE_FUNC();
+    (*sink)++;
+}
+
+static __attribute__((noinline)) void legacyProfiledLeaf(volatile uint32_t *sink)
+{
+    uint64_t start_us = cgsme_now_us();
+    uint64_t start_cycles = cgsme_now_cycles();
+    (*sink)++;
+    legacyProfileRecord("legacyProfiledLeaf", cgsme_now_us() - start_us, cgsme_now_cycles() - start_cycles);
+}
+
+// one thread of the profiler bench: `calls` scopes in a row
+typedef struct
+{
+    bool legacy;
+    uint32_t calls;
+} ProfilerJob;
+
+static int profilerThread(void *arg)
+{
+    ProfilerJob *job = (ProfilerJob *)arg;
+    volatile uint32_t sink = 0;
+    for (uint32_t i = 0; i < job->calls; i++)
+    {
+        if (job->legacy)
+            legacyProfiledLeaf(&sink);
+        else
+            profiledLeaf(&sink);
+    }
+    return 0;
+}
+
+// --cgsme-bench-profiler: cost of one profiled scope (wall ns per call over all threads) with
+// the scope compiled in but quick mode on, the per-thread profiler and the legacy mutex
+// profiler, on 1 and 4 threads. the legacy entry must count every call.
+static bool benchProfiler(void)
+{
+    enum { CALLS = 2000000, MAX_THREADS = 4 };
+    cgsme_init_debug();
+    cgsme_set_enabled(true);
+    mtx_init(&g_legacyProfileMtx, mtx_plain);
+
+    static const char *modes[] = {"quick ", "thread", "legacy"};
+    bool ok = true;
+    for (uint32_t threads = 1; threads <= MAX_THREADS; threads *= 4)
+    {
+        double ns[3];
+        for (int mode = 0; mode < 3; mode++)
+        {
+            cgsme_set_quick_mode(mode == 0);
+            g_legacyProfileCount = 0;
+
+            thrd_t handles[MAX_THREADS];
+            ProfilerJob jobs[MAX_THREADS];
+            uint64_t start_us = cgsme_now_us();
+            for (uint32_t t = 0; t < threads; t++)
+            {
+                jobs[t] = (ProfilerJob){mode == 2, CALLS};
+                thrd_create(&handles[t], profilerThread, &jobs[t]);
+            }
+            for (uint32_t t = 0; t < threads; t++)
+                thrd_join(handles[t], NULL);
+            ns[mode] = (double)(cgsme_now_us() - start_us) * 1000.0 / ((double)CALLS * threads);
+
+            if (mode == 2)
+                ok = ok && g_legacyProfileCount == 1 && g_legacyProfiles[0].count == (uint64_t)CALLS * threads;
+        }
+        printf("BENCH: profiler %u thread(s) %s=%.1f ns %s=%.1f ns %s=%.1f ns per scope (x%.2f vs legacy)\n", threads,
+               modes[0], ns[0], modes[1], ns[1], modes[2], ns[2], ns[1] > 0.0 ? ns[2] / ns[1] : 0.0);
+    }
+
+    mtx_destroy(&g_legacyProfileMtx);
+    cgsme_set_quick_mode(true);
+    cgsme_shutdown_debug();
+    printf("BENCH: profiler legacy counts %s\n", ok ? "ok" : "(FAIL)");
+    return ok;
+}
 
 int main(int argc, char **argv)
 {
@@ -49,6 +1778,23 @@ int main(int argc, char **argv)
     if (cgsme_profile_us_th || cgsme_profile_cycles_th)
         cgsme_profile_set_thresholds(cgsme_profile_us_th, cgsme_profile_cycles_th);
 
+    // Optional timeline (Chrome trace-event JSON written at shutdown)
+    const char *cgsme_trace_path = NULL;
+    uint32_t cgsme_trace_depth = 8;
+    uint32_t cgsme_trace_sample = 64;
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *a = argv[i];
+        if (strncmp(a, "--cgsme-trace=", 14) == 0)
+            cgsme_trace_path = a + 14;
+        else if (strncmp(a, "--cgsme-trace-depth=", 20) == 0)
+            cgsme_trace_depth = (uint32_t)strtoul(a + 20, NULL, 10);
+        else if (strncmp(a, "--cgsme-trace-sample=", 21) == 0)
+            cgsme_trace_sample = (uint32_t)strtoul(a + 21, NULL, 10);
+    }
+    if (cgsme_trace_path)
+        cgsme_trace_enable(cgsme_trace_path, 0, cgsme_trace_depth, cgsme_trace_sample);
+
     for (int i = 1; i < argc; ++i)
     {
         if (strncmp(argv[i], "--cgsme-profile-warning-pct=", 27) == 0)
@@ -59,6 +1805,111 @@ int main(int argc, char **argv)
         }
     }
 
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--cgsme-bench-pool") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            benchWorkerPool();
+            return 0;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-scheduler") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            benchScheduler();
+            return 0;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-wavefront") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchWavefront() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-bitplane") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchBitplane() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-propagation") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            benchPropagation();
+            return 0;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-reseed") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            benchReseed();
+            return 0;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-rng") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            benchRng();
+            return 0;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-noise") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchNoise() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-select") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchSelect() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-islands") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchIslands() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-dilate") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchDilate() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-weld") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchWeld() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-reach") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchReach() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-unionfind") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchUnionFind() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-postsolve") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchPostSolve() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-profiler") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchProfiler() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-stress") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchStress() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-batch") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            return benchBatch() ? 0 : 1;
+        }
+        if (strcmp(argv[i], "--cgsme-bench-context") == 0)
+        {
+            cgsme_set_quick_mode(true);
+            benchContext();
+            return 0;
+        }
+    }
+
     // 2. Configuration
     uint32_t width = 100;
     uint32_t length = 100;
@@ -99,6 +1950,24 @@ int main(int argc, char **argv)
             printf("BENCH: generateGrid elapsed=%llu us (%.6f s)\n", (unsigned long long)(end_us - start_us), seconds);
             printf("STATS: Filled %llu / %llu tiles (%.1f%%)\n", filled_tiles, total_tiles, ((float)filled_tiles / total_tiles) * 100.0f);
 
+            // --- VERIFICATION: CONNECTIVITY (like main.lua's traversal overlay, from the first tile) ---
+            CgsmeArena arena;
+            arenaInit(&arena);
+            ReachLayer *reach = createReachLayer(width, length, &arena);
+            for (uint32_t z = 0; z < height && reach; z++)
+            {
+                uint64_t valid = 0;
+                for (uint32_t y = 0; y < length; y++)
+                    for (uint32_t x = 0; x < width; x++)
+                        valid += __builtin_popcount(grid[z][y][x]) == 1;
+                reachLoad(reach, grid[z], true);
+                uint32_t sx, sy;
+                uint64_t reached = reachNextSeed(reach, &sx, &sy) ? reachFlood(reach, sx, sy) : 0;
+                printf("STATS: Layer %u reachable %llu / %llu tiles (%.1f%%)\n", z, (unsigned long long)reached,
+                       (unsigned long long)valid, valid ? reached * 100.0 / valid : 0.0);
+            }
+            arenaDestroy(&arena);
+
             freeGrid(grid, width, length, height);
         }
         else
@@ -4,13 +4,148 @@
 
 
 #include <stdint.h>
+#include <stddef.h>
 
 
-// linear congruential generator
-// Inline for performance (no function call overhead)
-static inline uint32_t nextRandom(uint32_t *state) {
-    *state = (*state * 1664525 + 1013904223); // modulo 2^32 is implicit with uint32 overflow
-    return *state;
+// counter-based generator (Widynski's "Squares"): the n-th number of a stream is a pure
+// function of (key, n). a stream is keyed by (seed, layer, tile, purpose), so any job can
+// build its own stream without chaining seeds from another one, and the output does not
+// depend on which thread runs what or in which order.
+typedef struct CgsmeRng
+{
+    uint64_t key; // stream identity (odd)
+    uint64_t ctr; // index of the next number
+} CgsmeRng;
+
+// stream purposes, keeps two consumers of the same (seed, layer, tile) apart
+enum
+{
+    CGSME_RNG_ARCHITECT = 1, // stair placement
+    CGSME_RNG_SOLVER = 2,    // collapse choices, scores, seed selection
+    CGSME_RNG_WELDER = 3,    // bridge shuffle
+};
+
+// splitmix64 finalizer, spreads structured inputs over the whole key
+static inline uint64_t cgsmeRngMix(uint64_t z)
+{
+    z += 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// 4 rounds of middle-square with a Weyl sequence, 32 bit output
+static inline uint32_t cgsmeSquares32(uint64_t ctr, uint64_t key)
+{
+    uint64_t x, y, z;
+    y = x = ctr * key;
+    z = y + key;
+    x = x * x + y;
+    x = (x >> 32) | (x << 32);
+    x = x * x + z;
+    x = (x >> 32) | (x << 32);
+    x = x * x + y;
+    x = (x >> 32) | (x << 32);
+    return (uint32_t)((x * x + z) >> 32);
+}
+
+// 3 rounds, the first published form of Squares (it passes BigCrush like the 4 round one, the
+// 4th round is safety margin). one multiplication less per number, so the per-tile draws of the
+// solver (collapse picks, score noise, bucket ties) are at least as fast as the LCG they replaced
+static inline uint32_t cgsmeSquares32Fast(uint64_t ctr, uint64_t key)
+{
+    uint64_t x, y, z;
+    y = x = ctr * key;
+    z = y + key;
+    x = x * x + y;
+    x = (x >> 32) | (x << 32);
+    x = x * x + z;
+    x = (x >> 32) | (x << 32);
+    return (uint32_t)((x * x + y) >> 32);
+}
+
+static inline CgsmeRng cgsme_rng_init(uint32_t seed, uint32_t layer, uint32_t tile, uint32_t purpose)
+{
+    uint64_t k = cgsmeRngMix(seed);
+    k = cgsmeRngMix(k ^ layer);
+    k = cgsmeRngMix(k ^ (((uint64_t)tile << 8) | purpose));
+    CgsmeRng rng = {k | 1, 0};
+    return rng;
+}
+
+// child stream `index` of a stream (e.g. one per cell). only the key is used, so the child
+// does not depend on how far the parent was drawn or on who splits it first
+static inline CgsmeRng cgsme_rng_split(const CgsmeRng *parent, uint64_t index)
+{
+    CgsmeRng rng = {cgsmeRngMix(parent->key ^ cgsmeRngMix(index)) | 1, 0};
+    return rng;
+}
+
+// next number of the stream
+static inline uint32_t cgsme_rng_next(CgsmeRng *rng)
+{
+    return cgsmeSquares32(rng->ctr++, rng->key);
+}
+
+// next number of the stream, 3 round variant (hot solver draws only)
+static inline uint32_t cgsme_rng_next_fast(CgsmeRng *rng)
+{
+    return cgsmeSquares32Fast(rng->ctr++, rng->key);
+}
+
+// number at an absolute position of the stream (does not advance it).
+// reserve a block with `base = rng->ctr; rng->ctr += n;` and index into it per element.
+static inline uint32_t cgsme_rng_at(const CgsmeRng *rng, uint64_t index)
+{
+    return cgsmeSquares32(index, rng->key);
+}
+
+// batched fill, the counters are independent so the compiler can interleave the rounds
+static inline void cgsme_rng_fill(CgsmeRng *rng, uint32_t *out, size_t count)
+{
+    uint64_t base = rng->ctr;
+    for (size_t i = 0; i < count; i++)
+        out[i] = cgsmeSquares32(base + i, rng->key);
+    rng->ctr = base + count;
+}
+
+// uniform in [0, bound) without modulo bias (Lemire's multiply-shift, rejection is rare).
+// `fast` picks the round count, it is a constant in both callers below
+static inline uint32_t cgsmeRngBounded(CgsmeRng *rng, uint32_t bound, int fast)
+{
+    uint64_t m = (uint64_t)(fast ? cgsme_rng_next_fast(rng) : cgsme_rng_next(rng)) * bound;
+    uint32_t low = (uint32_t)m;
+    if (low < bound)
+    {
+        uint32_t threshold = (uint32_t)(-bound) % bound;
+        while (low < threshold)
+        {
+            m = (uint64_t)(fast ? cgsme_rng_next_fast(rng) : cgsme_rng_next(rng)) * bound;
+            low = (uint32_t)m;
+        }
+    }
+    return (uint32_t)(m >> 32);
+}
+
+static inline uint32_t cgsme_rng_bounded(CgsmeRng *rng, uint32_t bound)
+{
+    return cgsmeRngBounded(rng, bound, 0);
+}
+
+static inline uint32_t cgsme_rng_bounded_fast(CgsmeRng *rng, uint32_t bound)
+{
+    return cgsmeRngBounded(rng, bound, 1);
+}
+
+// uniform float in [0, 1) (24 bits, never rounds up to 1.0)
+static inline float cgsme_rng_float01(CgsmeRng *rng)
+{
+    return (float)(cgsme_rng_next(rng) >> 8) * (1.0f / 16777216.0f);
+}
+
+static inline float cgsme_rng_float01_fast(CgsmeRng *rng)
+{
+    return (float)(cgsme_rng_next_fast(rng) >> 8) * (1.0f / 16777216.0f);
 }
 
 
@@ -252,62 +252,18 @@ static inline bool isValidSingleTile(uint16_t t)
 	return (t & (t - 1)) == 0 && (t & ALL_TILES) != 0;
 }
 
-//  (0-15) -> bitmask
-// map the 16 valid single-tile types to numbers 0-15.
-static const uint16_t TILE_INDEX_TO_MASK[16] = {
-	North_East_Corridor, South_East_Corridor, South_West_Corridor, North_West_Corridor, // 0-3
-	North_South_Corridor, West_East_Corridor,											// 4-5
-	North_T_Corridor, East_T_Corridor, South_T_Corridor, West_T_Corridor,				// 6-9
-	Normal_X_Corridor, Special_X_Corridor,												// 10-11
-	North_DeadEnd, East_DeadEnd, South_DeadEnd, West_DeadEnd							// 12-15
-};
-
-// mask -> index
-// This uses a switch for safety, but the compiler optimizes it to a lookup.
+// (0-15) <-> bitmask
+// the 16 single-tile types map to numbers 0-15 by bit position (see the tileset in cgsme_tileset.h)
+
+// mask -> index (tile == 1 << index, checked against the tileset in cgsme_tileset.h)
 static inline uint8_t maskToIndex(uint16_t mask)
 {
-	switch (mask)
-	{
-	case North_East_Corridor:
-		return 0;
-	case South_East_Corridor:
-		return 1;
-	case South_West_Corridor:
-		return 2;
-	case North_West_Corridor:
-		return 3;
-	case North_South_Corridor:
-		return 4;
-	case West_East_Corridor:
-		return 5;
-	case North_T_Corridor:
-		return 6;
-	case East_T_Corridor:
-		return 7;
-	case South_T_Corridor:
-		return 8;
-	case West_T_Corridor:
-		return 9;
-	case Normal_X_Corridor:
-		return 10;
-	case Special_X_Corridor:
-		return 11;
-	case North_DeadEnd:
-		return 12;
-	case East_DeadEnd:
-		return 13;
-	case South_DeadEnd:
-		return 14;
-	case West_DeadEnd:
-		return 15;
-	default:
-		return 0; // should handle EMPTY elsewhere
-	}
+	return mask ? (uint8_t)__builtin_ctz(mask) : 0; // should handle EMPTY elsewhere
 }
 
 static inline uint16_t indexToMask(uint8_t index)
 {
-	return TILE_INDEX_TO_MASK[index & 0xF];
+	return (uint16_t)(1u << (index & 0xF));
 }
 
 #endif